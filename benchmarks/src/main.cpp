@@ -0,0 +1,406 @@
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "benchmark/benchmark.h"
+
+#include "necs/CPagedAllocator.h"
+#include "necs/CMatrixAllocator.h"
+#include "necs/CHeapAlignedAllocator.h"
+#include "necs/CEntityFactory.h"
+#include "necs/CWorldObject.h"
+#include "necs/CWorld.h"
+
+namespace
+{
+	inline constexpr uint64_t BLOCK_SIZE{ 64 };
+	inline constexpr uint64_t BLOCKS_PER_SLAB{ 64 };
+
+	struct DPosition
+	{
+		float X, Y, Z;
+	};
+
+	struct DVelocity
+	{
+		float X, Y, Z;
+	};
+
+	struct CStaticObject : public CWorldObject
+	{
+		CStaticObject(const DWorldObjectInitializer& init) : CWorldObject(init, false), Position(NewComponent<DPosition>(DPosition{})) {}
+
+		CComponentHandle<DPosition> Position;
+	};
+
+	struct CMovingObject : public CWorldObject
+	{
+		CMovingObject(const DWorldObjectInitializer& init) : CWorldObject(init, true), Position(NewComponent<DPosition>(DPosition{})), Velocity(NewComponent<DVelocity>(DVelocity{ 1.f, 0.f, -1.f })) {}
+
+		void Tick() override {
+			Position->X += Velocity->X;
+			Position->Y += Velocity->Y;
+			Position->Z += Velocity->Z;
+		}
+
+		CComponentHandle<DPosition> Position;
+		CComponentHandle<DVelocity> Velocity;
+	};
+
+	struct CIgnorePendingDestroy : public IWorldObjectPendingDestroyNotifier
+	{
+		void MarkPendingDestroy(CWorldObject* ptr) override {}
+	};
+
+	CEntityFactory& GetFactory()
+	{
+		static CEntityFactory factory;
+		static const bool registered{ [] {
+			factory.RegisterEntityClass<CStaticObject>("CStaticObject");
+			factory.RegisterEntityClass<CMovingObject>("CMovingObject");
+			return true;
+			}() };
+		(void)registered;
+		return factory;
+	}
+
+	/**
+	 * /brief Same free order for every allocator, a live set shuffled once.
+	 */
+	std::vector<uint64_t> MakeChurnOrder(const uint64_t count)
+	{
+		std::vector<uint64_t> order(count);
+		for (uint64_t i{}; i < count; i++)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937_64{ 42 });
+		return order;
+	}
+}
+
+#pragma region Allocators
+// Frees and reallocates a shuffled live set, the live set spans range(0) slabs
+static void BM_PagedAllocatorChurn(benchmark::State& state)
+{
+	CPagedAllocator<CHeapAlignedAllocator> allocator(BLOCKS_PER_SLAB, BLOCK_SIZE);
+	const uint64_t count{ static_cast<uint64_t>(state.range(0)) * BLOCKS_PER_SLAB };
+	const auto order{ MakeChurnOrder(count) };
+
+	std::vector<void*> blocks(count);
+	for (auto& block : blocks)
+		block = allocator.Allocate();
+
+	for (auto _ : state)
+	{
+		for (const uint64_t i : order)
+		{
+			allocator.Free(blocks[i]);
+			blocks[i] = allocator.Allocate();
+			benchmark::DoNotOptimize(blocks[i]);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+
+	for (void* const block : blocks)
+		allocator.Free(block);
+}
+BENCHMARK(BM_PagedAllocatorChurn)->Arg(1)->Arg(16)->Arg(256);
+
+static void BM_MallocChurn(benchmark::State& state)
+{
+	const uint64_t count{ static_cast<uint64_t>(state.range(0)) * BLOCKS_PER_SLAB };
+	const auto order{ MakeChurnOrder(count) };
+
+	std::vector<void*> blocks(count);
+	for (auto& block : blocks)
+		block = std::malloc(BLOCK_SIZE);
+
+	for (auto _ : state)
+	{
+		for (const uint64_t i : order)
+		{
+			std::free(blocks[i]);
+			blocks[i] = std::malloc(BLOCK_SIZE);
+			benchmark::DoNotOptimize(blocks[i]);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+
+	for (void* const block : blocks)
+		std::free(block);
+}
+BENCHMARK(BM_MallocChurn)->Arg(1)->Arg(16)->Arg(256);
+
+// Allocates a batch of mixed sizes then frees it in shuffled order
+static void BM_MatrixAllocatorMixedSizes(benchmark::State& state)
+{
+	static constexpr std::array<uint64_t, 6> sizes{ 16, 40, 100, 256, 700, 2000 };
+	CMatrixAllocator<CPagedAllocator<CHeapAlignedAllocator>> allocator(BLOCKS_PER_SLAB);
+	const uint64_t count{ static_cast<uint64_t>(state.range(0)) };
+	const auto order{ MakeChurnOrder(count) };
+
+	std::vector<void*> blocks(count);
+	for (auto _ : state)
+	{
+		for (uint64_t i{}; i < count; i++)
+			blocks[i] = allocator.Allocate(sizes[i % sizes.size()]);
+		for (const uint64_t i : order)
+			allocator.Free(blocks[i]);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_MatrixAllocatorMixedSizes)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_MallocMixedSizes(benchmark::State& state)
+{
+	static constexpr std::array<uint64_t, 6> sizes{ 16, 40, 100, 256, 700, 2000 };
+	const uint64_t count{ static_cast<uint64_t>(state.range(0)) };
+	const auto order{ MakeChurnOrder(count) };
+
+	std::vector<void*> blocks(count);
+	for (auto _ : state)
+	{
+		for (uint64_t i{}; i < count; i++)
+			blocks[i] = std::malloc(sizes[i % sizes.size()]);
+		for (const uint64_t i : order)
+			std::free(blocks[i]);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_MallocMixedSizes)->Arg(1 << 10)->Arg(1 << 14);
+#pragma endregion
+
+#pragma region Spawning
+static void BM_PlacementNewFromTypename(benchmark::State& state)
+{
+	auto& factory{ GetFactory() };
+	const auto& descriptor{ factory.GetClassDescriptor(GetClassId<CStaticObject>()) };
+	CHeapAlignedAllocator runtimeAllocator;
+	CIgnorePendingDestroy notifier;
+	void* const memory{ runtimeAllocator.Allocate(descriptor.AllocationSize, alignof(std::max_align_t)) };
+
+	for (auto _ : state)
+	{
+		CWorldObject* const object{ factory.PlacementNewFromTypename(memory, &notifier, "CStaticObject", &runtimeAllocator) };
+		benchmark::DoNotOptimize(object);
+		descriptor.Destroy(object);
+	}
+	state.SetItemsProcessed(state.iterations());
+
+	runtimeAllocator.Free(memory);
+}
+BENCHMARK(BM_PlacementNewFromTypename);
+
+// Spawns a wave one object at a time, then destroys it at frame end
+static void BM_SpawnDestroyWave(benchmark::State& state)
+{
+	CWorld world(GetFactory(), 256);
+	const uint64_t count{ static_cast<uint64_t>(state.range(0)) };
+
+	for (auto _ : state)
+	{
+		for (uint64_t i{}; i < count; i++)
+			world.SpawnWorldObject(GetClassId<CStaticObject>())->SetPendingDestroy();
+		world.FlushPendingDestroy();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SpawnDestroyWave)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_BulkSpawnDestroyWave(benchmark::State& state)
+{
+	CWorld world(GetFactory(), 256);
+	const uint64_t count{ static_cast<uint64_t>(state.range(0)) };
+	std::vector<CWorldObject*> objects(count);
+
+	for (auto _ : state)
+	{
+		world.SpawnWorldObjects(GetClassId<CStaticObject>(), count, objects.data());
+		for (CWorldObject* const object : objects)
+			object->SetPendingDestroy();
+		world.FlushPendingDestroy();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_BulkSpawnDestroyWave)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_NewDeleteWave(benchmark::State& state)
+{
+	const uint64_t count{ static_cast<uint64_t>(state.range(0)) };
+	std::vector<std::unique_ptr<DPosition>> objects(count);
+
+	for (auto _ : state)
+	{
+		for (auto& object : objects)
+			object = std::make_unique<DPosition>();
+		for (auto& object : objects)
+			object.reset();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_NewDeleteWave)->Arg(1 << 10)->Arg(1 << 14);
+#pragma endregion
+
+#pragma region Components
+// The component takes back the archetype slot it was registered in
+static void BM_NewArchetypeComponent(benchmark::State& state)
+{
+	CWorld world(GetFactory());
+	auto* const object{ static_cast<CStaticObject*>(world.SpawnWorldObject(GetClassId<CStaticObject>())) };
+
+	for (auto _ : state)
+	{
+		object->Position.Reset();
+		object->Position = object->NewComponent<DPosition>(DPosition{ 1.f, 2.f, 3.f });
+		benchmark::DoNotOptimize(object->Position.Get());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NewArchetypeComponent);
+
+// Not part of the class layout, the component falls back to the runtime components allocator
+static void BM_NewRuntimeComponent(benchmark::State& state)
+{
+	CWorld world(GetFactory());
+	auto* const object{ static_cast<CStaticObject*>(world.SpawnWorldObject(GetClassId<CStaticObject>())) };
+
+	for (auto _ : state)
+	{
+		auto velocity{ object->NewComponent<DVelocity>(DVelocity{ 1.f, 2.f, 3.f }) };
+		benchmark::DoNotOptimize(velocity.Get());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NewRuntimeComponent);
+
+static void BM_MallocComponent(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		auto velocity{ std::make_unique<DVelocity>(DVelocity{ 1.f, 2.f, 3.f }) };
+		benchmark::DoNotOptimize(velocity.get());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MallocComponent);
+
+static void BM_ComponentHandleMove(benchmark::State& state)
+{
+	CWorld world(GetFactory());
+	auto* const object{ static_cast<CStaticObject*>(world.SpawnWorldObject(GetClassId<CStaticObject>())) };
+	CComponentHandle<DPosition> handle{ std::move(object->Position) };
+
+	for (auto _ : state)
+	{
+		CComponentHandle<DPosition> moved{ std::move(handle) };
+		benchmark::DoNotOptimize(moved.Get());
+		handle = std::move(moved);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ComponentHandleMove);
+
+// Reference counted baseline of the handle move
+static void BM_SharedComponentCopy(benchmark::State& state)
+{
+	CWorld world(GetFactory());
+	auto* const object{ static_cast<CStaticObject*>(world.SpawnWorldObject(GetClassId<CStaticObject>())) };
+	const std::shared_ptr<DPosition> shared{ object->Position.ToShared() };
+
+	for (auto _ : state)
+	{
+		std::shared_ptr<DPosition> copy{ shared };
+		benchmark::DoNotOptimize(copy.get());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SharedComponentCopy);
+
+static void BM_WorldObjectHandleResolve(benchmark::State& state)
+{
+	CWorld world(GetFactory());
+	std::vector<CWorldObject*> objects(1 << 10);
+	world.SpawnWorldObjects(GetClassId<CStaticObject>(), objects.size(), objects.data());
+	std::vector<DWorldObjectHandle> handles;
+	for (const CWorldObject* const object : objects)
+		handles.push_back(object->GetHandle());
+
+	for (auto _ : state)
+	{
+		for (const auto handle : handles)
+			benchmark::DoNotOptimize(world.ResolveHandle(handle));
+	}
+	state.SetItemsProcessed(state.iterations() * handles.size());
+}
+BENCHMARK(BM_WorldObjectHandleResolve);
+#pragma endregion
+
+#pragma region Frame
+// A frame of 100k objects, ticking with virtual dispatch per bucket then flushing
+static void BM_Frame100k(benchmark::State& state)
+{
+	CWorld world(GetFactory(), 1024);
+	world.SpawnWorldObjects(GetClassId<CMovingObject>(), 100000, nullptr);
+	world.GetTickManager().SortBucketsByAddress();
+
+	for (auto _ : state)
+	{
+		world.Tick();
+	}
+	state.SetItemsProcessed(state.iterations() * world.GetNumOfWorldObjects());
+}
+BENCHMARK(BM_Frame100k)->Unit(benchmark::kMillisecond);
+
+// Same integration as BM_Frame100k through a cached query instead of the tick
+static void BM_Query100k(benchmark::State& state)
+{
+	CWorld world(GetFactory(), 1024);
+	world.SpawnWorldObjects(GetClassId<CMovingObject>(), 100000, nullptr);
+
+	for (auto _ : state)
+	{
+		world.Query<DPosition, const DVelocity>().ForEach([](CWorldObject&, DPosition& position, const DVelocity& velocity) {
+			position.X += velocity.X;
+			position.Y += velocity.Y;
+			position.Z += velocity.Z;
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * world.GetNumOfWorldObjects());
+}
+BENCHMARK(BM_Query100k)->Unit(benchmark::kMillisecond);
+
+// The malloc baseline, each object and its components in separate heap allocations
+static void BM_HeapFrame100k(benchmark::State& state)
+{
+	struct DHeapObject
+	{
+		std::unique_ptr<DPosition> Position;
+		std::unique_ptr<DVelocity> Velocity;
+	};
+
+	std::vector<std::unique_ptr<DHeapObject>> objects(100000);
+	for (auto& object : objects)
+		object = std::make_unique<DHeapObject>(DHeapObject{ std::make_unique<DPosition>(), std::make_unique<DVelocity>(DVelocity{ 1.f, 0.f, -1.f }) });
+
+	for (auto _ : state)
+	{
+		for (const auto& object : objects)
+		{
+			object->Position->X += object->Velocity->X;
+			object->Position->Y += object->Velocity->Y;
+			object->Position->Z += object->Velocity->Z;
+		}
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * objects.size());
+}
+BENCHMARK(BM_HeapFrame100k)->Unit(benchmark::kMillisecond);
+#pragma endregion
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: BitUtils.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cassert>
+
+#if _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * /brief Index of the lowest set bit, value must be non zero.
+ */
+inline uint64_t CountTrailingZeros(const uint64_t value)
+{
+	assert(value != 0);
+#if _MSC_VER
+	unsigned long index{};
+	_BitScanForward64(&index, value);
+	return index;
+#else
+	return static_cast<uint64_t>(__builtin_ctzll(value));
+#endif
+}
+
+/**
+ * /brief Index of the highest set bit, value must be non zero.
+ */
+inline uint64_t FloorLog2(const uint64_t value)
+{
+	assert(value != 0);
+#if _MSC_VER
+	unsigned long index{};
+	_BitScanReverse64(&index, value);
+	return index;
+#else
+	return static_cast<uint64_t>(63 - __builtin_clzll(value));
+#endif
+}
+
+inline uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
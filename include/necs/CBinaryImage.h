@@ -0,0 +1,166 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CBinaryImage.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "necs/IWorldObjectCDO.h"
+
+/**
+ * /brief Reads the i-th element of an unaligned array of an image.
+ */
+template<typename T>
+inline T LoadUnaligned(const uint8_t* const array, const uint64_t i)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	T value;
+	std::memcpy(&value, array + i * sizeof(T), sizeof(T));
+	return value;
+}
+
+/**
+ * /brief The bytes spanned by the archetype components of a class, from the first one to the end of the last one.
+ * Returns false if one of them isn't trivially copyable and can't be copied as raw bytes.
+ */
+inline bool GetArchetypeComponentsBlock(const IWorldObjectCDO& cdo, uint64_t& offset, uint64_t& bytes)
+{
+	offset = 0;
+	bytes = 0;
+
+	uint64_t end{};
+	for (const auto& component : cdo.GetCDOComponentsInfo())
+	{
+		if (component.Offset == NO_ARCHETYPE_OFFSET)
+			continue;
+		if (!component.TriviallyCopyable)
+			return false;
+
+		// Slots are ascending, the first is the lowest
+		if (end == 0)
+			offset = component.Offset;
+		end = component.Offset + component.Size;
+	}
+
+	bytes = end - offset;
+	return true;
+}
+
+/**
+ * /brief True if an object holds every archetype component of its class, constructedSlots as given by CWorldObject::GetConstructedArchetypeSlots.
+ * Images copy the components over freshly constructed ones, a component reset before saving would come back since its handle is a class member the image can't reset.
+ */
+inline bool HoldsEveryArchetypeComponent(const uint64_t constructedSlots)
+{
+	return constructedSlots == UINT64_MAX;
+}
+
+/**
+ * /brief Appends native endian values to a binary image.
+ */
+class CBinaryImageWriter final
+{
+public:
+	explicit CBinaryImageWriter(std::vector<uint8_t>& image) : _image(image) {}
+
+	inline void Append(const void* const data, const uint64_t bytes) {
+		const uint8_t* const begin{ static_cast<const uint8_t*>(data) };
+		_image.insert(_image.end(), begin, begin + bytes);
+	}
+
+	template<typename T>
+	inline void AppendValue(const T& value) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		Append(&value, sizeof(T));
+	}
+
+	inline void AppendString(const std::string& value) {
+		AppendValue(static_cast<uint32_t>(value.size()));
+		Append(value.data(), value.size());
+	}
+
+	/**
+	 * /brief Grows the image and returns the new bytes to fill, valid until the next append.
+	 */
+	inline uint8_t* AppendUninitialized(const uint64_t bytes) {
+		const uint64_t offset{ _image.size() };
+		_image.resize(offset + bytes);
+		return _image.data() + offset;
+	}
+
+private:
+	std::vector<uint8_t>& _image;
+};
+
+/**
+ * /brief Bounds checked cursor over a binary image, every read past the end throws runtime_error.
+ * Arrays are returned in place, nothing is copied.
+ */
+class CBinaryImageReader final
+{
+public:
+	CBinaryImageReader(const uint8_t* const data, const uint64_t bytes) : _data(data), _bytes(bytes) {}
+
+	const uint8_t* ReadArray(const uint64_t count, const uint64_t elementBytes) {
+		if (elementBytes != 0 && count > (_bytes - _offset) / elementBytes)
+			throw std::runtime_error("Corrupted image");
+
+		const uint8_t* const data{ _data + _offset };
+		_offset += count * elementBytes;
+		return data;
+	}
+
+	template<typename T>
+	T ReadValue() {
+		return LoadUnaligned<T>(ReadArray(1, sizeof(T)), 0);
+	}
+
+	std::string ReadString() {
+		const uint32_t size{ ReadValue<uint32_t>() };
+		return std::string(reinterpret_cast<const char*>(ReadArray(size, 1)), size);
+	}
+
+	inline bool IsAtEnd() const { return _offset == _bytes; }
+
+private:
+	const uint8_t* const _data;
+	const uint64_t _bytes;
+	uint64_t _offset{};
+};
@@ -0,0 +1,83 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CChromeTraceSink.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "necs/CTrace.h"
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+/**
+ * /brief Records the trace in memory and writes it in the Chrome trace event format, loadable in chrome://tracing or Perfetto.
+ */
+class CChromeTraceSink final : public ITraceSink
+{
+public:
+	CChromeTraceSink() = default;
+
+	CChromeTraceSink(const CChromeTraceSink&) = delete;
+	CChromeTraceSink& operator=(const CChromeTraceSink&) = delete;
+
+	void BeginZone(const char* name) override;
+	void EndZone(const char* name) override;
+	void Counter(const char* name, const int64_t value) override;
+
+	/**
+	 * /brief Writes the JSON object with every event recorded so far.
+	 */
+	void Write(std::ostream& out) const;
+	void Clear();
+
+	uint64_t GetNumOfEvents() const;
+
+private:
+	struct DEvent
+	{
+		const char* Name;
+		char Phase;
+		uint32_t ThreadId;
+		int64_t Microseconds;
+		int64_t Value;
+	};
+
+	const std::chrono::steady_clock::time_point _start{ std::chrono::steady_clock::now() };
+	mutable std::mutex _mutex;
+	std::vector<DEvent> _events;
+
+	void _record(const char* const name, const char phase, const int64_t value);
+};
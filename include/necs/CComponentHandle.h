@@ -0,0 +1,154 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CComponentHandle.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+/**
+ * /brief Owner of component memory, releases the storage of a component already destroyed.
+ */
+class IComponentOwner
+{
+public:
+	virtual ~IComponentOwner() = default;
+
+	virtual void ReleaseComponent(void* ptr) = 0;
+	/**
+	 * /brief Called by the mutable accessor of the handles, owners not tracking changes ignore it.
+	 */
+	virtual void OnComponentChanged(void* ptr) {}
+};
+
+/**
+ * /brief Move only owning handle to a component, destroys it and returns its memory to the owner.
+ * No control block, no reference counting, two pointers wide.
+ */
+template<typename T>
+class CComponentHandle final
+{
+public:
+	CComponentHandle() = default;
+	CComponentHandle(T* const ptr, IComponentOwner* const owner) : _ptr(ptr), _owner(owner) {
+		assert(!_ptr || _owner);
+	}
+
+	CComponentHandle(const CComponentHandle&) = delete;
+	CComponentHandle& operator=(const CComponentHandle&) = delete;
+
+	CComponentHandle(CComponentHandle&& other) noexcept : _ptr(other._ptr), _owner(other._owner) {
+		other._ptr = nullptr;
+		other._owner = nullptr;
+	}
+
+	CComponentHandle& operator=(CComponentHandle&& other) noexcept {
+		if (this != &other)
+		{
+			Reset();
+			_ptr = other._ptr;
+			_owner = other._owner;
+			other._ptr = nullptr;
+			other._owner = nullptr;
+		}
+		return *this;
+	}
+
+	~CComponentHandle() { Reset(); }
+
+	/**
+	 * /brief Destroys the component and releases its memory.
+	 */
+	void Reset() {
+		if (_ptr)
+		{
+			_ptr->~T();
+			_owner->ReleaseComponent(const_cast<std::remove_cv_t<T>*>(_ptr));
+			_ptr = nullptr;
+			_owner = nullptr;
+		}
+	}
+
+	inline T* Get() const { return _ptr; }
+	inline IComponentOwner* GetOwner() const { return _owner; }
+
+	/**
+	 * /brief Gives up the component without destroying it, the caller takes over its destruction and memory.
+	 */
+	T* Release() {
+		T* const ptr{ _ptr };
+		_ptr = nullptr;
+		_owner = nullptr;
+		return ptr;
+	}
+
+	/**
+	 * /brief Like operator* but tells the owner the component changed, the other accessors are untracked.
+	 */
+	inline T& GetMutable() const {
+		assert(_ptr);
+		_owner->OnComponentChanged(const_cast<std::remove_cv_t<T>*>(_ptr));
+		return *_ptr;
+	}
+
+	inline T* operator->() const { assert(_ptr); return _ptr; }
+	inline T& operator*() const { assert(_ptr); return *_ptr; }
+	inline explicit operator bool() const { return _ptr != nullptr; }
+
+	/**
+	 * /brief Adapter for code that needs shared ownership, transfers the component into a shared_ptr.
+	 * Allocates the control block, prefer the handle on hot paths.
+	 */
+	std::shared_ptr<T> ToShared() {
+		if (!_ptr)
+		{
+			return {};
+		}
+
+		IComponentOwner* const owner{ _owner };
+		std::shared_ptr<T> shared(_ptr, [owner](T* ptr) {
+			ptr->~T();
+			owner->ReleaseComponent(const_cast<std::remove_cv_t<T>*>(ptr));
+			});
+		_ptr = nullptr;
+		_owner = nullptr;
+		return shared;
+	}
+
+private:
+	T* _ptr{};
+	IComponentOwner* _owner{};
+};
@@ -0,0 +1,187 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CConcurrentIDGenerator.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "IIDGenerator.h"
+
+/**
+ * /brief Thread safe IIdGenerator, Generate and Release never take a lock.
+ * Fresh ids come from an atomic counter, released ids go to a lock-free stack whose head is tagged against ABA.
+ * Ids in use are tracked by an atomic bitmap, releasing an id that is not in use throws even under contention.
+ * The capacity is fixed at construction since the free list links and the bitmap cannot grow while other threads read them.
+ */
+template<typename ID_T>
+class CConcurrentIDGenerator final : public IIdGenerator<ID_T>
+{
+	static_assert(std::is_integral_v<ID_T> && std::is_unsigned_v<ID_T> && sizeof(ID_T) <= sizeof(uint32_t), "Ids must be unsigned integers of 32 bits at most!");
+public:
+	/**
+	 * /brief Ids are handed out in the range [0, maxNumOfIds).
+	 */
+	explicit CConcurrentIDGenerator(const uint32_t maxNumOfIds) : _maxNumOfIds(maxNumOfIds),
+		_nextFree(std::make_unique<std::atomic<uint32_t>[]>(maxNumOfIds)),
+		_inUse(std::make_unique<std::atomic<uint64_t>[]>((uint64_t(maxNumOfIds) + 63) / 64))
+	{
+		assert(maxNumOfIds > 0 && maxNumOfIds < FREE_LIST_END);
+	}
+	CConcurrentIDGenerator(const CConcurrentIDGenerator&) = delete;
+	CConcurrentIDGenerator& operator=(const CConcurrentIDGenerator&) = delete;
+
+	ID_T Generate() override
+	{
+		ID_T id;
+		if (!TryGenerate(id)) {
+			throw std::runtime_error("ID limit exceeded!");
+		}
+		return id;
+	}
+
+	/**
+	 * /brief Non throwing Generate, returns false when every id is in use.
+	 */
+	bool TryGenerate(ID_T& outId)
+	{
+		uint32_t index{ _popFree() };
+		if (index == FREE_LIST_END)
+		{
+			// Only bump the counter while below the limit so it never wraps on repeated exhaustion
+			uint32_t next{ _nextId.load(std::memory_order_relaxed) };
+			do
+			{
+				if (next >= _maxNumOfIds)
+				{
+					// A concurrent Release may have refilled the list meanwhile
+					index = _popFree();
+					if (index == FREE_LIST_END)
+						return false;
+					break;
+				}
+			} while (!_nextId.compare_exchange_weak(next, next + 1, std::memory_order_relaxed));
+
+			if (index == FREE_LIST_END)
+				index = next;
+		}
+
+		const uint64_t previous{ _inUse[index / 64].fetch_or(_bit(index), std::memory_order_acq_rel) };
+		(void)previous;
+		assert(!(previous & _bit(index)) && "Id handed out twice!");
+		outId = static_cast<ID_T>(index);
+		return true;
+	}
+
+	void Release(ID_T id) override
+	{
+		const uint32_t index{ static_cast<uint32_t>(id) };
+		if (index >= _maxNumOfIds) {
+			throw std::invalid_argument("ID not currently in use");
+		}
+
+		// Clearing the bit is the single point of ownership, only one of two concurrent releases of the same id wins
+		const uint64_t previous{ _inUse[index / 64].fetch_and(~_bit(index), std::memory_order_acq_rel) };
+		if (!(previous & _bit(index))) {
+			throw std::invalid_argument("ID not currently in use");
+		}
+
+		_pushFree(index);
+	}
+
+	bool IsUsed(ID_T id) const override
+	{
+		const uint32_t index{ static_cast<uint32_t>(id) };
+		return index < _maxNumOfIds && (_inUse[index / 64].load(std::memory_order_acquire) & _bit(index));
+	}
+
+	/**
+	 * /brief Returns one past the highest id ever handed out.
+	 */
+	ID_T GetMaxId() const override
+	{
+		return static_cast<ID_T>(_nextId.load(std::memory_order_acquire));
+	}
+
+private:
+	static constexpr uint32_t FREE_LIST_END{ UINT32_MAX };
+
+	const uint32_t _maxNumOfIds;
+	/**
+	 * /brief Next released id of the free list, indexed by id.
+	 */
+	std::unique_ptr<std::atomic<uint32_t>[]> _nextFree;
+	std::unique_ptr<std::atomic<uint64_t>[]> _inUse;
+	/**
+	 * /brief Free list head, the low 32 bits are the top id and the high 32 bits a tag bumped on every pop.
+	 */
+	alignas(64) std::atomic<uint64_t> _freeHead{ FREE_LIST_END };
+	alignas(64) std::atomic<uint32_t> _nextId{};
+
+	static inline uint64_t _bit(const uint32_t index) { return uint64_t(1) << (index % 64); }
+
+	uint32_t _popFree()
+	{
+		uint64_t head{ _freeHead.load(std::memory_order_acquire) };
+		for (;;)
+		{
+			const uint32_t index{ static_cast<uint32_t>(head) };
+			if (index == FREE_LIST_END)
+				return FREE_LIST_END;
+
+			// A stale next read is harmless, the tag makes the exchange fail if the head moved
+			const uint64_t next{ ((head >> 32) + 1) << 32 | _nextFree[index].load(std::memory_order_relaxed) };
+			if (_freeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+				return index;
+		}
+	}
+
+	void _pushFree(const uint32_t index)
+	{
+		uint64_t head{ _freeHead.load(std::memory_order_relaxed) };
+		for (;;)
+		{
+			_nextFree[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+			const uint64_t next{ (head & 0xFFFFFFFF00000000ull) | index };
+			if (_freeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed))
+				return;
+		}
+	}
+};
@@ -0,0 +1,338 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CConcurrentPagedAllocator.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <unordered_map>
+
+#include "CPagedAllocator.h"
+
+/**
+ * /brief Thread safe front-end of a CPagedAllocator.
+ * Each thread owns a magazine of fixed size blocks, allocations and frees are served by the calling thread's magazine without any lock.
+ * Empty magazines are refilled first from the lock-free remote free list, then in batch from the shared slabs.
+ * Overflowing magazines push half of their blocks to the remote free list, where the other threads collect them without locking,
+ * blocks freed by another thread than the allocating one flow back this way.
+ * The shared slabs are locked only on refill when the remote free list is empty, or on flush when the remote free list is above its watermark.
+ * Validation of the shared slabs follows Checked, blocks cached in the magazines and in the remote list are not validated.
+ */
+template<class IAlignedAllocator_T, uint64_t MagazineSize = 64, bool Checked = NECS_CHECKED_ALLOCATORS>
+class CConcurrentPagedAllocator final : public IPagedAllocator
+{
+	static_assert(MagazineSize >= 2, "A magazine must hold at least two blocks!");
+	friend class CConcurrentPagedAllocatorTest;
+public:
+	CConcurrentPagedAllocator(const uint64_t maxNumOfElementsPerSlab, const uint64_t elementSize) : IPagedAllocator(maxNumOfElementsPerSlab, elementSize), _backend(maxNumOfElementsPerSlab, elementSize), _listenerProxy(this) {}
+	CConcurrentPagedAllocator(const CConcurrentPagedAllocator&) = delete;
+	CConcurrentPagedAllocator& operator=(const CConcurrentPagedAllocator& other) = delete;
+
+	/**
+	 * /brief Blocks cached in the magazines and in the remote free list are released with the shared slabs.
+	 */
+	virtual ~CConcurrentPagedAllocator() = default;
+
+	void* Allocate() override
+	{
+		CMagazine& magazine{ _getThreadMagazine() };
+		if (magazine.Count == 0)
+		{
+			_refill(magazine);
+		}
+
+		return magazine.Blocks[--magazine.Count];
+	}
+
+	void Free(void* ptr) override
+	{
+		if (!ptr)
+			return;
+
+		CMagazine& magazine{ _getThreadMagazine() };
+		if (magazine.Count == MagazineSize)
+		{
+			_flush(magazine);
+		}
+
+		magazine.Blocks[magazine.Count++] = ptr;
+	}
+
+	/**
+	 * /brief Serves what the magazine holds, the remaining blocks are carved in contiguous runs from the shared slabs under a single lock.
+	 */
+	void AllocateBatch(const uint64_t count, void** const out) override
+	{
+		CMagazine& magazine{ _getThreadMagazine() };
+		uint64_t allocated{};
+		while (allocated < count && magazine.Count > 0)
+		{
+			out[allocated++] = magazine.Blocks[--magazine.Count];
+		}
+
+		if (allocated < count)
+		{
+			std::lock_guard<std::mutex> lock{ _backendMutex };
+			_backend.AllocateBatch(count - allocated, out + allocated);
+		}
+	}
+
+	void FreeBatch(void* const* const ptrs, const uint64_t count) override
+	{
+		CMagazine& magazine{ _getThreadMagazine() };
+		uint64_t freed{};
+		while (freed < count && magazine.Count < MagazineSize)
+		{
+			magazine.Blocks[magazine.Count++] = ptrs[freed++];
+		}
+
+		if (freed < count)
+		{
+			std::lock_guard<std::mutex> lock{ _backendMutex };
+			_backend.FreeBatch(ptrs + freed, count - freed);
+		}
+	}
+
+	/**
+	 * /brief Blocks are interchangeable, the block goes to the calling thread's magazine.
+	 */
+	void FreeFromSlab(void* ptr, const uint64_t slabIndex) override { Free(ptr); }
+
+	uint64_t GetFixedBlockSize()const override { return _backend.GetFixedBlockSize(); }
+
+	void SetSlabListener(IPagedAllocatorSlabListener* const listener) override
+	{
+		std::lock_guard<std::mutex> lock{ _backendMutex };
+		_listenerProxy.Listener = listener;
+		_backend.SetSlabListener(listener ? &_listenerProxy : nullptr);
+	}
+
+	/**
+	 * /brief See CPagedAllocator::SetSlabGranularity.
+	 */
+	void SetSlabGranularity(const uint64_t bytes)
+	{
+		std::lock_guard<std::mutex> lock{ _backendMutex };
+		_backend.SetSlabGranularity(bytes);
+	}
+
+	/**
+	 * /brief See CPagedAllocator::SetEmptySlabRetention, blocks cached by the magazines and the remote list keep their slabs alive.
+	 */
+	void SetEmptySlabRetention(const uint64_t numOfSlabs)
+	{
+		std::lock_guard<std::mutex> lock{ _backendMutex };
+		_backend.SetEmptySlabRetention(numOfSlabs);
+	}
+
+	uint64_t ReleaseEmptySlabs(const uint64_t numOfSlabsToKeep = 0)
+	{
+		std::lock_guard<std::mutex> lock{ _backendMutex };
+		return _backend.ReleaseEmptySlabs(numOfSlabsToKeep);
+	}
+
+	/**
+	 * /brief Counters of the shared slabs, lock free. Blocks cached by the magazines and the remote list count as live.
+	 */
+	inline DAllocatorStats GetStats() const { return _backend.GetStats(); }
+
+	/**
+	 * /brief Returns the calling thread's cached blocks to the shared slabs, call it before a worker thread exits.
+	 */
+	void FlushThreadCache()
+	{
+		CMagazine& magazine{ _getThreadMagazine() };
+
+		std::lock_guard<std::mutex> lock{ _backendMutex };
+		_backend.FreeBatch(magazine.Blocks.data(), magazine.Count);
+		magazine.Count = 0;
+	}
+
+	/**
+	 * /brief Returns the remote free list to the shared slabs.
+	 */
+	void Trim()
+	{
+		void* head{ _remoteFrees.exchange(nullptr, std::memory_order_acquire) };
+		std::lock_guard<std::mutex> lock{ _backendMutex };
+		while (head)
+		{
+			void* const next{ *reinterpret_cast<void**>(head) };
+			_backend.Free(head);
+			_remoteCount.fetch_sub(1, std::memory_order_relaxed);
+			head = next;
+		}
+	}
+
+private:
+	/**
+	 * /brief Above this amount of remote blocks, overflowing magazines flush to the shared slabs instead.
+	 */
+	inline static constexpr uint64_t REMOTE_WATERMARK{ MagazineSize * 16 };
+
+	struct CMagazine
+	{
+		std::array<void*, MagazineSize> Blocks{};
+		uint64_t Count{};
+	};
+
+	struct DThreadCache
+	{
+		uint64_t AllocatorId{};
+		CMagazine* Magazine{};
+	};
+
+	/**
+	 * /brief Forwards slab events with the front-end as owner, so indices resolve to this allocator rather than the backend.
+	 */
+	struct CSlabListenerProxy final : public IPagedAllocatorSlabListener
+	{
+		explicit CSlabListenerProxy(IPagedAllocator* const owner) : Owner(owner) {}
+
+		uint64_t GetSlabGranularity()const override { return Listener->GetSlabGranularity(); }
+		void OnSlabAllocated(IPagedAllocator* const owner, const uint64_t slabIndex, void* const slab, const uint64_t bytes) override { Listener->OnSlabAllocated(Owner, slabIndex, slab, bytes); }
+		void OnSlabReleased(IPagedAllocator* const owner, const uint64_t slabIndex, void* const slab, const uint64_t bytes) override { Listener->OnSlabReleased(Owner, slabIndex, slab, bytes); }
+
+		IPagedAllocator* const Owner;
+		IPagedAllocatorSlabListener* Listener{};
+	};
+
+	/**
+	 * /brief Direct mapped per thread cache, a thread alternating between a few allocators doesn't go through the lookup.
+	 */
+	inline static constexpr uint64_t THREAD_CACHE_ENTRIES{ 8 };
+
+	inline static std::atomic<uint64_t> _nextAllocatorId{ 1 };
+	inline static thread_local std::array<DThreadCache, THREAD_CACHE_ENTRIES> _threadCache{};
+
+	const uint64_t _allocatorId{ _nextAllocatorId.fetch_add(1, std::memory_order_relaxed) };
+
+	std::mutex _backendMutex;
+	CPagedAllocator<IAlignedAllocator_T, Checked> _backend;
+	CSlabListenerProxy _listenerProxy;
+
+	std::mutex _magazinesMutex;
+	std::unordered_map<std::thread::id, std::unique_ptr<CMagazine>> _magazines;
+
+	/**
+	 * /brief Treiber stack linked through the blocks, pushes are CAS and the consumers take the whole list at once so there is no ABA.
+	 */
+	std::atomic<void*> _remoteFrees{};
+	std::atomic<uint64_t> _remoteCount{};
+
+	CMagazine& _getThreadMagazine()
+	{
+		DThreadCache& cache{ _threadCache[_allocatorId % THREAD_CACHE_ENTRIES] };
+		if (cache.AllocatorId == _allocatorId)
+			return *cache.Magazine;
+
+		std::lock_guard<std::mutex> lock{ _magazinesMutex };
+		auto& magazine{ _magazines[std::this_thread::get_id()] };
+		if (!magazine)
+			magazine = std::make_unique<CMagazine>();
+
+		cache.AllocatorId = _allocatorId;
+		cache.Magazine = magazine.get();
+		return *magazine;
+	}
+
+	void _refill(CMagazine& magazine)
+	{
+		// Collect the blocks freed by other threads first
+		void* head{ _remoteFrees.exchange(nullptr, std::memory_order_acquire) };
+		while (head && magazine.Count < MagazineSize)
+		{
+			magazine.Blocks[magazine.Count++] = head;
+			head = *reinterpret_cast<void**>(head);
+		}
+		_remoteCount.fetch_sub(magazine.Count, std::memory_order_relaxed);
+
+		// Give back what didn't fit
+		if (head)
+		{
+			void* tail{ head };
+			uint64_t count{ 1 };
+			while (*reinterpret_cast<void**>(tail))
+			{
+				tail = *reinterpret_cast<void**>(tail);
+				count++;
+			}
+			_pushRemoteChain(head, tail, count);
+			_remoteCount.fetch_sub(count, std::memory_order_relaxed);
+		}
+
+		if (magazine.Count > 0)
+			return;
+
+		// Refill half the magazine so the following frees don't overflow right away
+		std::lock_guard<std::mutex> lock{ _backendMutex };
+		_backend.AllocateBatch(MagazineSize / 2, magazine.Blocks.data());
+		magazine.Count = MagazineSize / 2;
+	}
+
+	void _flush(CMagazine& magazine)
+	{
+		const uint64_t count{ MagazineSize / 2 };
+		magazine.Count -= count;
+		void** const blocks{ magazine.Blocks.data() + magazine.Count };
+
+		if (_remoteCount.load(std::memory_order_relaxed) >= REMOTE_WATERMARK)
+		{
+			std::lock_guard<std::mutex> lock{ _backendMutex };
+			_backend.FreeBatch(blocks, count);
+			return;
+		}
+
+		// Link the blocks into a chain and publish it with a single CAS
+		for (uint64_t i{}; i + 1 < count; i++)
+		{
+			*reinterpret_cast<void**>(blocks[i]) = blocks[i + 1];
+		}
+		_pushRemoteChain(blocks[0], blocks[count - 1], count);
+	}
+
+	void _pushRemoteChain(void* const head, void* const tail, const uint64_t count)
+	{
+		_remoteCount.fetch_add(count, std::memory_order_relaxed);
+		void* expected{ _remoteFrees.load(std::memory_order_relaxed) };
+		do
+		{
+			*reinterpret_cast<void**>(tail) = expected;
+		} while (!_remoteFrees.compare_exchange_weak(expected, head, std::memory_order_release, std::memory_order_relaxed));
+	}
+};
@@ -0,0 +1,221 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CDenseComponentStore.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <type_traits>
+
+#include "CTypeIndex.h"
+
+/**
+ * /brief Stable handle to a component of a dense store, a removed component invalidates its handles.
+ */
+struct DDenseComponentHandle
+{
+	inline static constexpr uint32_t INVALID_INDEX{ std::numeric_limits<uint32_t>::max() };
+
+	uint32_t Slot{ INVALID_INDEX };
+	uint32_t Generation{};
+
+	inline bool IsValid()const { return Slot != INVALID_INDEX; }
+	inline bool operator==(const DDenseComponentHandle& other)const { return Slot == other.Slot && Generation == other.Generation; }
+	inline bool operator!=(const DDenseComponentHandle& other)const { return !(*this == other); }
+};
+
+class IDenseComponentStore
+{
+public:
+	virtual ~IDenseComponentStore() = default;
+
+	virtual bool Remove(const DDenseComponentHandle handle) = 0;
+	virtual uint64_t Size()const = 0;
+};
+
+/**
+ * /brief Structure of arrays storage of one component type.
+ * Components are packed in a contiguous array so systems can iterate them linearly, removal moves the last component in the hole.
+ * Handles go through a slot table with generation counters, so they stay valid while components move.
+ */
+template<typename T>
+class CDenseComponentStore final : public IDenseComponentStore
+{
+	static_assert(std::is_move_constructible<T>::value && std::is_move_assignable<T>::value, "Dense components must be movable!");
+public:
+	template<typename... Args>
+	DDenseComponentHandle Add(Args&&... args)
+	{
+		uint32_t slot{};
+		if (_freeSlot != DDenseComponentHandle::INVALID_INDEX)
+		{
+			slot = _freeSlot;
+			_freeSlot = _slots[slot].DenseIndex;
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(_slots.size());
+			_slots.emplace_back();
+		}
+
+		_slots[slot].DenseIndex = static_cast<uint32_t>(_components.size());
+		_components.emplace_back(std::forward<Args>(args)...);
+		_denseToSlot.push_back(slot);
+
+		return DDenseComponentHandle{ slot, _slots[slot].Generation };
+	}
+
+	bool Remove(const DDenseComponentHandle handle) override
+	{
+		if (!Contains(handle))
+			return false;
+
+		const uint32_t denseIndex{ _slots[handle.Slot].DenseIndex };
+		const uint32_t lastIndex{ static_cast<uint32_t>(_components.size() - 1) };
+		if (denseIndex != lastIndex)
+		{
+			// Fill the hole with the last component to keep the array packed
+			_components[denseIndex] = std::move(_components[lastIndex]);
+			_denseToSlot[denseIndex] = _denseToSlot[lastIndex];
+			_slots[_denseToSlot[denseIndex]].DenseIndex = denseIndex;
+		}
+		_components.pop_back();
+		_denseToSlot.pop_back();
+
+		// Bump the generation so that stale handles don't alias the next component of the slot
+		_slots[handle.Slot].Generation++;
+		_slots[handle.Slot].DenseIndex = _freeSlot;
+		_freeSlot = handle.Slot;
+		return true;
+	}
+
+	inline bool Contains(const DDenseComponentHandle handle)const
+	{
+		return handle.Slot < _slots.size() && _slots[handle.Slot].Generation == handle.Generation && _isLive(handle.Slot);
+	}
+
+	/**
+	 * /brief Returns nullptr if the handle is stale, the pointer is valid until the next Add or Remove.
+	 */
+	T* Get(const DDenseComponentHandle handle)
+	{
+		return Contains(handle) ? &_components[_slots[handle.Slot].DenseIndex] : nullptr;
+	}
+
+	const T* Get(const DDenseComponentHandle handle)const
+	{
+		return Contains(handle) ? &_components[_slots[handle.Slot].DenseIndex] : nullptr;
+	}
+
+	/**
+	 * /brief Handle of the component at the dense position, used while iterating.
+	 */
+	DDenseComponentHandle GetHandleAt(const uint64_t denseIndex)const
+	{
+		assert(denseIndex < _components.size());
+		const uint32_t slot{ _denseToSlot[denseIndex] };
+		return DDenseComponentHandle{ slot, _slots[slot].Generation };
+	}
+
+	uint64_t Size()const override { return _components.size(); }
+	T* Data() { return _components.data(); }
+	const T* Data()const { return _components.data(); }
+
+	typename std::vector<T>::iterator begin() { return _components.begin(); }
+	typename std::vector<T>::iterator end() { return _components.end(); }
+	typename std::vector<T>::const_iterator begin()const { return _components.begin(); }
+	typename std::vector<T>::const_iterator end()const { return _components.end(); }
+
+	void Reserve(const uint64_t count)
+	{
+		_components.reserve(count);
+		_denseToSlot.reserve(count);
+	}
+
+private:
+	struct DSlot
+	{
+		/**
+		 * /brief Position in the dense array when live, next free slot when free.
+		 */
+		uint32_t DenseIndex{};
+		uint32_t Generation{};
+	};
+
+	std::vector<T> _components;
+	std::vector<uint32_t> _denseToSlot;
+	std::vector<DSlot> _slots;
+	uint32_t _freeSlot{ DDenseComponentHandle::INVALID_INDEX };
+
+	inline bool _isLive(const uint32_t slot)const
+	{
+		const uint32_t denseIndex{ _slots[slot].DenseIndex };
+		return denseIndex < _denseToSlot.size() && _denseToSlot[denseIndex] == slot;
+	}
+};
+
+/**
+ * /brief Opt-in dense stores keyed by component type, a store is created on first use.
+ */
+class CDenseComponentStorage final
+{
+public:
+	template<typename T>
+	CDenseComponentStore<T>& GetStore()
+	{
+		const uint32_t typeIndex{ CComponentTypeIndex::Of<T>() };
+		if (typeIndex >= _stores.size())
+			_stores.resize(typeIndex + 1);
+
+		auto& store{ _stores[typeIndex] };
+		if (!store)
+			store = std::make_unique<CDenseComponentStore<T>>();
+
+		return *static_cast<CDenseComponentStore<T>*>(store.get());
+	}
+
+	template<typename T>
+	bool HasStore()const
+	{
+		const uint32_t typeIndex{ CComponentTypeIndex::Of<T>() };
+		return typeIndex < _stores.size() && _stores[typeIndex];
+	}
+
+private:
+	std::vector<std::unique_ptr<IDenseComponentStore>> _stores;
+};
@@ -35,15 +35,17 @@
 
 #pragma once
 
-#include <iostream>
 #include <string>
 #include <unordered_map>
-#include <functional>
+#include <vector>
 #include <memory>
 #include <stdexcept>
+#include <algorithm>
 
 #include "necs/CWorldObject.h"
 #include "necs/IEntityFactory.h"
+#include "necs/CHeapAlignedAllocator.h"
+#include "necs/BitUtils.h"
 
 class CWorld;
 
@@ -51,10 +53,25 @@ class CEntityFactory final : public  IEntityFactory {
 	friend class CEntityFactoryFixture;
 public:
 	CEntityFactory() = default;
-	virtual ~CEntityFactory() = default;
+	virtual ~CEntityFactory()
+	{
+		for (const auto& descriptor : _descriptors)
+		{
+			if (descriptor.Construct)
+			{
+				descriptor.Destroy(const_cast<CWorldObject*>(descriptor.CDO));
+			}
+		}
+
+		CHeapAlignedAllocator heap;
+		for (void* const chunk : _cdoChunks)
+		{
+			heap.Free(chunk);
+		}
+	}
 
-	// new(void*) T(DWorldObjectInitielizer*const)
-	using CreateFunc = std::function<CWorldObject* (void*, const DWorldObjectInitializer&)>;
+	CEntityFactory(const CEntityFactory&) = delete;
+	CEntityFactory& operator=(const CEntityFactory&) = delete;
 
 	// Register a type with its associated creation function
 	template <typename T>
@@ -65,42 +82,255 @@ public:
 		cdoInitializer.ClassSize = sizeof(T);
 		cdoInitializer.ClassAlignment = alignof(T);
 
-		assert(_classNameToCreateFnAndCdo.find(typeName) == _classNameToCreateFnAndCdo.end() && "Type must not be registered");
+		const uint32_t classId{ GetClassId<T>() };
+
+		assert(_classNameToClassId.find(typeName) == _classNameToClassId.end() && "Type must not be registered");
+		assert(!IsClassRegistered(classId) && "Type must not be registered");
+
+		if (_descriptors.size() <= classId)
+		{
+			_descriptors.resize(classId + 1);
+			_tickSettings.resize(classId + 1);
+			_relocators.resize(classId + 1);
+			_classNames.resize(classId + 1);
+		}
 
-		_classNameToCreateFnAndCdo[typeName] = std::make_pair([](void* memory, const DWorldObjectInitializer& initializer) -> T* {
-			new(memory) T(initializer);
-			return reinterpret_cast<T*>(memory);
-			}, std::make_unique<T>(cdoInitializer));
+		T* const cdo{ new(_allocateCDOMemory(sizeof(T), alignof(T))) T(cdoInitializer) };
+
+		auto& descriptor{ _descriptors[classId] };
+		descriptor.Construct = &CEntityFactory::_construct<T>;
+		if constexpr (std::is_constructible_v<T, const DWorldObjectInitializer&, const T&>)
+		{
+			descriptor.Clone = &CEntityFactory::_clone<T>;
+		}
+		descriptor.Destroy = &CEntityFactory::_destroy<T>;
+		descriptor.TickBucket = &CEntityFactory::_tickBucket<T>;
+		descriptor.CDO = cdo;
+		descriptor.Size = static_cast<uint32_t>(sizeof(T));
+		descriptor.Alignment = static_cast<uint32_t>(alignof(T));
+		descriptor.AllocationSize = sizeof(T) + cdo->ComputeComponentsMaxSizeForAllocation();
+		descriptor.ClassId = classId;
+
+		_tickSettings[classId] = T::GetStaticTickSettings();
+		if constexpr (std::is_constructible_v<T, const DWorldObjectRelocation&, T&&>)
+		{
+			_relocators[classId] = &CEntityFactory::_relocate<T>;
+		}
+
+		_classNames[classId] = typeName;
+		_classNameToClassId.emplace(typeName, classId);
+		_cdoToClassId.emplace(static_cast<const IWorldObjectCDO*>(cdo), classId);
 	}
 
 	// Create an instance based on the type name
 	CWorldObject* PlacementNewFromTypename(void* memory,
-		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const std::string& typeName) override {
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const std::string& typeName, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) override {
+		return PlacementNewFromClassId(memory, pendingDestroyNotifier, GetClassIdFromTypename(typeName), runtimeComponentsAllocator, frameComponentsAllocator);
+	}
+
+	CWorldObject* PlacementNewFromClassId(void* memory,
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const uint32_t classId, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) override {
+		assert(IsClassRegistered(classId) && "Type not registered");
+		const auto& descriptor{ _descriptors[classId] };
+		return descriptor.Construct(memory, _makeInitializer(memory, descriptor, pendingDestroyNotifier, runtimeComponentsAllocator, frameComponentsAllocator)); // Call the placement new function
+	}
+
+	CWorldObject* PlacementCloneFromPrototype(void* memory,
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const CWorldObject& prototype, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) override {
+		assert(!prototype.IsCDO() && "The CDO can't be a prototype");
+		assert(IsClassRegistered(prototype.GetStaticClassId()) && "Type not registered");
+
+		const auto& descriptor{ _descriptors[prototype.GetStaticClassId()] };
+		if (!descriptor.Clone)
+			throw std::runtime_error("Class has no prototype constructor!");
+
+		return descriptor.Clone(memory, _makeInitializer(memory, descriptor, pendingDestroyNotifier, runtimeComponentsAllocator, frameComponentsAllocator), prototype);
+	}
+
+	CWorldObject* PlacementRelocate(void* memory,
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, CWorldObject& object, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) override {
+		assert(!object.IsCDO() && "The CDO can't be relocated");
+		const uint32_t classId{ object.GetStaticClassId() };
+		assert(IsClassRegistered(classId) && "Type not registered");
+
+		if (!IsClassRelocatable(classId))
+			throw std::runtime_error("Class has no relocating constructor!");
+
+		return _relocators[classId](memory, _makeInitializer(memory, _descriptors[classId], pendingDestroyNotifier, runtimeComponentsAllocator, frameComponentsAllocator), object);
+	}
+
+	bool IsClassRelocatable(const uint32_t classId) const override
+	{
+		return classId < _relocators.size() && _relocators[classId] != nullptr;
+	}
+
+	const IWorldObjectCDO& GetCDOFromTypename(const std::string& typeName) const override
+	{
+		return GetCDOFromClassId(GetClassIdFromTypename(typeName));
+	}
+
+	const IWorldObjectCDO& GetCDOFromClassId(const uint32_t classId) const override
+	{
+		assert(IsClassRegistered(classId) && "Type not registered");
+		return *_descriptors[classId].CDO;
+	}
+
+	uint32_t GetClassIdFromTypename(const std::string& typeName) const override
+	{
+		const auto it{ _classNameToClassId.find(typeName) };
+		assert(it != _classNameToClassId.end() && "Type not registered");
+		return it->second;
+	}
+
+	uint32_t FindClassIdFromTypename(const std::string& typeName) const override
+	{
+		const auto it{ _classNameToClassId.find(typeName) };
+		return it != _classNameToClassId.end() ? it->second : UINT32_MAX;
+	}
+
+	const std::string& GetClassTypename(const uint32_t classId) const override
+	{
+		assert(IsClassRegistered(classId) && "Type not registered");
+		return _classNames[classId];
+	}
+
+	const DEntityClassDescriptor& GetClassDescriptor(const uint32_t classId) const override
+	{
+		assert(IsClassRegistered(classId) && "Type not registered");
+		return _descriptors[classId];
+	}
+
+	bool IsClassRegistered(const uint32_t classId) const override
+	{
+		return classId < _descriptors.size() && _descriptors[classId].Construct != nullptr;
+	}
+
+	uint32_t GetClassIdsEnd() const override
+	{
+		return static_cast<uint32_t>(_descriptors.size());
+	}
+
+	WorldObjectTickBucketFunc GetTickBucketFunc(const IWorldObjectCDO& classCdo) const override
+	{
+		return _descriptors[_getClassIdFromCDO(classCdo)].TickBucket;
+	}
+
+	const DTickSettings& GetTickSettings(const IWorldObjectCDO& classCdo) const override
+	{
+		return _tickSettings[_getClassIdFromCDO(classCdo)];
+	}
+
+private:
+	static constexpr uint64_t CDO_CHUNK_SIZE{ 16 * 1024 };
+
+	/**
+	 * /brief Indexed by class id, ids are process wide so a factory may leave holes for classes it doesn't register.
+	 * Only what spawning reads lives here, one cache line per class.
+	 */
+	std::vector<DEntityClassDescriptor> _descriptors;
+	/**
+	 * /brief Cold per class data, read when a tick bucket is created.
+	 */
+	std::vector<DTickSettings> _tickSettings;
+	/**
+	 * /brief Cold too, null for the classes without a relocating constructor.
+	 */
+	std::vector<WorldObjectRelocateFunc> _relocators;
+	std::vector<std::string> _classNames;
+	/**
+	 * /brief Data driven and editor paths only, the typed spawn path never hashes names.
+	 */
+	std::unordered_map<std::string, uint32_t> _classNameToClassId;
+	std::unordered_map<const IWorldObjectCDO*, uint32_t> _cdoToClassId;
+
+	/**
+	 * /brief CDOs are packed in chunks instead of one heap allocation each.
+	 */
+	std::vector<void*> _cdoChunks;
+	uintptr_t _cdoChunkCursor{};
+	uintptr_t _cdoChunkEnd{};
+
+	void* _allocateCDOMemory(const uint64_t bytes, const uint64_t alignment)
+	{
+		uintptr_t address{ AlignUp(_cdoChunkCursor, alignment) };
+		if (_cdoChunks.empty() || address + bytes > _cdoChunkEnd)
+		{
+			const uint64_t chunkAlignment{ std::max<uint64_t>(alignment, alignof(std::max_align_t)) };
+			const uint64_t chunkSize{ std::max(CDO_CHUNK_SIZE, AlignUp(bytes, chunkAlignment)) };
+			void* const chunk{ CHeapAlignedAllocator().Allocate(chunkSize, chunkAlignment) };
+			_cdoChunks.push_back(chunk);
+			address = reinterpret_cast<uintptr_t>(chunk);
+			_cdoChunkEnd = address + chunkSize;
+		}
+
+		_cdoChunkCursor = address + bytes;
+		return reinterpret_cast<void*>(address);
+	}
+
+	static DWorldObjectInitializer _makeInitializer(void* memory, const DEntityClassDescriptor& descriptor,
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, IAlignedAllocator* const runtimeComponentsAllocator, CFrameArenaAllocator* const frameComponentsAllocator)
+	{
 		assert(memory);
 		assert(pendingDestroyNotifier);
-
-		const auto it{ _classNameToCreateFnAndCdo.find(typeName) };
-		assert(it != _classNameToCreateFnAndCdo.end() && "Type not registered");
+		assert(reinterpret_cast<uintptr_t>(memory) % descriptor.Alignment == 0 && "Memory must be correctly aligned!");
 
 		DWorldObjectInitializer initializer{};
-		initializer.StaticClassCDO = static_cast<IWorldObjectCDO*>(it->second.second.get());
-		initializer.ClassSize = initializer.StaticClassCDO->GetClassSize();
-		initializer.ClassAlignment = initializer.StaticClassCDO->GetClassAlignment();
+		initializer.StaticClassCDO = descriptor.CDO;
+		initializer.ClassSize = descriptor.Size;
+		initializer.ClassAlignment = descriptor.Alignment;
 		initializer.PendingDestroyNotifier = pendingDestroyNotifier;
+		initializer.RuntimeComponentsAllocator = runtimeComponentsAllocator;
+		initializer.FrameComponentsAllocator = frameComponentsAllocator;
+		initializer.ClassId = descriptor.ClassId;
+		return initializer;
+	}
 
-		assert(reinterpret_cast<uintptr_t>(memory) % initializer.StaticClassCDO->GetClassAlignment() == 0 && "Memory must be correctly aligned!");
+	uint32_t _getClassIdFromCDO(const IWorldObjectCDO& classCdo) const
+	{
+		const auto it{ _cdoToClassId.find(&classCdo) };
+		assert(it != _cdoToClassId.end() && "Type not registered");
+		return it->second;
+	}
 
-		return it->second.first(memory, initializer); // Call the placement new function
+	template<typename T>
+	static CWorldObject* _construct(void* memory, const DWorldObjectInitializer& initializer)
+	{
+		CWorldObject* const object{ new(memory) T(initializer) };
+		// Component offsets are relative to the allocation, CWorldObject must be the primary base
+		assert(static_cast<void*>(object) == memory && "CWorldObject must be the first base of the class");
+		return object;
+	}
 
+	template<typename T>
+	static CWorldObject* _clone(void* memory, const DWorldObjectInitializer& initializer, const CWorldObject& prototype)
+	{
+		assert(prototype.GetStaticClassId() == GetClassId<T>());
+		return new(memory) T(initializer, static_cast<const T&>(prototype));
 	}
 
-	const IWorldObjectCDO& GetCDOFromTypename(const std::string& typeName) const override
+	template<typename T>
+	static CWorldObject* _relocate(void* memory, const DWorldObjectInitializer& initializer, CWorldObject& object)
 	{
-		const auto it{ _classNameToCreateFnAndCdo.find(typeName) };
-		assert(it != _classNameToCreateFnAndCdo.end() && "Type not registered");
-		return *static_cast<IWorldObjectCDO*>(it->second.second.get());
+		static_assert(std::is_nothrow_constructible_v<T, const DWorldObjectRelocation&, T&&>, "Relocating constructors must be noexcept!");
+		assert(object.GetStaticClassId() == GetClassId<T>());
+		return new(memory) T(DWorldObjectRelocation{ initializer }, std::move(static_cast<T&>(object)));
 	}
 
-private:
-	std::unordered_map<std::string, std::pair<CreateFunc, std::unique_ptr<CWorldObject>>> _classNameToCreateFnAndCdo;
-};
\ No newline at end of file
+	template<typename T>
+	static void _destroy(CWorldObject* const object)
+	{
+		static_cast<T*>(object)->~T();
+	}
+
+	/**
+	 * /brief The qualified call binds statically to the class Tick, every object of the bucket is exactly a T.
+	 */
+	template<typename T>
+	static void _tickBucket(CWorldObject* const* const objects, const uint64_t count)
+	{
+		for (uint64_t i{}; i < count; i++)
+		{
+			static_cast<T*>(objects[i])->T::Tick();
+		}
+	}
+};
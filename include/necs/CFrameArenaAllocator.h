@@ -0,0 +1,144 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CFrameArenaAllocator.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "IAlignedAllocator.h"
+#include "CComponentHandle.h"
+#include "CHeapAlignedAllocator.h"
+
+/**
+ * /brief Double buffered linear allocator for memory that lives at most two frames.
+ * Allocate is a lock-free pointer bump in the current chunk, Free does nothing, SwapFrames reclaims a whole frame at once.
+ * Memory allocated during frame N stays valid until the swap ending frame N + 1, so transient data can be read the frame after it was produced.
+ * Allocate is thread safe, SwapFrames must not run concurrently with it.
+ * As a component owner it lets component handles destroy transient components without giving any memory back.
+ */
+class CFrameArenaAllocator final : public IAlignedAllocator, public IComponentOwner
+{
+public:
+	/**
+	 * /param chunkSize Bytes requested from the backing allocator when the current chunk is full, larger allocations get a chunk of their own.
+	 * /param backingAllocator Optional, serves the chunks, the system heap by default.
+	 */
+	explicit CFrameArenaAllocator(const uint64_t chunkSize = 64 * 1024, IAlignedAllocator* const backingAllocator = nullptr);
+	~CFrameArenaAllocator();
+
+	CFrameArenaAllocator(const CFrameArenaAllocator&) = delete;
+	CFrameArenaAllocator& operator=(const CFrameArenaAllocator&) = delete;
+
+	void* Allocate(const uint64_t bytes, const uint64_t alignement) override
+	{
+		for (;;)
+		{
+			DChunk* const chunk{ _current.load(std::memory_order_acquire) };
+			if (chunk)
+			{
+				uint64_t cursor{ chunk->Cursor.load(std::memory_order_relaxed) };
+				for (;;)
+				{
+					const uint64_t begin{ AlignUp(reinterpret_cast<uintptr_t>(chunk->Memory) + cursor, alignement) - reinterpret_cast<uintptr_t>(chunk->Memory) };
+					if (begin + bytes > chunk->Size)
+						break;
+					if (chunk->Cursor.compare_exchange_weak(cursor, begin + bytes, std::memory_order_relaxed))
+						return chunk->Memory + begin;
+				}
+			}
+			_nextChunk(chunk, bytes, alignement);
+		}
+	}
+
+	/**
+	 * /brief Does nothing, the memory is reclaimed by SwapFrames.
+	 */
+	void Free(void* ptr) override {}
+
+	/**
+	 * /brief The component was already destroyed by its handle, its memory is reclaimed by SwapFrames.
+	 */
+	void ReleaseComponent(void* ptr) override {}
+
+	/**
+	 * /brief Ends the frame, the frame before it is reclaimed and its chunks serve the next one.
+	 */
+	void SwapFrames();
+
+	/**
+	 * /brief Bytes held from the backing allocator by both frames.
+	 */
+	inline uint64_t GetReservedBytes() const { return _reservedBytes; }
+
+private:
+	struct DChunk
+	{
+		uint8_t* Memory{};
+		uint64_t Size{};
+		std::atomic<uint64_t> Cursor{};
+	};
+
+	struct DFrame
+	{
+		std::vector<std::unique_ptr<DChunk>> Chunks;
+		/**
+		 * /brief Chunks below it were used this frame.
+		 */
+		uint64_t NumOfUsedChunks{};
+	};
+
+	const uint64_t _chunkSize;
+	CHeapAlignedAllocator _heapAllocator;
+	IAlignedAllocator& _backingAllocator;
+
+	std::array<DFrame, 2> _frames;
+	uint32_t _currentFrame{};
+	std::atomic<DChunk*> _current{};
+	/**
+	 * /brief Serializes the slow path, only taken when a chunk runs out.
+	 */
+	std::mutex _chunksMutex;
+	uint64_t _reservedBytes{};
+
+	/**
+	 * /brief Installs a chunk with room for the allocation, unless another thread already replaced the full one.
+	 */
+	void _nextChunk(DChunk* const full, const uint64_t bytes, const uint64_t alignement);
+};
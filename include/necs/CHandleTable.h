@@ -0,0 +1,115 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CHandleTable.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cassert>
+#include <vector>
+
+#include "necs/IIDGenerator.h"
+
+class CWorldObject;
+
+/**
+ * /brief Maps generational ids to pointers, resolving a stale or released id returns nullptr instead of aliasing a newer object.
+ */
+template<typename T>
+class CHandleTable final
+{
+public:
+	DGenerationalId Add(T* const ptr) {
+		assert(ptr);
+		const DGenerationalId id{ _generator.Generate() };
+		if (_pointers.size() <= id.Index)
+		{
+			_pointers.resize(id.Index + 1);
+		}
+		_pointers[id.Index] = ptr;
+		++_size;
+		return id;
+	}
+
+	void Remove(const DGenerationalId id) {
+		_generator.Release(id);
+		_pointers[id.Index] = nullptr;
+		--_size;
+	}
+
+	T* Resolve(const DGenerationalId id) const {
+		return _generator.IsUsed(id) ? _pointers[id.Index] : nullptr;
+	}
+
+	inline bool IsAlive(const DGenerationalId id) const { return _generator.IsUsed(id); }
+	inline uint64_t Size() const { return _size; }
+
+	inline const CGenerationalIdGenerator& GetGenerator() const { return _generator; }
+
+	/**
+	 * /brief Restores the generator state with no pointer bound, every id in use must then be bound with Bind.
+	 */
+	void Restore(std::vector<CGenerationalIdGenerator::DSlot> slots, const uint32_t freeHead) {
+		_generator.Restore(std::move(slots), freeHead);
+		_pointers.assign(_generator.GetSlots().size(), nullptr);
+		_size = 0;
+	}
+
+	/**
+	 * /brief Binds a pointer to an id in use since the last Restore.
+	 */
+	void Bind(const DGenerationalId id, T* const ptr) {
+		assert(ptr);
+		assert(_generator.IsUsed(id) && !_pointers[id.Index] && "Id not in use or already bound");
+		_pointers[id.Index] = ptr;
+		++_size;
+	}
+
+	/**
+	 * /brief Points a bound id to the new address of its relocated object.
+	 */
+	void Rebind(const DGenerationalId id, T* const ptr) {
+		assert(ptr);
+		assert(_generator.IsUsed(id) && _pointers[id.Index] && "Id not in use or not bound");
+		_pointers[id.Index] = ptr;
+	}
+
+private:
+	CGenerationalIdGenerator _generator;
+	std::vector<T*> _pointers;
+	uint64_t _size{};
+};
+
+using DWorldObjectHandle = DGenerationalId;
+using CWorldObjectHandleTable = CHandleTable<CWorldObject>;
@@ -0,0 +1,75 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CHeapAlignedAllocator.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cstdlib>
+#include <new>
+#if _WIN32
+#include <malloc.h>
+#endif
+
+#include "IAlignedAllocator.h"
+#include "BitUtils.h"
+
+/**
+ * /brief Aligned allocator backed by the system heap.
+ */
+class CHeapAlignedAllocator final : public IAlignedAllocator
+{
+public:
+	void* Allocate(const uint64_t bytes, const uint64_t alignement) override {
+#if _WIN32
+		void* ptr{ _aligned_malloc(bytes, alignement) };
+#else
+		// aligned_alloc requires the size to be a multiple of the alignment
+		void* ptr{ std::aligned_alloc(alignement, AlignUp(bytes, alignement)) };
+#endif
+		if (!ptr)
+		{
+			throw std::bad_alloc();
+		}
+		return ptr;
+	};
+
+	void Free(void* ptr) override {
+#if _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	};
+};
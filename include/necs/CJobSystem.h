@@ -0,0 +1,127 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CJobSystem.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * /brief Counts the scheduled jobs not yet completed, waiting on it runs pending jobs on the waiting thread.
+ */
+class CJobCounter final
+{
+	friend class CJobSystem;
+public:
+	inline bool IsDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	std::atomic<uint32_t> _pending{};
+};
+
+/**
+ * /brief Work stealing job system, each worker owns a queue and pops its newest job, idle workers steal the oldest jobs of the others.
+ * Threads that are not workers share one extra queue. With zero workers every job runs on the thread waiting for it.
+ */
+class CJobSystem final
+{
+public:
+	using Job = std::function<void()>;
+
+	explicit CJobSystem(const uint32_t numOfWorkers = GetDefaultNumOfWorkers());
+	~CJobSystem();
+
+	CJobSystem(const CJobSystem&) = delete;
+	CJobSystem& operator=(const CJobSystem&) = delete;
+
+	/**
+	 * /brief Queues the job on the queue of the calling thread, the counter must outlive the job.
+	 */
+	void Schedule(Job job, CJobCounter& counter);
+
+	/**
+	 * /brief Blocks until every job of the counter completed, running queued jobs meanwhile.
+	 */
+	void Wait(const CJobCounter& counter);
+
+	/**
+	 * /brief Splits [0, count) in chunks of grainSize and runs fn(begin, end) on every chunk, returns when all completed.
+	 */
+	void ParallelFor(const uint64_t count, const uint64_t grainSize, const std::function<void(uint64_t begin, uint64_t end)>& fn);
+
+	inline uint32_t GetNumOfWorkers() const { return static_cast<uint32_t>(_workers.size()); }
+
+	/**
+	 * /brief One worker per hardware thread, minus the thread that waits.
+	 */
+	static uint32_t GetDefaultNumOfWorkers();
+
+private:
+	struct DJob
+	{
+		Job Fn;
+		CJobCounter* Counter;
+	};
+
+	struct DJobQueue
+	{
+		std::mutex Mutex;
+		std::deque<DJob> Jobs;
+	};
+
+	/**
+	 * /brief Queue 0 is shared by external threads, queue i + 1 belongs to worker i.
+	 */
+	std::vector<std::unique_ptr<DJobQueue>> _queues;
+	std::vector<std::thread> _workers;
+
+	std::atomic<bool> _running{ true };
+	std::atomic<uint32_t> _numOfQueuedJobs{};
+	std::mutex _sleepMutex;
+	std::condition_variable _wakeUp;
+
+	uint32_t _getQueueIndexOfCallingThread() const;
+	bool _tryRunOne(const uint32_t queueIndex);
+	bool _tryPop(const uint32_t queueIndex, DJob& job);
+	bool _trySteal(const uint32_t thiefQueueIndex, DJob& job);
+	void _workerLoop(const uint32_t queueIndex);
+};
@@ -0,0 +1,73 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CLevelImage.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class CWorld;
+class CWorldObject;
+class CMappedFile;
+class IEntityFactory;
+
+/**
+ * /brief Baked level and prefab format, instantiated in bulk straight from a memory mapped file.
+ * The image starts with a class table, each class is referenced by name and carries the offset and size of its archetype components block.
+ * Then per class the blocks of its objects follow back to back, pre-laid-out like the class CDO lays them out after the object, and the object tags.
+ * Instantiating spawns each class with one batch allocation, runs the regular constructors then copies each block over the fresh components with one memcpy.
+ * Only archetype components are baked and they must be trivially copyable, see CWorldSnapshot. Images are native endian and tied to the class layouts of the build that baked them.
+ * Unlike a snapshot a level image holds no handles, it can be instantiated any number of times in any world.
+ */
+class CLevelImage final
+{
+public:
+	/**
+	 * /brief Replaces the content of image. Objects are grouped by class, keeping their order within the class.
+	 * Throws runtime_error if a class has an archetype component not trivially copyable or an object reset one of its archetype components.
+	 */
+	static void Bake(const IEntityFactory& entityFactory, const CWorldObject* const* const objects, const uint64_t count, std::vector<uint8_t>& image);
+
+	/**
+	 * /brief The image is validated before spawning anything, a corrupted or incompatible image throws runtime_error and spawns nothing.
+	 * If a constructor throws, the objects already spawned by this call are marked pending destroy and the exception is rethrown.
+	 * /param spawned Optional, receives the spawned objects grouped by class in the image order.
+	 */
+	static void Instantiate(CWorld& world, const uint8_t* const image, const uint64_t bytes, std::vector<CWorldObject*>* const spawned = nullptr);
+	static void Instantiate(CWorld& world, const CMappedFile& file, std::vector<CWorldObject*>* const spawned = nullptr);
+
+	static constexpr uint32_t MAGIC{ 0x564C434E }; // "NCLV"
+	static constexpr uint32_t VERSION{ 1 };
+};
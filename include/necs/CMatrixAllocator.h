@@ -35,15 +35,40 @@
 
 #pragma once
 
-#include <list>
+#include <memory>
+#include <vector>
 
 #include "IAllocator.h"
 #include "CPagedAllocator.h"
+#include "CSlabPageMap.h"
+#include "BitUtils.h"
+
+/**
+ * /brief Geometric size classes, each doubling of size is split in StepsPerDoubling classes so a block wastes less than 1 / StepsPerDoubling of its size.
+ * Sizes up to Quantum * StepsPerDoubling are Quantum multiples.
+ * e.g. the default classes are 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320...
+ */
+struct DSizeClassPolicy
+{
+	/**
+	 * /brief Power of two, the spacing of the smallest classes.
+	 */
+	uint64_t Quantum{ alignof(std::max_align_t) };
+	/**
+	 * /brief Power of two, more steps waste less memory per block but spread the objects over more columns.
+	 */
+	uint64_t StepsPerDoubling{ 4 };
+	/**
+	 * /brief Caps the class table, larger sizes get a column of their exact size.
+	 */
+	uint64_t MaxClassSize{ uint64_t(1) << 20 };
+};
 
 /**
  * /brief A matrix allocator can allocate any size object.
- * Columns are allocation size.
+ * Columns are size classes, sizes are rounded up to their class so objects of close sizes share the same slabs.
  * Rows are allocator pages.
+ * Classes are resolved arithmetically and index a flat table, finding the column of a size is O(1).
  */
 template<class PagedAllocator_T>
 class CMatrixAllocator final : public IAllocator
@@ -52,55 +77,152 @@ class CMatrixAllocator final : public IAllocator
 	static_assert(std::is_base_of<IPagedAllocator, PagedAllocator_T>::value);
 
 public:
-	explicit CMatrixAllocator(const uint64_t maxElementsPerPage) :_maxElementsPerPage(maxElementsPerPage) {
+	explicit CMatrixAllocator(const uint64_t maxElementsPerPage, const DSizeClassPolicy& sizeClassPolicy = {}) :_maxElementsPerPage(maxElementsPerPage),
+		_lgQuantum(FloorLog2(sizeClassPolicy.Quantum)), _lgSteps(FloorLog2(sizeClassPolicy.StepsPerDoubling)) {
 		assert(_maxElementsPerPage > 0);
+		assert((sizeClassPolicy.Quantum & (sizeClassPolicy.Quantum - 1)) == 0 && "Quantum must be a power of two!");
+		assert((sizeClassPolicy.StepsPerDoubling & (sizeClassPolicy.StepsPerDoubling - 1)) == 0 && "Steps per doubling must be a power of two!");
+		assert(sizeClassPolicy.MaxClassSize > 0);
+
+		_sizeClasses.resize(_sizeToClass(sizeClassPolicy.MaxClassSize) + 1);
+		_maxClassSize = _classToSize(_sizeClasses.size() - 1);
 	}
 
 	void* Allocate(const uint64_t bytes) override {
 		return _getAllocatorBySize(bytes).Allocate();
 	};
 
+	void AllocateBatch(const uint64_t bytes, const uint64_t count, void** const out) override {
+		_getAllocatorBySize(bytes).AllocateBatch(count, out);
+	};
+
+	void FreeBatch(void* const* const ptrs, const uint64_t count) override {
+		DSlabOwner owner{};
+		uintptr_t ownerPage{ UINTPTR_MAX };
+		for (uint64_t i{}; i < count; i++)
+		{
+			// Batches are mostly adjacent blocks, reuse the owner while the page doesn't change
+			const uintptr_t page{ reinterpret_cast<uintptr_t>(ptrs[i]) / CSlabPageMap::PAGE_SIZE };
+			if (page != ownerPage)
+			{
+				owner = _slabPageMap.Find(ptrs[i]);
+				ownerPage = page;
+			}
+
+			if (owner.Allocator)
+			{
+				static_cast<PagedAllocator_T*>(owner.Allocator)->FreeFromSlab(ptrs[i], owner.SlabIndex);
+			}
+		}
+	};
+
 	void Free(void* ptr) override {
-		// Brute force deallocation by searching all allocators
-		for (auto& allocator : _perSizeAllocator)
+		// The page map resolves the owning column and slab, no other allocator is touched
+		const DSlabOwner owner{ _slabPageMap.Find(ptr) };
+		if (owner.Allocator)
 		{
-			allocator.Free(ptr);
+			static_cast<PagedAllocator_T*>(owner.Allocator)->FreeFromSlab(ptr, owner.SlabIndex);
 		}
 	};
 
+	/**
+	 * /brief Appends the counters of every column created so far, by ascending block size.
+	 */
+	void GetStats(std::vector<DAllocatorStats>& out) const {
+		for (const auto& column : _sizeClasses)
+		{
+			if (column)
+				out.push_back(column->GetStats());
+		}
+		for (const auto& column : _largeSizeAllocators)
+		{
+			out.push_back(column->GetStats());
+		}
+	}
+
+	/**
+	 * /brief Block size actually handed out for bytes.
+	 */
+	uint64_t GetClassSize(const uint64_t bytes) const {
+		assert(bytes > 0);
+		return bytes > _maxClassSize ? bytes : _classToSize(_sizeToClass(bytes));
+	}
+
 private:
 	const uint64_t _maxElementsPerPage;
+	const uint64_t _lgQuantum;
+	const uint64_t _lgSteps;
+	uint64_t _maxClassSize{};
+	/**
+	 * /brief Must outlive the columns since they unregister their slabs on destruction.
+	 */
+	CSlabPageMap _slabPageMap;
 	/**
-	 * /brief Columns ordered per ascending size. TODO turn into a vector with move only if faster.
+	 * /brief Columns indexed by size class, created on first use. Columns are heap allocated so they never move once registered.
 	 */
-	std::list<PagedAllocator_T> _perSizeAllocator;
+	std::vector<std::unique_ptr<PagedAllocator_T>> _sizeClasses;
+	/**
+	 * /brief Columns of the sizes above the class table ordered per ascending size, one per exact size.
+	 */
+	std::vector<std::unique_ptr<PagedAllocator_T>> _largeSizeAllocators;
+
+	uint64_t _sizeToClass(const uint64_t bytes) const
+	{
+		const uint64_t steps{ uint64_t(1) << _lgSteps };
+		if (bytes <= steps << _lgQuantum)
+		{
+			return ((bytes + (uint64_t(1) << _lgQuantum) - 1) >> _lgQuantum) - 1;
+		}
+
+		// 2^doubling < bytes <= 2^(doubling + 1), the doubling is split in steps of 2^(doubling - lgSteps)
+		const uint64_t doubling{ FloorLog2(bytes - 1) };
+		return steps + ((doubling - _lgQuantum - _lgSteps) << _lgSteps) + ((bytes - 1 - (uint64_t(1) << doubling)) >> (doubling - _lgSteps));
+	}
+
+	uint64_t _classToSize(const uint64_t sizeClass) const
+	{
+		const uint64_t steps{ uint64_t(1) << _lgSteps };
+		if (sizeClass < steps)
+		{
+			return (sizeClass + 1) << _lgQuantum;
+		}
+
+		const uint64_t doubling{ _lgQuantum + _lgSteps + ((sizeClass - steps) >> _lgSteps) };
+		const uint64_t step{ ((sizeClass - steps) & (steps - 1)) + 1 };
+		return (uint64_t(1) << doubling) + (step << (doubling - _lgSteps));
+	}
 
 	/**
-	 * /brief Returns the corresponding paged allocator mapped to that particular size, allocates a new if doesn't exists.
-	 * /param bytes The class size = block size of the bucket.
-	 * /return The bucker reference.
+	 * /brief Returns the paged allocator of the size class of bytes, creates it on first use.
 	 */
 	PagedAllocator_T& _getAllocatorBySize(const uint64_t bytes)
 	{
 		assert(bytes > 0);
 
-		// Binary search using lower_bound with O(log N) complexity.
-		const auto it{ std::lower_bound(_perSizeAllocator.begin(), _perSizeAllocator.end(), bytes, [](const PagedAllocator_T& allocator, const uint64_t value) {return allocator.GetFixedBlockSize() < value; }) };
-		if (it != _perSizeAllocator.end() && it->GetFixedBlockSize() == bytes)
+		if (bytes <= _maxClassSize)
 		{
-			return *it;
-		}
-		else
-			if (it == _perSizeAllocator.end())
+			const uint64_t sizeClass{ _sizeToClass(bytes) };
+			auto& column{ _sizeClasses[sizeClass] };
+			if (!column)
 			{
-				// Allocate bigger size pageAllocator
-				PagedAllocator_T newAllocator(_maxElementsPerPage, bytes);
-				return _perSizeAllocator.emplace_back(std::move(newAllocator));
+				column = _newColumn(_classToSize(sizeClass));
 			}
+			return *column;
+		}
+
+		const auto it{ std::lower_bound(_largeSizeAllocators.begin(), _largeSizeAllocators.end(), bytes, [](const std::unique_ptr<PagedAllocator_T>& allocator, const uint64_t value) {return allocator->GetFixedBlockSize() < value; }) };
+		if (it != _largeSizeAllocators.end() && (*it)->GetFixedBlockSize() == bytes)
+		{
+			return **it;
+		}
 
-		// If above has failed it means that an allocator in missing in between already existing allocator so insert it gently.
-		// Adding elements should be ordered with O(M � N) complexity. Avoid sorting the whole vector because it's O(M � N log N) complexity.
-		PagedAllocator_T newAllocator(_maxElementsPerPage, bytes);
-		return *_perSizeAllocator.emplace(it, std::move(newAllocator));
+		return **_largeSizeAllocators.insert(it, _newColumn(bytes));
+	}
+
+	std::unique_ptr<PagedAllocator_T> _newColumn(const uint64_t blockSize)
+	{
+		auto column{ std::make_unique<PagedAllocator_T>(_maxElementsPerPage, blockSize) };
+		column->SetSlabListener(&_slabPageMap);
+		return column;
 	}
 };
@@ -37,121 +37,577 @@
 
 #include <vector>
 #include <cassert>
+#include <cstddef>
 #include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <functional>
+#include <type_traits>
 
 #include "IAlignedAllocator.h"
-
-#include "clow/freelist.h"
-
 #include "IPagedAllocator.h"
+#include "BitUtils.h"
+#include "CStats.h"
+#include "CTrace.h"
+
+/**
+ * /brief Default validation policy of the paged allocators, follows the debug configuration unless the build sets it.
+ */
+#ifndef NECS_CHECKED_ALLOCATORS
+#if _DEBUG
+#define NECS_CHECKED_ALLOCATORS 1
+#else
+#define NECS_CHECKED_ALLOCATORS 0
+#endif
+#endif
 
 /**
  * /brief Each allocation is max_align_t aligned.
+ * Slabs are fixed size block pools, a block is either carved from the untouched tail of the slab or popped from the slab's intrusive free list.
+ * Non full slabs are tracked in a word packed bitmap, finding a slab and detecting a full slab are O(1) on the hot path.
+ * When Checked every free is validated against a per slab allocation bitmap, freed blocks are poisoned and the poison and the free list links are verified
+ * when the block is handed out again, violations throw. Unchecked is a lean fixed size pool without any validation.
  */
-template<class IAlignedAllocator_T>
+template<class IAlignedAllocator_T, bool Checked = NECS_CHECKED_ALLOCATORS>
 class CPagedAllocator final : public IPagedAllocator
 {
 	static_assert(std::is_base_of<IAlignedAllocator, IAlignedAllocator_T>::value);
 public:
-	CPagedAllocator(const uint64_t maxNumOfElementsPerSlab, const uint64_t elementSize) : IPagedAllocator(maxNumOfElementsPerSlab, elementSize), _maxNumElementsPerSlab(maxNumOfElementsPerSlab), _slabBytes(maxNumOfElementsPerSlab* (_elementSize + freelist_alloc_overhead())), _elementSize(elementSize) { assert(_slabBytes > 0); }
-	CPagedAllocator(CPagedAllocator&& other) noexcept : IPagedAllocator(0,0), _maxNumElementsPerSlab(other._maxNumElementsPerSlab), _slabBytes(other._slabBytes), _elementSize(other._elementSize), _slabs(std::move(other._slabs)), _fullBuckets(std::move(other._fullBuckets)) {
+	CPagedAllocator(const uint64_t maxNumOfElementsPerSlab, const uint64_t elementSize) : IPagedAllocator(maxNumOfElementsPerSlab, elementSize), _maxNumElementsPerSlab(maxNumOfElementsPerSlab), _elementSize(elementSize), _blockStride(_computeBlockStride(elementSize)), _slabBytes(maxNumOfElementsPerSlab* _blockStride) { assert(_slabBytes > 0); }
+	CPagedAllocator(CPagedAllocator&& other) noexcept : IPagedAllocator(0,0), _maxNumElementsPerSlab(other._maxNumElementsPerSlab), _elementSize(other._elementSize), _blockStride(other._blockStride), _slabBytes(other._slabBytes), _slabs(std::move(other._slabs)), _slabsByAddress(std::move(other._slabsByAddress)), _nonFullSlabs(std::move(other._nonFullSlabs)), _currentSlab(other._currentSlab), _slabListener(other._slabListener), _slabGranularity(other._slabGranularity), _releasedSlabs(std::move(other._releasedSlabs)), _numOfEmptySlabs(other._numOfEmptySlabs), _emptySlabRetention(other._emptySlabRetention), _counters(other._counters), _alignedAllocator(std::move(other._alignedAllocator)) {
+		static_assert(std::is_move_constructible_v<IAlignedAllocator_T>, "The backing must be movable, the moved slabs are freed through it");
 		assert(_slabBytes > 0);
+		// Slabs are registered to the listener with the owner address, moving would leave them dangling
+		assert((!_slabListener || _slabs.empty()) && "Can't move an allocator with slabs registered to a listener!");
 	}
 	CPagedAllocator(const CPagedAllocator&) = delete;
 	CPagedAllocator& operator=(const CPagedAllocator& other) = delete;
 
 	virtual ~CPagedAllocator()
 	{
-		for (auto& slab : _slabs)
+		for (uint64_t i{}; i < _slabs.size(); i++)
 		{
-			_alignedAllocator.Free(freelist_get_buffer(&slab));
-			freelist_reset(&slab);
+			auto& slab{ _slabs[i] };
+			if (!slab.Buffer)
+				continue;
+
+			if (_slabListener)
+				_slabListener->OnSlabReleased(this, i, slab.Buffer, slab.Bytes);
+
+			_alignedAllocator.Free(slab.Buffer);
+			slab = {};
 		}
 	}
 
 	void* Allocate() override
 	{
-		const auto allocatorIndex{ _getFreeAllocatorIndex() };
-		auto& allocator{ _slabs[allocatorIndex] };
+		if (_currentSlab == INVALID_SLAB || _slabs[_currentSlab].NumLive == _slabs[_currentSlab].Capacity)
+		{
+			_currentSlab = _getFreeAllocatorIndex();
+		}
 
-		freelist_verify_corruption(&allocator);
-		void* allocation{ freelist_malloc(&allocator, _elementSize) };
-		assert(freelist_get_allocation_size(&allocator, allocation) == _elementSize);
+		return _allocateFromSlab(_currentSlab);
+	}
 
-		// If full mark as full in the bitset
-		void* nextAlloc{ freelist_malloc(&allocator, _elementSize) };
-		if (nextAlloc == nullptr)
+	void AllocateBatch(const uint64_t count, void** const out) override
+	{
+		uint64_t allocated{};
+		while (allocated < count)
 		{
-			_fullBuckets[allocatorIndex] = true;
-		}
-		else
-			freelist_free(&allocator, nextAlloc);
+			if (_currentSlab == INVALID_SLAB || _slabs[_currentSlab].NumLive == _slabs[_currentSlab].Capacity)
+			{
+				_currentSlab = _getFreeAllocatorIndex();
+			}
 
-		freelist_verify_corruption(&allocator);
+			auto& slab{ _slabs[_currentSlab] };
+			if (slab.NumLive == 0)
+				_numOfEmptySlabs--;
 
+			// Carve a contiguous run from the untouched tail first
+			const uint64_t run{ std::min(count - allocated, std::min(slab.Capacity - slab.NumCarved, slab.Capacity - slab.NumLive)) };
+			std::uintptr_t block{ reinterpret_cast<std::uintptr_t>(slab.Buffer) + slab.NumCarved * _blockStride };
+			for (uint64_t i{}; i < run; i++, block += _blockStride)
+			{
+				out[allocated] = reinterpret_cast<void*>(block);
+				if constexpr (Checked)
+					_markAllocated(slab, out[allocated], true);
+				allocated++;
+			}
+			slab.NumCarved += run;
+			slab.NumLive += run;
+			_counters.Allocations.Add(run);
+			_counters.LiveBlocks.Add(run);
 
-		return allocation;
+			// Then the free list
+			while (allocated < count && slab.FreeList)
+			{
+				out[allocated++] = _popFreeList(slab);
+				slab.NumLive++;
+				_counters.Allocations.Add();
+				_counters.LiveBlocks.Add();
+			}
+
+			if (slab.NumLive == slab.Capacity)
+			{
+				_setNonFull(_currentSlab, false);
+			}
+		}
 	}
 
 	void Free(void* ptr) override {
-		if (!_slabs.size())
-			return;
-
-		auto comp = [](freelist& allocator, void* ptr) {
-			return reinterpret_cast<std::uintptr_t>(freelist_get_buffer(&allocator)) + allocator.buffer_size < reinterpret_cast<std::uintptr_t>(ptr);
-			};
+		const uint64_t slabIndex{ _findSlabIndex(ptr) };
+		// Do nothing if ptr is not contained
+		if (slabIndex != INVALID_SLAB)
+		{
+			FreeFromSlab(ptr, slabIndex);
+		}
+	}
 
-		// Use std::lower_bound with a custom comparator
-		if (_slabs.size() > 1)
+	void FreeBatch(void* const* const ptrs, const uint64_t count) override {
+		uint64_t slabIndex{ INVALID_SLAB };
+		for (uint64_t i{}; i < count; i++)
 		{
-			const std::vector<freelist>::iterator it{ std::lower_bound(_slabs.begin(), _slabs.end(), (void*)ptr, comp) };
-			// Do nothing if ptr is not contained
-			if (it != _slabs.end())
+			// Consecutive blocks usually belong to the same slab, skip the search
+			if (slabIndex == INVALID_SLAB || !_slabContains(_slabs[slabIndex], ptrs[i]))
 			{
-				freelist_free(&(*it), (void*)ptr);
-				// Deleting an element makes the allocator non full, so mark as non full
-				const auto allocatorIndex{ std::distance(_slabs.begin(), it) };
-				_fullBuckets[allocatorIndex] = false;
+				slabIndex = _findSlabIndex(ptrs[i]);
+				if (slabIndex == INVALID_SLAB)
+					continue;
 			}
+
+			FreeFromSlab(ptrs[i], slabIndex);
 		}
-		else
+	}
+
+	void FreeFromSlab(void* ptr, const uint64_t slabIndex) override {
+		assert(slabIndex < _slabs.size());
+		auto& slab{ _slabs[slabIndex] };
+
+		if constexpr (Checked)
+		{
+			_verify(_slabContains(slab, ptr) && _isBlockBoundary(slab, ptr), "CPagedAllocator freeing a pointer that is not a block of the slab!");
+			_verify(_isAllocated(slab, ptr), "CPagedAllocator double free detected!");
+			_markAllocated(slab, ptr, false);
+			// Poison everything but the free list link
+			std::memset(reinterpret_cast<uint8_t*>(ptr) + sizeof(void*), POISON, _blockStride - sizeof(void*));
+		}
+
+		assert(reinterpret_cast<std::uintptr_t>(ptr) >= reinterpret_cast<std::uintptr_t>(slab.Buffer));
+		assert((reinterpret_cast<std::uintptr_t>(ptr) - reinterpret_cast<std::uintptr_t>(slab.Buffer)) % _blockStride == 0 && "Pointer is not a block of this slab!");
+		assert(slab.NumLive > 0);
+
+		*reinterpret_cast<void**>(ptr) = slab.FreeList;
+		slab.FreeList = ptr;
+		_counters.Frees.Add();
+		_counters.LiveBlocks.Sub();
+
+		// Deleting an element makes the slab non full, so mark as non full
+		if (slab.NumLive-- == slab.Capacity)
 		{
-			freelist_free(&(*_slabs.begin()), (void*)ptr);
-			_fullBuckets[0] = false;
+			_setNonFull(slabIndex, true);
+		}
+
+		if (slab.NumLive == 0 && ++_numOfEmptySlabs > _emptySlabRetention)
+		{
+			_releaseSlab(slabIndex);
 		}
 	}
 
 	uint64_t GetFixedBlockSize()const override { return _elementSize; };
 
+	void SetSlabListener(IPagedAllocatorSlabListener* const listener) override {
+		assert(_slabs.empty() && "Listener must be set before the first allocation!");
+		_slabListener = listener;
+	}
+
+	/**
+	 * /brief Slab size policy, slabs are rounded up to a multiple of bytes, a power of two, and the rounding holds extra blocks.
+	 * Slabs always follow the granularity of the backing allocator, so page backed slabs fill whole pages. Must be set before the first allocation.
+	 */
+	void SetSlabGranularity(const uint64_t bytes) {
+		assert(_slabs.empty() && "Slab granularity must be set before the first allocation!");
+		assert(bytes > 0 && (bytes & (bytes - 1)) == 0 && "Slab granularity must be a power of two!");
+		_slabGranularity = bytes;
+	}
+
+	/**
+	 * /brief Retention watermark, a free emptying a slab beyond numOfSlabs empty slabs gives it back to the aligned allocator.
+	 * Unbounded by default, keeping a few empty slabs avoids releasing and reallocating a slab when the load oscillates.
+	 */
+	void SetEmptySlabRetention(const uint64_t numOfSlabs) {
+		_emptySlabRetention = numOfSlabs;
+		ReleaseEmptySlabs(numOfSlabs);
+	}
+
+	/**
+	 * /brief Gives the empty slabs beyond numOfSlabsToKeep back to the aligned allocator.
+	 * /return The number of bytes released.
+	 */
+	uint64_t ReleaseEmptySlabs(const uint64_t numOfSlabsToKeep = 0) {
+		uint64_t releasedBytes{};
+		// Highest indices first, the allocation scan prefers the lowest ones
+		for (uint64_t i{ _slabs.size() }; i > 0 && _numOfEmptySlabs > numOfSlabsToKeep; i--)
+		{
+			if (_slabs[i - 1].Buffer && _slabs[i - 1].NumLive == 0)
+			{
+				releasedBytes += _slabs[i - 1].Bytes;
+				_releaseSlab(i - 1);
+			}
+		}
+		return releasedBytes;
+	}
+
+	/**
+	 * /brief Moves the live blocks out of the slabs at most maxOccupancy full into the fuller slabs, so the sparse slabs empty out and can be released.
+	 * relocate must move the object at from into the uninitialized block to, fix every reference to it and return true,
+	 * or return false leaving from untouched when the object can't move. No slab is allocated, the pass stops when the fuller slabs are full.
+	 * Emptied slabs follow the retention watermark.
+	 * /return The number of relocated blocks.
+	 */
+	uint64_t Defragment(const std::function<bool(void* from, void* to)>& relocate, const double maxOccupancy = 0.25) {
+		assert(relocate);
+
+		std::vector<uint64_t> sources;
+		std::vector<uint64_t> destinations;
+		for (uint64_t i{}; i < _slabs.size(); i++)
+		{
+			const auto& slab{ _slabs[i] };
+			if (!slab.Buffer || slab.NumLive == 0)
+				continue;
+
+			if (static_cast<double>(slab.NumLive) <= maxOccupancy * static_cast<double>(slab.Capacity))
+				sources.push_back(i);
+			else if (slab.NumLive < slab.Capacity)
+				destinations.push_back(i);
+		}
+
+		// Empty the sparsest slabs first and top up the fullest ones, a popped destination is full
+		std::sort(sources.begin(), sources.end(), [this](const uint64_t a, const uint64_t b) { return _slabs[a].NumLive < _slabs[b].NumLive; });
+		std::sort(destinations.begin(), destinations.end(), [this](const uint64_t a, const uint64_t b) { return _slabs[a].NumLive < _slabs[b].NumLive; });
+
+		uint64_t relocated{};
+		std::vector<void*> liveBlocks;
+		for (const uint64_t source : sources)
+		{
+			_collectLiveBlocks(source, liveBlocks);
+			for (void* const from : liveBlocks)
+			{
+				while (!destinations.empty() && _slabs[destinations.back()].NumLive == _slabs[destinations.back()].Capacity)
+					destinations.pop_back();
+				if (destinations.empty())
+					return relocated;
+
+				const uint64_t destination{ destinations.back() };
+				void* const to{ _allocateFromSlab(destination) };
+				if (relocate(from, to))
+				{
+					FreeFromSlab(from, source);
+					relocated++;
+				}
+				else
+				{
+					FreeFromSlab(to, destination);
+				}
+			}
+
+			// The partially emptied slab takes the remaining blocks of the sparser ones
+			if (_slabs[source].Buffer && _slabs[source].NumLive > 0)
+				destinations.insert(destinations.begin(), source);
+		}
+
+		return relocated;
+	}
+
+	/**
+	 * /brief Slabs currently held from the aligned allocator.
+	 */
+	inline uint64_t GetNumOfSlabs()const { return _slabs.size() - _releasedSlabs.size(); }
+	inline uint64_t GetNumOfEmptySlabs()const { return _numOfEmptySlabs; }
+
+	/**
+	 * /brief Counters snapshot, may be taken from any thread while the allocator is in use. Zeros but the block sizes unless NECS_STATS is 1.
+	 */
+	inline DAllocatorStats GetStats()const { return DAllocatorStats::FromCounters(_counters, _elementSize, _blockStride); }
+
 private:
+	inline static constexpr uint64_t INVALID_SLAB{ std::numeric_limits<uint64_t>::max() };
+	inline static constexpr uint8_t POISON{ 0xDD };
+
+	struct DSlab
+	{
+		void* Buffer{};
+		uint64_t Bytes{};
+		uint64_t Capacity{};
+		/**
+		 * /brief Intrusive list of freed blocks, the next pointer is stored in the block itself.
+		 */
+		void* FreeList{};
+		/**
+		 * /brief Number of blocks handed out at least once, the remaining blocks are carved from the slab tail.
+		 */
+		uint64_t NumCarved{};
+		uint64_t NumLive{};
+		/**
+		 * /brief One bit per block set while the block is handed out, only maintained when Checked.
+		 */
+		std::vector<uint64_t> Allocated;
+	};
+
 	const uint64_t _maxNumElementsPerSlab;
 	const uint64_t _elementSize;
+	const uint64_t _blockStride;
 	const uint64_t _slabBytes;
-	std::vector<freelist> _slabs;
-	std::vector<bool> _fullBuckets;
+	std::vector<DSlab> _slabs;
+	/**
+	 * /brief Slab indices ordered by ascending slab address.
+	 */
+	std::vector<uint64_t> _slabsByAddress;
+	/**
+	 * /brief One bit per slab, set when the slab has at least one free block.
+	 */
+	std::vector<uint64_t> _nonFullSlabs;
+	/**
+	 * /brief Slab served by the last allocation, it's tried first.
+	 */
+	uint64_t _currentSlab{ INVALID_SLAB };
+	IPagedAllocatorSlabListener* _slabListener{};
+	uint64_t _slabGranularity{ 1 };
+	/**
+	 * /brief Indices of the released slabs, reused by the next slabs so the indices known to the listener stay stable.
+	 */
+	std::vector<uint64_t> _releasedSlabs;
+	uint64_t _numOfEmptySlabs{};
+	uint64_t _emptySlabRetention{ std::numeric_limits<uint64_t>::max() };
+	DAllocatorCounters _counters;
 	IAlignedAllocator_T _alignedAllocator;
 
 	friend class CPagedAllocatorFixture;
 
+	inline static bool _slabContains(const DSlab& slab, const void* const ptr)
+	{
+		return reinterpret_cast<std::uintptr_t>(ptr) >= reinterpret_cast<std::uintptr_t>(slab.Buffer) && reinterpret_cast<std::uintptr_t>(ptr) < reinterpret_cast<std::uintptr_t>(slab.Buffer) + slab.Bytes;
+	}
+
+	uint64_t _findSlabIndex(const void* const ptr)const
+	{
+		auto comp = [this](const uint64_t slabIndex, const void* const ptr) {
+			return reinterpret_cast<std::uintptr_t>(_slabs[slabIndex].Buffer) + _slabs[slabIndex].Bytes <= reinterpret_cast<std::uintptr_t>(ptr);
+			};
+
+		// Binary search the slab ordered by address, slabs are not allocated in address order
+		const auto it{ std::lower_bound(_slabsByAddress.begin(), _slabsByAddress.end(), ptr, comp) };
+		if (it != _slabsByAddress.end() && _slabContains(_slabs[*it], ptr))
+			return *it;
+
+		return INVALID_SLAB;
+	}
+
+	inline static uint64_t _computeBlockStride(const uint64_t elementSize)
+	{
+		// A free block must be able to hold the free list pointer
+		return AlignUp(std::max<uint64_t>(elementSize, sizeof(void*)), alignof(std::max_align_t));
+	}
+
+	void* _allocateFromSlab(const uint64_t slabIndex)
+	{
+		auto& slab{ _slabs[slabIndex] };
+		assert(slab.NumLive < slab.Capacity);
+		if (slab.NumLive == 0)
+			_numOfEmptySlabs--;
+
+		void* allocation{};
+		if (slab.FreeList)
+		{
+			allocation = _popFreeList(slab);
+		}
+		else
+		{
+			assert(slab.NumCarved < slab.Capacity);
+			allocation = reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(slab.Buffer) + slab.NumCarved * _blockStride);
+			slab.NumCarved++;
+			if constexpr (Checked)
+				_markAllocated(slab, allocation, true);
+		}
+
+		_counters.Allocations.Add();
+		_counters.LiveBlocks.Add();
+
+		// If full mark as full in the bitset
+		if (++slab.NumLive == slab.Capacity)
+		{
+			_setNonFull(slabIndex, false);
+		}
+
+		return allocation;
+	}
+
+	void* _popFreeList(DSlab& slab)
+	{
+		void* const block{ slab.FreeList };
+		slab.FreeList = *reinterpret_cast<void**>(block);
+
+		if constexpr (Checked)
+		{
+			_verify(!slab.FreeList || (_slabContains(slab, slab.FreeList) && _isBlockBoundary(slab, slab.FreeList)), "CPagedAllocator free list corrupted!");
+			const uint8_t* const bytes{ reinterpret_cast<const uint8_t*>(block) };
+			for (uint64_t i{ sizeof(void*) }; i < _blockStride; i++)
+			{
+				_verify(bytes[i] == POISON, "CPagedAllocator block written after free!");
+			}
+			_markAllocated(slab, block, true);
+		}
+
+		return block;
+	}
+
+	inline bool _isBlockBoundary(const DSlab& slab, const void* const ptr)const
+	{
+		return (reinterpret_cast<std::uintptr_t>(ptr) - reinterpret_cast<std::uintptr_t>(slab.Buffer)) % _blockStride == 0;
+	}
+
+	inline uint64_t _blockIndex(const DSlab& slab, const void* const ptr)const
+	{
+		return (reinterpret_cast<std::uintptr_t>(ptr) - reinterpret_cast<std::uintptr_t>(slab.Buffer)) / _blockStride;
+	}
+
+	inline bool _isAllocated(const DSlab& slab, const void* const ptr)const
+	{
+		const uint64_t block{ _blockIndex(slab, ptr) };
+		return (slab.Allocated[block / 64] >> (block % 64)) & 1;
+	}
+
+	inline void _markAllocated(DSlab& slab, const void* const ptr, const bool allocated)
+	{
+		const uint64_t block{ _blockIndex(slab, ptr) };
+		const uint64_t bit{ uint64_t(1) << (block % 64) };
+		if (allocated)
+			slab.Allocated[block / 64] |= bit;
+		else
+			slab.Allocated[block / 64] &= ~bit;
+	}
+
+	inline static void _verify(const bool condition, const char* const message)
+	{
+		if (!condition)
+			throw std::runtime_error(message);
+	}
+
+	inline void _setNonFull(const uint64_t slabIndex, const bool nonFull)
+	{
+		const uint64_t bit{ uint64_t(1) << (slabIndex % 64) };
+		if (nonFull)
+			_nonFullSlabs[slabIndex / 64] |= bit;
+		else
+			_nonFullSlabs[slabIndex / 64] &= ~bit;
+	}
+
 	uint64_t _getFreeAllocatorIndex()
 	{
 		// Find the first non full bucket
-		for (uint64_t i{}; i < _fullBuckets.size(); i++)
+		for (uint64_t word{}; word < _nonFullSlabs.size(); word++)
 		{
-			if (_fullBuckets[i] == false)
+			if (_nonFullSlabs[word] != 0)
 			{
-				return i;
+				return word * 64 + CountTrailingZeros(_nonFullSlabs[word]);
 			}
 		}
+
+		NECS_TRACE_ZONE("necs::SlabGrowth");
+		uint64_t granularity{ std::max(_slabGranularity, _alignedAllocator.GetAllocationGranularity()) };
+		uint64_t slabAlignment{ alignof(std::max_align_t) };
+		// Slabs must not share granules with other slabs when indexed by a listener
+		if (_slabListener)
+		{
+			granularity = std::max(granularity, _slabListener->GetSlabGranularity());
+			slabAlignment = std::max<uint64_t>(slabAlignment, _slabListener->GetSlabGranularity());
+		}
+		const uint64_t slabBytes{ AlignUp(_slabBytes, granularity) };
+
 		// If all buckets are full allocate a new bucket
-		_fullBuckets.push_back(false);
-		void* buffer{ _alignedAllocator.Allocate(_slabBytes, alignof(std::max_align_t)) };
+		void* buffer{ _alignedAllocator.Allocate(slabBytes, slabAlignment) };
 		if (!buffer)
 			throw std::bad_alloc{};
 
-		freelist slab{};
-		freelist_initialize(&slab, buffer, _slabBytes);
-		_slabs.emplace_back(std::move(slab));
-		return _slabs.size() - 1;
+		DSlab slab{};
+		slab.Buffer = buffer;
+		slab.Bytes = slabBytes;
+		slab.Capacity = slabBytes / _blockStride;
+		if constexpr (Checked)
+			slab.Allocated.resize((slab.Capacity + 63) / 64);
+
+		uint64_t slabIndex{ _slabs.size() };
+		if (!_releasedSlabs.empty())
+		{
+			slabIndex = _releasedSlabs.back();
+			_releasedSlabs.pop_back();
+			_slabs[slabIndex] = std::move(slab);
+		}
+		else
+		{
+			_slabs.emplace_back(std::move(slab));
+		}
+
+		if (_nonFullSlabs.size() * 64 < _slabs.size())
+			_nonFullSlabs.push_back(0);
+		_setNonFull(slabIndex, true);
+		_numOfEmptySlabs++;
+		_counters.Slabs.Add();
+		_counters.SlabsAllocated.Add();
+		_counters.ReservedBytes.Add(slabBytes);
+
+		const auto position{ std::upper_bound(_slabsByAddress.begin(), _slabsByAddress.end(), buffer, [this](void* buffer, const uint64_t index) {
+			return reinterpret_cast<std::uintptr_t>(buffer) < reinterpret_cast<std::uintptr_t>(_slabs[index].Buffer);
+			}) };
+		_slabsByAddress.insert(position, slabIndex);
+
+		if (_slabListener)
+			_slabListener->OnSlabAllocated(this, slabIndex, buffer, slabBytes);
+
+		return slabIndex;
+	}
+
+	void _releaseSlab(const uint64_t slabIndex)
+	{
+		auto& slab{ _slabs[slabIndex] };
+		assert(slab.Buffer && slab.NumLive == 0);
+
+		if (_slabListener)
+			_slabListener->OnSlabReleased(this, slabIndex, slab.Buffer, slab.Bytes);
+
+		const auto position{ std::find(_slabsByAddress.begin(), _slabsByAddress.end(), slabIndex) };
+		assert(position != _slabsByAddress.end());
+		_slabsByAddress.erase(position);
+
+		_counters.Slabs.Sub();
+		_counters.SlabsReleased.Add();
+		_counters.ReservedBytes.Sub(slab.Bytes);
+
+		_alignedAllocator.Free(slab.Buffer);
+		slab = {};
+		_setNonFull(slabIndex, false);
+		_releasedSlabs.push_back(slabIndex);
+		_numOfEmptySlabs--;
+
+		if (_currentSlab == slabIndex)
+			_currentSlab = INVALID_SLAB;
+	}
+
+	/**
+	 * /brief Live blocks of the slab in address order, everything carved minus the free list.
+	 */
+	void _collectLiveBlocks(const uint64_t slabIndex, std::vector<void*>& out)const
+	{
+		const auto& slab{ _slabs[slabIndex] };
+		std::vector<bool> freed(slab.NumCarved);
+		for (void* block{ slab.FreeList }; block; block = *reinterpret_cast<void**>(block))
+			freed[_blockIndex(slab, block)] = true;
+
+		out.clear();
+		for (uint64_t i{}; i < slab.NumCarved; i++)
+		{
+			if (!freed[i])
+				out.push_back(reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(slab.Buffer) + i * _blockStride));
+		}
 	}
 };
@@ -0,0 +1,104 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CSlabPageMap.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cassert>
+#include <unordered_map>
+
+#include "IPagedAllocator.h"
+
+/**
+ * /brief The paged allocator and the slab index that own an address.
+ */
+struct DSlabOwner
+{
+	IPagedAllocator* Allocator{};
+	uint64_t SlabIndex{};
+};
+
+/**
+ * /brief Address to owner index, maps each page of a registered slab to the slab owner.
+ * Slabs are page aligned and page sized so a page never belongs to more than one slab, resolving an address costs a single lookup.
+ */
+class CSlabPageMap final : public IPagedAllocatorSlabListener
+{
+	friend class CSlabPageMapTest;
+public:
+	inline static constexpr uint64_t PAGE_SIZE{ 4096 };
+
+	uint64_t GetSlabGranularity()const override { return PAGE_SIZE; }
+
+	void OnSlabAllocated(IPagedAllocator* const owner, const uint64_t slabIndex, void* const slab, const uint64_t bytes) override
+	{
+		assert(owner);
+		assert(bytes > 0 && bytes % PAGE_SIZE == 0);
+		assert(_toPage(slab) * PAGE_SIZE == reinterpret_cast<uintptr_t>(slab) && "Slab must be page aligned!");
+
+		const uintptr_t firstPage{ _toPage(slab) };
+		for (uintptr_t page{ firstPage }; page < firstPage + bytes / PAGE_SIZE; page++)
+		{
+			assert(_pageToOwner.find(page) == _pageToOwner.end() && "Page already owned by another slab!");
+			_pageToOwner[page] = DSlabOwner{ owner, slabIndex };
+		}
+	}
+
+	void OnSlabReleased(IPagedAllocator* const owner, const uint64_t slabIndex, void* const slab, const uint64_t bytes) override
+	{
+		const uintptr_t firstPage{ _toPage(slab) };
+		for (uintptr_t page{ firstPage }; page < firstPage + bytes / PAGE_SIZE; page++)
+		{
+			_pageToOwner.erase(page);
+		}
+	}
+
+	/**
+	 * /brief Returns the owner of the address or an empty owner if the address doesn't belong to any registered slab.
+	 */
+	DSlabOwner Find(const void* const ptr)const
+	{
+		const auto it{ _pageToOwner.find(_toPage(ptr)) };
+		if (it == _pageToOwner.end())
+			return {};
+
+		return it->second;
+	}
+
+private:
+	std::unordered_map<uintptr_t, DSlabOwner> _pageToOwner;
+
+	inline static uintptr_t _toPage(const void* const ptr) { return reinterpret_cast<uintptr_t>(ptr) / PAGE_SIZE; }
+};
@@ -0,0 +1,211 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CStats.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * /brief Statistics counters of the allocators and the worlds, compiled out unless the build sets NECS_STATS to 1.
+ */
+#ifndef NECS_STATS
+#define NECS_STATS 0
+#endif
+
+/**
+ * /brief Monotonic counter with a single writer at a time, updated with relaxed loads and stores so the owner pays no locked instruction.
+ * Readable from any thread while written. Does nothing and reads 0 when NECS_STATS is 0.
+ */
+class CStatCounter final
+{
+public:
+	CStatCounter() = default;
+	CStatCounter(const CStatCounter& other) { _set(other.Get()); }
+	CStatCounter& operator=(const CStatCounter& other) { _set(other.Get()); return *this; }
+
+#if NECS_STATS
+	inline void Add(const uint64_t value = 1) { _value.store(_value.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+	inline uint64_t Get() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64_t> _value{};
+
+	inline void _set(const uint64_t value) { _value.store(value, std::memory_order_relaxed); }
+#else
+	inline void Add(const uint64_t value = 1) {}
+	inline uint64_t Get() const { return 0; }
+
+private:
+	inline void _set(const uint64_t value) {}
+#endif
+};
+
+/**
+ * /brief Current value and its high water mark, same threading rules as CStatCounter.
+ */
+class CStatGauge final
+{
+public:
+	inline void Add(const uint64_t value = 1) {
+		_value.Add(value);
+#if NECS_STATS
+		const uint64_t current{ Get() };
+		if (current > _highWater.Get())
+			_highWater.Add(current - _highWater.Get());
+#endif
+	}
+	inline void Sub(const uint64_t value = 1) { _removed.Add(value); }
+
+	inline uint64_t Get() const { return _value.Get() - _removed.Get(); }
+	inline uint64_t GetHighWater() const { return _highWater.Get(); }
+
+private:
+	// Monotonic halves, a reader never sees the value wrap below zero mid update
+	CStatCounter _value;
+	CStatCounter _removed;
+	CStatCounter _highWater;
+};
+
+/**
+ * /brief Counters of a paged allocator, see DAllocatorStats.
+ */
+struct DAllocatorCounters
+{
+	CStatCounter Allocations;
+	CStatCounter Frees;
+	CStatGauge LiveBlocks;
+	CStatGauge Slabs;
+	CStatCounter SlabsAllocated;
+	CStatCounter SlabsReleased;
+	CStatGauge ReservedBytes;
+};
+
+/**
+ * /brief Snapshot of the counters of a paged allocator. Only the block sizes are filled when NECS_STATS is 0.
+ */
+struct DAllocatorStats
+{
+	uint64_t BlockSize{};
+	/**
+	 * /brief Bytes a block occupies in its slab.
+	 */
+	uint64_t BlockStride{};
+	uint64_t Allocations{};
+	uint64_t Frees{};
+	uint64_t LiveBlocks{};
+	uint64_t HighWaterLiveBlocks{};
+	uint64_t Slabs{};
+	uint64_t HighWaterSlabs{};
+	uint64_t SlabsAllocated{};
+	uint64_t SlabsReleased{};
+	/**
+	 * /brief Bytes of the slabs currently held from the backing allocator.
+	 */
+	uint64_t ReservedBytes{};
+
+	/**
+	 * /brief Share of the reserved bytes not holding a live block, empty slabs and holes between live blocks.
+	 */
+	inline double GetFragmentation() const { return ReservedBytes ? 1.0 - static_cast<double>(LiveBlocks * BlockStride) / static_cast<double>(ReservedBytes) : 0.0; }
+
+	static DAllocatorStats FromCounters(const DAllocatorCounters& counters, const uint64_t blockSize, const uint64_t blockStride)
+	{
+		DAllocatorStats stats{};
+		stats.BlockSize = blockSize;
+		stats.BlockStride = blockStride;
+		stats.Allocations = counters.Allocations.Get();
+		stats.Frees = counters.Frees.Get();
+		stats.LiveBlocks = counters.LiveBlocks.Get();
+		stats.HighWaterLiveBlocks = counters.LiveBlocks.GetHighWater();
+		stats.Slabs = counters.Slabs.Get();
+		stats.HighWaterSlabs = counters.Slabs.GetHighWater();
+		stats.SlabsAllocated = counters.SlabsAllocated.Get();
+		stats.SlabsReleased = counters.SlabsReleased.Get();
+		stats.ReservedBytes = counters.ReservedBytes.Get();
+		return stats;
+	}
+};
+
+/**
+ * /brief Counters of the objects of one entity class in a world.
+ */
+struct DEntityClassCounters
+{
+	CStatGauge Objects;
+	CStatCounter Spawned;
+	CStatCounter Destroyed;
+	/**
+	 * /brief Components of destroyed objects that didn't fit the archetype slack.
+	 */
+	CStatCounter DestroyedRuntimeComponents;
+};
+
+struct DEntityClassStats
+{
+	uint32_t ClassId{};
+	std::string Name;
+	uint64_t Objects{};
+	uint64_t HighWaterObjects{};
+	uint64_t Spawned{};
+	uint64_t Destroyed{};
+	/**
+	 * /brief Components constructed in the runtime components allocator because they didn't fit the archetype slack, by every object spawned so far.
+	 */
+	uint64_t RuntimeComponents{};
+};
+
+/**
+ * /brief Snapshot of the statistics of a world, taken by CWorld::GetStats.
+ */
+struct DWorldStats
+{
+	uint64_t NumOfObjects{};
+	uint64_t NumOfPendingDestroy{};
+	/**
+	 * /brief Columns of the objects allocator that allocated at least once.
+	 */
+	std::vector<DAllocatorStats> SizeClasses;
+	std::vector<DEntityClassStats> Classes;
+	uint64_t FrameComponentsReservedBytes{};
+
+	/**
+	 * /brief Human readable table, one line per size class and per entity class.
+	 */
+	void Dump(std::ostream& out) const;
+};
@@ -0,0 +1,75 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTagRegistry.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * /brief Process wide tag interning, each distinct tag name maps to a dense id stable for the lifetime of the process.
+ * Intern once and keep the id, tag sets and queries only deal with ids.
+ */
+class CTagRegistry final
+{
+public:
+	/**
+	 * /brief Returns the id of the name, assigning the next id on first use. Thread safe.
+	 */
+	static uint32_t Intern(const std::string& name);
+
+	/**
+	 * /brief Returns the name of an interned id.
+	 */
+	static const std::string& GetName(const uint32_t tagId);
+
+	/**
+	 * /brief Number of interned tags, ids are in [0, Count).
+	 */
+	static uint32_t Count();
+
+private:
+	static CTagRegistry& _get();
+
+	mutable std::mutex _mutex;
+	std::unordered_map<std::string, uint32_t> _nameToId;
+	/**
+	 * /brief A deque never moves its elements, returned names stay valid.
+	 */
+	std::deque<std::string> _names;
+};
@@ -0,0 +1,167 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTagSet.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/**
+ * /brief Small unordered set of interned tag ids, see CTagRegistry.
+ * Up to INLINE_CAPACITY tags live inside the object, more spill to a heap array.
+ */
+class CTagSet final
+{
+public:
+	static constexpr uint32_t INLINE_CAPACITY{ 4 };
+
+	CTagSet() = default;
+	~CTagSet() { _freeHeap(); }
+
+	CTagSet(const CTagSet& other) { _assign(other); }
+	CTagSet(CTagSet&& other) noexcept : _size(other._size), _capacity(other._capacity) {
+		// The heap array changes hands, inline tags are copied
+		if (other._isInline())
+			std::memcpy(_inline, other._inline, sizeof(_inline));
+		else
+			_heap = other._heap;
+		other._size = 0;
+		other._capacity = INLINE_CAPACITY;
+	}
+	CTagSet& operator=(const CTagSet& other) {
+		if (this != &other)
+		{
+			Clear();
+			_assign(other);
+		}
+		return *this;
+	}
+
+	/**
+	 * /brief Returns false if the tag was already in the set.
+	 */
+	bool Add(const uint32_t tagId) {
+		if (Contains(tagId))
+			return false;
+
+		if (_size == _capacity)
+		{
+			_grow();
+		}
+		_data()[_size++] = tagId;
+		return true;
+	}
+
+	/**
+	 * /brief Returns false if the tag wasn't in the set. Order is not preserved.
+	 */
+	bool Remove(const uint32_t tagId) {
+		uint32_t* const tags{ _data() };
+		for (uint32_t i{}; i < _size; i++)
+		{
+			if (tags[i] == tagId)
+			{
+				tags[i] = tags[--_size];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool Contains(const uint32_t tagId) const {
+		const uint32_t* const tags{ _data() };
+		for (uint32_t i{}; i < _size; i++)
+		{
+			if (tags[i] == tagId)
+				return true;
+		}
+		return false;
+	}
+
+	void Clear() {
+		_freeHeap();
+		_size = 0;
+		_capacity = INLINE_CAPACITY;
+	}
+
+	inline uint32_t Size() const { return _size; }
+	inline bool IsEmpty() const { return _size == 0; }
+
+	inline const uint32_t* begin() const { return _data(); }
+	inline const uint32_t* end() const { return _data() + _size; }
+
+private:
+	union
+	{
+		uint32_t _inline[INLINE_CAPACITY];
+		uint32_t* _heap;
+	};
+	uint32_t _size{};
+	uint32_t _capacity{ INLINE_CAPACITY };
+
+	inline bool _isInline() const { return _capacity == INLINE_CAPACITY; }
+	inline uint32_t* _data() { return _isInline() ? _inline : _heap; }
+	inline const uint32_t* _data() const { return _isInline() ? _inline : _heap; }
+
+	void _grow() {
+		const uint32_t newCapacity{ _capacity * 2 };
+		uint32_t* const tags{ static_cast<uint32_t*>(std::malloc(newCapacity * sizeof(uint32_t))) };
+		if (!tags)
+			throw std::bad_alloc();
+
+		std::memcpy(tags, _data(), _size * sizeof(uint32_t));
+		_freeHeap();
+		_heap = tags;
+		_capacity = newCapacity;
+	}
+
+	void _freeHeap() {
+		if (!_isInline())
+		{
+			std::free(_heap);
+			_capacity = INLINE_CAPACITY;
+		}
+	}
+
+	void _assign(const CTagSet& other) {
+		for (const auto tagId : other)
+		{
+			Add(tagId);
+		}
+	}
+};
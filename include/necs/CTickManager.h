@@ -0,0 +1,145 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTickManager.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#include "necs/IEntityFactory.h"
+#include "necs/DTickSettings.h"
+
+class CWorldObject;
+class CJobSystem;
+
+/**
+ * /brief Ticks objects grouped by concrete class, one non virtual dispatch loop per class bucket.
+ * Only objects that can ever tick are registered, the others never reach the tick loop.
+ * Tick groups run in order. Inside a group the buckets are colored into waves of buckets whose declared
+ * component access does not conflict, with a job system the buckets of a wave tick concurrently in chunks.
+ * Objects registered while ticking, e.g. spawned by a tick, join their bucket once the running group is ticked. Objects must not be unregistered while ticking.
+ */
+class CTickManager
+{
+public:
+	/**
+	 * /brief Without a job system every bucket ticks on the calling thread.
+	 */
+	CTickManager(const IEntityFactory& entityFactory, CJobSystem* const jobSystem = nullptr) : _entityFactory(entityFactory), _jobSystem(jobSystem) {}
+
+	/**
+	 * /brief Adds the object to the bucket of its class, objects that can never tick are ignored.
+	 * While ticking the object is queued and added after the running group, the buckets being ticked are never touched.
+	 */
+	void Register(CWorldObject* const object);
+
+	/**
+	 * /brief Removes the object from its bucket in O(1), order inside the bucket is not preserved.
+	 */
+	void Unregister(CWorldObject* const object);
+
+	/**
+	 * /brief Replaces a registered object by its relocated copy, in the same bucket slot. Not while ticking.
+	 */
+	void Relocate(CWorldObject* const from, CWorldObject* const to);
+
+	/**
+	 * /brief Ticks every group in order.
+	 */
+	void Tick();
+
+	/**
+	 * /brief Ticks the buckets of a single group, wave after wave.
+	 */
+	void TickGroup(const ETickGroup group);
+
+	/**
+	 * /brief Number of objects of a concurrent bucket ticked by a single job.
+	 */
+	inline void SetTickChunkSize(const uint32_t chunkSize) { _tickChunkSize = chunkSize; }
+
+	/**
+	 * /brief Waves of bucket indices of the group, recomputed when a new class is registered.
+	 */
+	const std::vector<std::vector<uint32_t>>& GetWaves(const ETickGroup group);
+
+	/**
+	 * /brief Sorts every bucket by object address so the tick loop walks slab memory linearly. Not while ticking.
+	 */
+	void SortBucketsByAddress();
+	/**
+	 * /brief Sorts the bucket of a single class, if it has one.
+	 */
+	void SortBucketByAddress(const IWorldObjectCDO* const classCdo);
+
+	/**
+	 * /brief True while a tick group runs.
+	 */
+	inline bool IsTicking() const { return _ticking; }
+
+	inline uint64_t GetNumOfBuckets() const { return _buckets.size(); }
+	uint64_t GetNumOfTickingObjects() const;
+
+private:
+	struct DTickBucket
+	{
+		const IWorldObjectCDO* ClassCDO;
+		WorldObjectTickBucketFunc TickFunc;
+		DTickSettings Settings;
+		std::vector<CWorldObject*> Objects;
+	};
+
+	const IEntityFactory& _entityFactory;
+	CJobSystem* const _jobSystem;
+	uint32_t _tickChunkSize{ 64 };
+
+	std::vector<DTickBucket> _buckets;
+	std::unordered_map<const IWorldObjectCDO*, uint32_t> _classCdoToBucket;
+
+	std::array<std::vector<std::vector<uint32_t>>, static_cast<size_t>(ETickGroup::Count)> _waves;
+	bool _wavesDirty{};
+	bool _ticking{};
+	/**
+	 * /brief Objects registered while ticking.
+	 */
+	std::vector<CWorldObject*> _pendingRegistrations;
+
+	uint32_t _findOrAddBucket(const IWorldObjectCDO* const classCdo);
+	void _sortBucketByAddress(DTickBucket& bucket);
+	void _rebuildWaves();
+	void _tickWave(const std::vector<uint32_t>& wave);
+};
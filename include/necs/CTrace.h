@@ -0,0 +1,126 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTrace.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * /brief Zones and counters around spawning, destroy flushing, slab growth and tick dispatch, compiled out unless the build sets NECS_TRACE to 1.
+ */
+#ifndef NECS_TRACE
+#define NECS_TRACE 0
+#endif
+
+/**
+ * /brief Receives the library zones and counters. Names are string literals, a sink may keep the pointers.
+ * Called from every thread that spawns, destroys or ticks, zones begin and end on the same thread and nest.
+ */
+struct ITraceSink
+{
+	virtual ~ITraceSink() = default;
+
+	virtual void BeginZone(const char* name) = 0;
+	virtual void EndZone(const char* name) = 0;
+	virtual void Counter(const char* name, const int64_t value) = 0;
+	/**
+	 * /brief Called at the end of every world tick.
+	 */
+	virtual void EndFrame() {}
+};
+
+/**
+ * /brief Process wide sink the library reports to, none by default.
+ */
+class CTrace final
+{
+public:
+	/**
+	 * /brief The sink is not owned, it must outlive the zones opened while it is set.
+	 */
+	static inline void SetSink(ITraceSink* const sink) { _sink.store(sink, std::memory_order_release); }
+	static inline ITraceSink* GetSink() { return _sink.load(std::memory_order_acquire); }
+
+	static inline void Counter(const char* const name, const int64_t value) {
+		if (ITraceSink* const sink{ GetSink() })
+			sink->Counter(name, value);
+	}
+
+	static inline void EndFrame() {
+		if (ITraceSink* const sink{ GetSink() })
+			sink->EndFrame();
+	}
+
+private:
+	static inline std::atomic<ITraceSink*> _sink{};
+};
+
+/**
+ * /brief Scoped zone, ends on the sink it began on even if the sink is replaced meanwhile.
+ */
+class CTraceZone final
+{
+public:
+	explicit CTraceZone(const char* const name) : _name(name), _sink(CTrace::GetSink()) {
+		if (_sink)
+			_sink->BeginZone(_name);
+	}
+	~CTraceZone() {
+		if (_sink)
+			_sink->EndZone(_name);
+	}
+
+	CTraceZone(const CTraceZone&) = delete;
+	CTraceZone& operator=(const CTraceZone&) = delete;
+
+private:
+	const char* const _name;
+	ITraceSink* const _sink;
+};
+
+#define NECS_TRACE_CONCAT_IMPL(a, b) a##b
+#define NECS_TRACE_CONCAT(a, b) NECS_TRACE_CONCAT_IMPL(a, b)
+
+#if NECS_TRACE
+#define NECS_TRACE_ZONE(name) const CTraceZone NECS_TRACE_CONCAT(_necsTraceZone, __LINE__){ name }
+#define NECS_TRACE_COUNTER(name, value) CTrace::Counter(name, static_cast<int64_t>(value))
+#define NECS_TRACE_END_FRAME() CTrace::EndFrame()
+#else
+// The arguments are not evaluated
+#define NECS_TRACE_ZONE(name) ((void)0)
+#define NECS_TRACE_COUNTER(name, value) ((void)0)
+#define NECS_TRACE_END_FRAME() ((void)0)
+#endif
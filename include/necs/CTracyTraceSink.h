@@ -0,0 +1,83 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTracyTraceSink.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "necs/CTrace.h"
+
+#include <cstring>
+#include <vector>
+
+#include <tracy/TracyC.h>
+
+/**
+ * /brief Forwards the trace to the Tracy profiler through its C API. Header only so the library does not depend on Tracy,
+ * include it where Tracy is available and build with TRACY_ENABLE, without it every call is a no-op. Written against the Tracy 0.11 C API.
+ */
+class CTracyTraceSink final : public ITraceSink
+{
+public:
+#ifdef TRACY_ENABLE
+	void BeginZone(const char* name) override {
+		const uint64_t sourceLocation{ ___tracy_alloc_srcloc_name(0, "necs", 4, name, std::strlen(name), name, std::strlen(name), 0) };
+		_getZones().push_back(___tracy_emit_zone_begin_alloc(sourceLocation, 1));
+	}
+
+	void EndZone(const char* name) override {
+		auto& zones{ _getZones() };
+		___tracy_emit_zone_end(zones.back());
+		zones.pop_back();
+	}
+
+	void Counter(const char* name, const int64_t value) override {
+		___tracy_emit_plot_int(name, value);
+	}
+
+	void EndFrame() override {
+		___tracy_emit_frame_mark(nullptr);
+	}
+
+private:
+	// Zones nest per thread, the one ending is the last one begun on this thread
+	static std::vector<TracyCZoneCtx>& _getZones() {
+		thread_local std::vector<TracyCZoneCtx> zones;
+		return zones;
+	}
+#else
+	void BeginZone(const char* name) override {}
+	void EndZone(const char* name) override {}
+	void Counter(const char* name, const int64_t value) override {}
+#endif
+};
@@ -0,0 +1,70 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTypeIndex.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * /brief Dense per category index assigned to each type on first use, usable to index flat arrays instead of hashing.
+ * Indices are process local and depend on the order of first use, never persist them.
+ */
+template<typename Category_T>
+class CTypeIndex
+{
+public:
+	template<typename T>
+	static uint32_t Of()
+	{
+		static const uint32_t index{ _next.fetch_add(1, std::memory_order_relaxed) };
+		return index;
+	}
+
+	/**
+	 * /brief Number of indices assigned so far.
+	 */
+	static uint32_t Count() { return _next.load(std::memory_order_relaxed); }
+
+private:
+	inline static std::atomic<uint32_t> _next{};
+};
+
+struct DComponentTypeCategory;
+
+/**
+ * /brief Dense index of component types, shared by the dense stores and the tick access declarations.
+ */
+using CComponentTypeIndex = CTypeIndex<DComponentTypeCategory>;
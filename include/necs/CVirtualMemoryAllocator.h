@@ -0,0 +1,148 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CVirtualMemoryAllocator.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "IAlignedAllocator.h"
+
+/**
+ * /brief Backing of CVirtualMemoryAllocator, fixed for the allocator lifetime.
+ */
+struct DVirtualMemorySettings
+{
+	/**
+	 * /brief Rounds allocations to 2MB huge pages, transparent huge pages on Linux and large pages on Windows.
+	 * A hint, falls back to regular pages when the system has none available.
+	 */
+	bool HugePages{};
+	/**
+	 * /brief Binds the committed pages to this NUMA node, -1 leaves placement to the system. A hint as well.
+	 */
+	int32_t NumaNode{ -1 };
+	/**
+	 * /brief Address space reserved at once, allocations are carved from it and larger ones get a range of their own.
+	 */
+	uint64_t RegionBytes{ uint64_t(1) << 30 };
+};
+
+/**
+ * /brief Page granular aligned allocator, reserves large virtual ranges and commits pages on allocation.
+ * Meant as the backing of slab allocators: CPagedAllocator rounds its slabs to the page granularity, so each slab covers whole pages
+ * and with huge pages millions of objects are reached through a handful of TLB entries.
+ * Freed ranges are decommitted and reused by later allocations of a similar size. Thread safe, allocations are expected to be rare and large.
+ */
+class CVirtualMemoryAllocator : public IAlignedAllocator
+{
+public:
+	explicit CVirtualMemoryAllocator(const DVirtualMemorySettings& settings = {});
+	~CVirtualMemoryAllocator();
+
+	/**
+	 * /brief Takes over the ranges of other, the allocations made by other must be freed through this allocator.
+	 */
+	CVirtualMemoryAllocator(CVirtualMemoryAllocator&& other) noexcept;
+	CVirtualMemoryAllocator(const CVirtualMemoryAllocator&) = delete;
+	CVirtualMemoryAllocator& operator=(const CVirtualMemoryAllocator&) = delete;
+
+	/**
+	 * /brief Sizes are rounded up to the page size, alignments up to the page size are honored.
+	 */
+	void* Allocate(const uint64_t bytes, const uint64_t alignement) override;
+	void Free(void* ptr) override;
+
+	/**
+	 * /brief The page size, 2MB with huge pages.
+	 */
+	uint64_t GetAllocationGranularity() const override { return _pageSize; }
+
+	/**
+	 * /brief Bytes currently committed by live allocations.
+	 */
+	uint64_t GetCommittedBytes() const;
+
+	static uint64_t GetSystemPageSize();
+
+private:
+	inline static constexpr uint64_t HUGE_PAGE_SIZE{ uint64_t(2) << 20 };
+
+	struct DRegion
+	{
+		uint8_t* Base{};
+		uint64_t Bytes{};
+		uint64_t Used{};
+	};
+
+	struct DAllocation
+	{
+		uint64_t Bytes{};
+		/**
+		 * /brief Owns its own mapping, released on free instead of being kept for reuse. Windows large pages can't be reserved upfront.
+		 */
+		bool Dedicated{};
+	};
+
+	DVirtualMemorySettings _settings;
+	uint64_t _pageSize;
+
+	mutable std::mutex _mutex;
+	std::vector<DRegion> _regions;
+	std::unordered_map<void*, DAllocation> _allocations;
+	/**
+	 * /brief Decommitted ranges by size.
+	 */
+	std::multimap<uint64_t, void*> _freeRanges;
+	uint64_t _committedBytes{};
+
+	void* _carve(const uint64_t bytes);
+	bool _commit(void* const ptr, const uint64_t bytes);
+	void _decommit(void* const ptr, const uint64_t bytes);
+};
+
+/**
+ * /brief Default constructible huge page backing, for the allocators taking their backing as a template parameter.
+ * e.g. CPagedAllocator<CHugePageAllocator<>> or CMatrixAllocator<CPagedAllocator<CHugePageAllocator<0>>> to bind the slabs to node 0.
+ */
+template<int32_t NumaNode = -1>
+class CHugePageAllocator final : public CVirtualMemoryAllocator
+{
+public:
+	CHugePageAllocator() : CVirtualMemoryAllocator(DVirtualMemorySettings{ true, NumaNode }) {}
+};
@@ -0,0 +1,323 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CWorld.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "necs/IEntityFactory.h"
+#include "necs/CWorldObject.h"
+#include "necs/CMatrixAllocator.h"
+#include "necs/CPagedAllocator.h"
+#include "necs/CHeapAlignedAllocator.h"
+#include "necs/CFrameArenaAllocator.h"
+#include "necs/CTickManager.h"
+#include "necs/CTagRegistry.h"
+#include "necs/CHandleTable.h"
+#include "necs/CWorldQuery.h"
+#include "necs/CStats.h"
+
+class CJobSystem;
+
+/**
+ * /brief Owns the world objects, spawns them from the entity factory into a matrix allocator and destroys them at frame end.
+ * Objects marked pending destroy stay alive until FlushPendingDestroy, which destroys and frees them in one batch
+ * grouped by size class and sorted by address so the allocator walks its slabs in order.
+ * The world keeps an inverted tag index, tag queries cost O(matches). Tags must not change while ticking concurrently.
+ */
+class CWorld final : public IWorldObjectManager, public IWorldObjectPendingDestroyNotifier, private IWorldObjectObserver
+{
+	friend class CWorldSnapshot;
+public:
+	using ObjectsAllocator = CMatrixAllocator<CPagedAllocator<CHeapAlignedAllocator>>;
+
+	/**
+	 * /param maxObjectsPerSlab Objects of the same size class per slab.
+	 * /param jobSystem Optional, ticks independent classes concurrently.
+	 */
+	CWorld(IEntityFactory& entityFactory, const uint64_t maxObjectsPerSlab = 64, CJobSystem* const jobSystem = nullptr);
+
+	/**
+	 * /brief Destroys every object still alive.
+	 */
+	~CWorld();
+
+	CWorld(const CWorld&) = delete;
+	CWorld& operator=(const CWorld&) = delete;
+
+	using IWorldObjectManager::SpawnWorldObject;
+	using IWorldObjectManager::SpawnWorldObjects;
+	/**
+	 * /brief May be called from a tick, the object ticks from the next tick group on. Spawning is not thread safe,
+	 * with a job system only the ticks of exclusive classes may spawn.
+	 */
+	CWorldObject* SpawnWorldObject(const std::string& typeName) override;
+	CWorldObject* SpawnWorldObject(const uint32_t classId) override;
+
+	/**
+	 * /brief Allocates all the objects with one batch allocation, a failing construction destroys the objects already constructed and rethrows.
+	 * May be called from a tick like SpawnWorldObject.
+	 */
+	void SpawnWorldObjects(const uint32_t classId, const uint64_t count, CWorldObject** const out, const std::function<void(CWorldObject* object, uint64_t index)>& init = {}, const CWorldObject* const prototype = nullptr) override;
+
+	/**
+	 * /brief Thread safe, objects may mark themselves or others while ticking concurrently.
+	 */
+	void MarkPendingDestroy(CWorldObject* ptr) override;
+
+	/**
+	 * /brief Destroys and frees every object marked pending destroy.
+	 * Objects marked by the destructors of the batch are destroyed by the next flush.
+	 */
+	void FlushPendingDestroy();
+
+	/**
+	 * /brief Ticks every object, flushes the pending destroy queue, records the component changes then swaps the frame components arena.
+	 */
+	void Tick();
+
+	inline uint64_t GetNumOfWorldObjects() const { return _worldObjects.size(); }
+	uint64_t GetNumOfPendingDestroy() const;
+
+	inline IEntityFactory& GetEntityFactory() const { return _entityFactory; }
+	inline CTickManager& GetTickManager() { return _tickManager; }
+	inline CFrameArenaAllocator& GetFrameComponentsAllocator() { return _frameComponentsAllocator; }
+
+	/**
+	 * /brief Returns nullptr once the object was destroyed, even if its slot is reused.
+	 */
+	inline CWorldObject* ResolveHandle(const DWorldObjectHandle handle) const { return _handles.Resolve(handle); }
+
+	template<typename T>
+	T* ResolveHandle(const DWorldObjectHandle handle) const {
+		static_assert(std::is_base_of<CWorldObject, T>::value, "Must derived from CWorldObject");
+		return static_cast<T*>(ResolveHandle(handle));
+	}
+
+	/**
+	 * /brief Cached query of the objects holding every one of the components in their archetype, e.g. Query<DPosition, const DVelocity>().ForEach(...).
+	 * Classes are matched on their CDO signature, the first query matches every registered class and later ones only the classes registered since.
+	 * Components constructed outside the archetype aren't part of the class signature and can't be queried.
+	 */
+	template<typename... Components_T>
+	CWorldQuery<Components_T...> Query() {
+		const uint32_t queryIndex{ CWorldQueryIndex::Of<CWorldQuery<std::remove_cv_t<Components_T>...>>() };
+		if (_queries.size() <= queryIndex)
+		{
+			_queries.resize(queryIndex + 1);
+		}
+
+		auto& cache{ _queries[queryIndex] };
+		if (!cache)
+		{
+			cache = std::make_unique<CWorldQueryCache>(std::vector<uint32_t>{ CComponentTypeIndex::Of<std::remove_cv_t<Components_T>>()... });
+		}
+		cache->Update(_entityFactory);
+		return CWorldQuery<Components_T...>(*cache, _classObjects);
+	}
+
+	/**
+	 * /brief Counters of the objects allocator per size class and of the objects per entity class, see NECS_STATS.
+	 * Must not run concurrently with spawns and destructions.
+	 */
+	DWorldStats GetStats() const;
+
+	/**
+	 * /brief Version of the last recorded frame, Tick records the component changes of the frame under the next version.
+	 */
+	inline uint64_t GetChangeVersion() const { return _changeVersion; }
+
+	/**
+	 * /brief Calls fn once per alive object changed in the frames recorded after the version, with the union of its changed bits.
+	 * Costs O(recorded changes), nothing is scanned. Returns false without calling fn if those frames are no longer kept, the caller must resynchronize everything.
+	 */
+	bool ForEachChangeSince(const uint64_t version, const std::function<void(CWorldObject* object, uint64_t changedBits)>& fn);
+
+	/**
+	 * /brief Number of recorded frames kept for ForEachChangeSince, 64 by default.
+	 */
+	void SetChangeHistoryLength(const uint64_t numOfFrames);
+
+	/**
+	 * /brief Objects carrying the tag, in no particular order. Invalidated by tag changes and destruction.
+	 */
+	const std::vector<CWorldObject*>& GetObjectsWithTag(const uint32_t tagId) const;
+	inline const std::vector<CWorldObject*>& GetObjectsWithTag(const std::string& tagName) const { return GetObjectsWithTag(CTagRegistry::Intern(tagName)); }
+
+	/**
+	 * /brief Queues the live objects of a relocatable class to be packed densely in the slabs of their size class, in the given order or by address.
+	 * Throws if the class has no relocating constructor, see IEntityFactory::IsClassRelocatable. Objects spawned afterwards aren't part of the compaction.
+	 */
+	void BeginCompaction(const uint32_t classId, const std::function<bool(const CWorldObject& a, const CWorldObject& b)>& less = {});
+
+	/**
+	 * /brief Relocates up to maxRelocations queued objects, e.g. once per frame after Tick. Pointers to relocated objects are invalidated, their handles follow them.
+	 * Throws runtime_error when called while ticking, the tick loop walks the objects being moved.
+	 * The objects of a step move to the lowest addresses among their blocks and as many newly allocated ones, a single step lays the whole class out in order.
+	 * /return True once nothing is left to relocate.
+	 */
+	bool StepCompaction(const uint64_t maxRelocations = UINT64_MAX);
+
+	inline uint64_t GetNumOfPendingRelocations() const { return _compactionQueue.size() - _compactionNext; }
+
+private:
+	IEntityFactory& _entityFactory;
+	ObjectsAllocator _objectsAllocator;
+	CHeapAlignedAllocator _runtimeComponentsAllocator;
+	CFrameArenaAllocator _frameComponentsAllocator;
+	CTickManager _tickManager;
+
+	std::unordered_set<CWorldObject*> _worldObjects;
+	CWorldObjectHandleTable _handles;
+
+	/**
+	 * /brief Objects of each class indexed by class id, iterated by the queries.
+	 */
+	std::vector<std::vector<CWorldObject*>> _classObjects;
+	std::vector<DEntityClassCounters> _classCounters;
+	/**
+	 * /brief Indexed by CWorldQueryIndex.
+	 */
+	std::vector<std::unique_ptr<CWorldQueryCache>> _queries;
+
+	/**
+	 * /brief Reused between bulk spawns.
+	 */
+	std::vector<void*> _spawnBatch;
+
+	struct DTagIndex
+	{
+		std::vector<CWorldObject*> Objects;
+		/**
+		 * /brief Position of each object in Objects, for swap removal.
+		 */
+		std::unordered_map<CWorldObject*, uint32_t> Slots;
+	};
+
+	/**
+	 * /brief Indexed by interned tag id.
+	 */
+	std::vector<DTagIndex> _tagIndex;
+
+	mutable std::mutex _pendingDestroyMutex;
+	std::vector<CWorldObject*> _pendingDestroy;
+
+	/**
+	 * /brief Reused between flushes, pairs of size class and object.
+	 */
+	std::vector<std::pair<uint64_t, CWorldObject*>> _destroyBatch;
+	std::vector<void*> _freeBatch;
+
+	struct DChangeRecord
+	{
+		DWorldObjectHandle Handle;
+		uint64_t ChangedBits;
+	};
+
+	struct DChangeFrame
+	{
+		uint64_t Version;
+		std::vector<DChangeRecord> Records;
+	};
+
+	/**
+	 * /brief Objects changed since the last record, by handle so destroyed objects are skipped.
+	 */
+	std::mutex _changedObjectsMutex;
+	std::vector<DWorldObjectHandle> _changedObjects;
+	std::deque<DChangeFrame> _changeHistory;
+	uint64_t _changeHistoryLength{ 64 };
+	uint64_t _changeVersion{};
+	/**
+	 * /brief Reused by ForEachChangeSince, accumulated bits indexed by handle slot.
+	 */
+	std::vector<uint64_t> _accumulatedChanges;
+	std::vector<uint32_t> _accumulatedSlots;
+
+	/**
+	 * /brief Handles of the objects left to relocate, grouped by class in relocation order.
+	 */
+	std::vector<DWorldObjectHandle> _compactionQueue;
+	uint64_t _compactionNext{};
+	/**
+	 * /brief Reused between compaction steps.
+	 */
+	std::vector<CWorldObject*> _compactionRun;
+	std::vector<void*> _compactionBlocks;
+
+	void _destroyBatchSorted();
+	/**
+	 * /brief Destroys every object and drops the pending destroy and compaction queues.
+	 */
+	void _destroyAll();
+	/**
+	 * /brief Moves the changes of the frame to the history and advances the change version.
+	 */
+	void _recordChanges();
+	/**
+	 * /brief Forgets the history, the recorded handles no longer refer to the same objects.
+	 */
+	void _clearChangeHistory();
+	/**
+	 * /brief Registers a constructed object to the tick manager, the handles and the tag index.
+	 */
+	void _addSpawned(CWorldObject* const object);
+	/**
+	 * /brief Like _addSpawned for an object rebuilt by a snapshot, binds it to its saved handle and replaces its tags.
+	 */
+	void _addRestored(CWorldObject* const object, const DWorldObjectHandle handle, const uint32_t* const tags, const uint32_t numOfTags);
+	void _addToClassObjects(CWorldObject* const object);
+	void _removeFromClassObjects(CWorldObject* const object);
+	/**
+	 * /brief Relocates the objects of _compactionRun, all of the class, through a heap staging buffer so their own blocks are candidates too.
+	 */
+	void _compactRun(const uint32_t classId);
+	/**
+	 * /brief Moves the object to memory and points the indices at its new address, the old memory is left to the caller.
+	 */
+	CWorldObject* _relocate(CWorldObject* const object, void* const memory);
+
+	void OnTagAdded(CWorldObject* const object, const uint32_t tagId) override;
+	void OnTagRemoved(CWorldObject* const object, const uint32_t tagId) override;
+	void OnComponentsChanged(CWorldObject* const object) override;
+};
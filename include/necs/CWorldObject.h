@@ -37,7 +37,6 @@
 
 #include <cassert>
 #include <stdint.h>
-#include <set>
 #include <cstddef>
 #include <limits>
 #include <memory>
@@ -45,11 +44,20 @@
 #include <string>
 #include <cmath>
 #include <stdexcept>
-
-#include "clow/gpalloc.h"
+#include <algorithm>
+#include <atomic>
 
 #include "necs/IWorldObjectCDO.h"
 #include "necs/IAlignedAllocator.h"
+#include "necs/DTickSettings.h"
+#include "necs/CComponentHandle.h"
+#include "necs/CHeapAlignedAllocator.h"
+#include "necs/CFrameArenaAllocator.h"
+#include "necs/BitUtils.h"
+#include "necs/CTagSet.h"
+#include "necs/IIDGenerator.h"
+#include "necs/CTypeIndex.h"
+#include "necs/CStats.h"
 
 struct IWorldObjectPendingDestroyNotifier
 {
@@ -58,6 +66,21 @@ struct IWorldObjectPendingDestroyNotifier
 	virtual void MarkPendingDestroy(class CWorldObject* ptr) = 0;
 };
 
+/**
+ * /brief Receives the object changes a world keeps an index of, every callback defaults to a no-op.
+ */
+struct IWorldObjectObserver
+{
+	virtual ~IWorldObjectObserver() = default;
+
+	virtual void OnTagAdded(class CWorldObject* const object, const uint32_t tagId) {}
+	virtual void OnTagRemoved(class CWorldObject* const object, const uint32_t tagId) {}
+	/**
+	 * /brief Called on the first change of the object components since its changes were last recorded, possibly while ticking concurrently.
+	 */
+	virtual void OnComponentsChanged(class CWorldObject* const object) {}
+};
+
 /**
  * /brief Base struct for the WorldObject initialization.
  */
@@ -68,6 +91,16 @@ struct DWorldObjectInitializer
 	uint64_t ClassAlignment{};
 	IWorldObjectPendingDestroyNotifier* PendingDestroyNotifier{};
 	IAlignedAllocator* RuntimeComponentsAllocator{};
+	CFrameArenaAllocator* FrameComponentsAllocator{};
+	uint32_t ClassId{ UINT32_MAX };
+};
+
+/**
+ * /brief Initializer of the relocating constructors T(const DWorldObjectRelocation&, T&&), a distinct type so a prototype constructor is never taken for one.
+ */
+struct DWorldObjectRelocation
+{
+	DWorldObjectInitializer Initializer;
 };
 
 inline bool IsPowerOfTwo(const uint64_t value)
@@ -84,16 +117,16 @@ inline bool IsPowerOfTwo(const uint64_t value)
 class CWorldObjectCDO : public IWorldObjectCDO
 {
 public:
-	CWorldObjectCDO(const bool isConstructingCDO, const uint64_t classSize, const uint64_t classAlignment) :_isConstructingCdo(isConstructingCDO), _classSize(classSize), _classAlignmemt(classAlignment) {
+	CWorldObjectCDO(const bool isConstructingCDO, const uint64_t classSize, const uint64_t classAlignment) :_isConstructingCdo(isConstructingCDO), _classSize(classSize), _classAlignmemt(classAlignment), _componentsEnd(classSize) {
 		assert(_classSize > 0);
 	};
 
 	template<typename T>
 	void StaticRegisterNewComponent() {
-		StaticRegisterNewComponentUnknown(sizeof(T), alignof(T));
+		StaticRegisterNewComponentUnknown(sizeof(T), alignof(T), std::is_trivially_copyable_v<T>, CComponentTypeIndex::Of<T>());
 	};
 
-	void StaticRegisterNewComponentUnknown(const uint64_t sizeOfComponent, const uint64_t alignment)
+	void StaticRegisterNewComponentUnknown(const uint64_t sizeOfComponent, const uint64_t alignment, const bool triviallyCopyable = false, const uint32_t typeIndex = UINT32_MAX)
 	{
 #if _DEBUG
 		{
@@ -101,9 +134,18 @@ public:
 			assert(sizeOfComponent > 0);
 			assert(alignment == 1 || IsPowerOfTwo(alignment) && "Alignment must be a power of two!");
 			assert(sizeOfComponent >= alignment && "Alignment can't be bigger than the type!");
+			assert(alignment <= alignof(std::max_align_t) && "Over aligned components are not supported!");
 		}
 #endif
-		CEntityComponentMetadata meta{ sizeOfComponent, alignment };
+		// Objects are max_align_t aligned, packing each component at its own alignment keeps the absolute address aligned too
+		uint64_t offset{ NO_ARCHETYPE_OFFSET };
+		if (_components.size() < MAX_ARCHETYPE_COMPONENTS)
+		{
+			offset = AlignUp(_componentsEnd, alignment);
+			_componentsEnd = offset + sizeOfComponent;
+		}
+
+		CEntityComponentMetadata meta{ sizeOfComponent, alignment, offset, triviallyCopyable, typeIndex };
 		_components.emplace_back(std::move(meta));
 	}
 
@@ -120,26 +162,23 @@ public:
 
 	uint64_t ComputeComponentsMaxSizeForAllocation()const override
 	{
-		if (_components.size() == 0)
-			return 0;
-
-		// Consider worst case alignment
-		uint64_t bytes{ alignof(std::max_align_t) };
-
-		for (const auto& component : _components)
-		{
-			bytes += component.Size;
-		}
-
-		return bytes;
+		return _componentsEnd - _classSize;
 	}
 private:
 	std::vector<CEntityComponentMetadata> _components;
 	bool _isConstructingCdo{};
 	const uint64_t _classSize;
 	const uint64_t _classAlignmemt;
+	/**
+	 * /brief End offset of the last archetype component from the start of the object.
+	 */
+	uint64_t _componentsEnd;
 };
 
+/**
+ * /brief Places the archetype components of an object at the offsets fixed by its class CDO.
+ * A component takes the first free slot with its exact size and alignment, construction order therefore maps components to their registered slot.
+ */
 class CWorldObjectArchetypesComponentsContainer
 {
 	friend class CWorldObjectArchetypesComponentsContainerFixture;
@@ -153,75 +192,119 @@ public:
 
 		if (staticClassCdo && staticClassCdo->GetCDOComponentsInfo().size() > 0)
 		{
-#if _DEBUG
 			assert(worldObject);
 			assert(staticClassCdo->GetClassSize() != 0);
-			_worldObjectComponentsPtrBegin = toUintptr(worldObject) + staticClassCdo->GetClassSize();
-			_worldObjectComponentsPtrEnd = toUintptr(worldObject) + staticClassCdo->GetClassSize() + staticClassCdo->ComputeComponentsMaxSizeForAllocation();
-			assert(_worldObjectComponentsPtrBegin % alignof(std::max_align_t) == 0
-				&& "Buffer must be properly aligned!");
-#endif
 
-			const uint64_t componentsBytes{ staticClassCdo->ComputeComponentsMaxSizeForAllocation() };
-			gpalloc_initialize(&_allocator, reinterpret_cast<void*>(toUintptr(worldObject) + staticClassCdo->GetClassSize()), componentsBytes);
+			_components = &staticClassCdo->GetCDOComponentsInfo();
+
+			const uint64_t numOfSlots{ std::min<uint64_t>(_components->size(), MAX_ARCHETYPE_COMPONENTS) };
+			_freeSlots = (uint64_t{ 1 } << numOfSlots) - 1;
 		}
 	}
 
 
 protected:
-	void* MallocComponent(const uint64_t size, const uint64_t alignment) {
+	/**
+	 * /param worldObject The parent the offsets are relative to, it isn't stored to keep the container small.
+	 * /param typeIndex CComponentTypeIndex of the component, a slot is only reused by the type it was registered with so queries never see another type in it.
+	 * Slots registered without their type are matched by layout only, queries never match them.
+	 */
+	void* MallocComponent(const void* worldObject, const uint64_t size, const uint64_t alignment, const uint32_t typeIndex) {
 		assert(alignment == 1 || IsPowerOfTwo(alignment) && "Alignment must be a power of two!");
 		assert(size >= alignment);
 
-		if (_allocator.buffer_size == 0)
-			return nullptr;
-
-		void* newPtr{ gpalloc_malloc(&_allocator, size, alignment) };
-		if (!newPtr)
-			return nullptr;
-		//sanity check, we shouldn't allocate outside the archetype's memory bounds, because we would corrupt other archetypes or worse UB.
+		for (uint64_t slots{ _freeSlots }; slots != 0; slots &= slots - 1)
 		{
-			assert(toUintptr(newPtr) >= _worldObjectComponentsPtrBegin && "Pointer must not go outside the archetype's memory bound!");
-			assert(toUintptr(newPtr) < _worldObjectComponentsPtrEnd && "Pointer must not go outside the archetype's memory bound!");
-			assert(toUintptr(newPtr) + size <= _worldObjectComponentsPtrEnd && "Pointer must not write outside the archetype's memory bound!");
+			const uint64_t slot{ CountTrailingZeros(slots) };
+			const auto& component{ (*_components)[slot] };
+			if ((component.TypeIndex == typeIndex || component.TypeIndex == UINT32_MAX) && component.Size == size && component.Alignment == alignment)
+			{
+				_freeSlots &= ~(uint64_t{ 1 } << slot);
+				return reinterpret_cast<void*>(toUintptr(worldObject) + component.Offset);
+			}
 		}
-		return newPtr;
+		return nullptr;
 	};
 
-	void FreeComponent(void* ptr)
+	/**
+	 * /brief True if the pointer lies in the archetype's reserved memory.
+	 */
+	bool IsArchetypeComponent(const void* worldObject, const void* ptr) const
+	{
+		if (!_components)
+			return false;
+
+		const auto& last{ (*_components)[_getNumOfSlots() - 1] };
+		const auto address{ toUintptr(ptr) };
+		const auto base{ toUintptr(worldObject) };
+		return address >= base + _components->front().Offset && address < base + last.Offset + last.Size;
+	}
+
+	/**
+	 * /brief Slot of an archetype component, MAX_ARCHETYPE_COMPONENTS if the pointer isn't the start of one.
+	 */
+	uint64_t GetArchetypeSlot(const void* worldObject, const void* ptr) const
+	{
+		if (!IsArchetypeComponent(worldObject, ptr))
+			return MAX_ARCHETYPE_COMPONENTS;
+
+		const uint64_t offset{ toUintptr(ptr) - toUintptr(worldObject) };
+		const auto begin{ _components->begin() };
+		const auto it{ std::lower_bound(begin, begin + _getNumOfSlots(), offset, [](const CEntityComponentMetadata& component, const uint64_t value) { return component.Offset < value; }) };
+		return it != begin + _getNumOfSlots() && it->Offset == offset ? static_cast<uint64_t>(it - begin) : MAX_ARCHETYPE_COMPONENTS;
+	}
+
+	/**
+	 * /brief Takes a given free slot, for the components relocated from another object of the class.
+	 */
+	void* ClaimArchetypeSlot(const void* worldObject, const uint64_t slot) {
+		assert(_components && slot < _getNumOfSlots());
+		const uint64_t slotBit{ uint64_t{ 1 } << slot };
+		assert((_freeSlots & slotBit) != 0 && "Archetype slot already taken!");
+		_freeSlots &= ~slotBit;
+		return reinterpret_cast<void*>(toUintptr(worldObject) + (*_components)[slot].Offset);
+	}
+
+	/**
+	 * /brief One bit per archetype slot holding a constructed component, bits past the last slot are set.
+	 */
+	inline uint64_t GetConstructedArchetypeSlots() const { return ~_freeSlots; }
+
+	void FreeComponent(const void* worldObject, void* ptr)
 	{
-		if (!ptr || _allocator.buffer_size == 0)
+		if (!ptr || !_components)
 			return;
 
-		{
-			//const auto allocationSize{ freelist_get_allocation_size(&_allocator, ptr) };
-			////sanity check, we shouldn't allocate outside the archetype's memory bounds, because we would corrupt other archetypes or worse UB.
-			//assert(toUintptr(ptr) > _worldObjectComponentsPtrBegin && "Pointer must not go outside the archetype's memory bound!");
-			//assert(toUintptr(ptr) < _worldObjectComponentsPtrEnd && "Pointer must not go outside the archetype's memory bound!");
-			//assert(toUintptr(ptr) + allocationSize <= _worldObjectComponentsPtrEnd && "Pointer must not write outside the archetype's memory bound!");
-		}
+		// Offsets are ascending, find the slot starting at the pointer
+		const uint64_t offset{ toUintptr(ptr) - toUintptr(worldObject) };
+		const auto begin{ _components->begin() };
+		const auto it{ std::lower_bound(begin, begin + _getNumOfSlots(), offset, [](const CEntityComponentMetadata& component, const uint64_t value) { return component.Offset < value; }) };
+		assert(it != begin + _getNumOfSlots() && it->Offset == offset && "Pointer is not an archetype component!");
 
-		gpalloc_free(&_allocator, ptr);
+		const uint64_t slotBit{ uint64_t{ 1 } << (it - begin) };
+		assert((_freeSlots & slotBit) == 0 && "Archetype component freed twice!");
+		_freeSlots |= slotBit;
 	}
 
 private:
-	inline std::uintptr_t toUintptr(const CWorldObject* const worldObjectPtr)const {
-		return reinterpret_cast<std::uintptr_t>(worldObjectPtr);
-	}
-	inline std::uintptr_t toUintptr(void* ptr)const {
+	inline std::uintptr_t toUintptr(const void* ptr)const {
 		return reinterpret_cast<std::uintptr_t>(ptr);
 	}
 
-#if _DEBUG
-	uintptr_t _worldObjectComponentsPtrBegin{};
-	uintptr_t _worldObjectComponentsPtrEnd{};
-#endif
+	inline uint64_t _getNumOfSlots()const {
+		return std::min<uint64_t>(_components->size(), MAX_ARCHETYPE_COMPONENTS);
+	}
 
-	gpalloc_t _allocator{};
+	/**
+	 * /brief The class CDO layout, null when the class has no components.
+	 */
+	const std::vector<CEntityComponentMetadata>* _components{};
+	uint64_t _freeSlots{};
 };
 
 class CTickable
 {
+	friend class CTickManager;
 public:
 	CTickable(const bool canEverTick) : _canEverTick(canEverTick) {}
 
@@ -234,26 +317,39 @@ private:
 	 * /brief True if can ever tick. By default will not tick.
 	 */
 	const bool _canEverTick;
+
+	/**
+	 * /brief Position in the tick manager buckets while registered.
+	 */
+	uint32_t _tickBucket{ UINT32_MAX };
+	uint32_t _tickBucketSlot{ UINT32_MAX };
 };
 
 class CDestroyable
 {
 public:
 	CDestroyable(IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier) :_pendingDestroyNotifier(pendingDestroyNotifier) {}
+	/**
+	 * /brief Relocation, takes over the pending destroy state and callback.
+	 */
+	CDestroyable(IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, CDestroyable&& other) noexcept :_pendingDestroyNotifier(pendingDestroyNotifier), PendingDestroy(other.PendingDestroy.load(std::memory_order_relaxed)), _onPendingDestroySetCallback(std::move(other._onPendingDestroySetCallback)) {}
 	bool IsPendingDestroy()const;
 
 	virtual void SetPendingDestroy();
 
-	inline void OnSetPendingDestroyCallback(std::function<void(void)> fn) { _onPendingDestroySetCallback = fn; };
+	/**
+	 * /brief Opt-in, the callback is only allocated when set.
+	 */
+	inline void OnSetPendingDestroyCallback(std::function<void(void)> fn) { _onPendingDestroySetCallback = fn ? std::make_unique<std::function<void(void)>>(std::move(fn)) : nullptr; };
 private:
 	IWorldObjectPendingDestroyNotifier* const _pendingDestroyNotifier;
 
 	/**
 	* /brief True if the entity is asking to be destroyed.
 	*/
-	bool PendingDestroy{};
+	std::atomic<bool> PendingDestroy{};
 
-	std::function<void(void)> _onPendingDestroySetCallback{};
+	std::unique_ptr<std::function<void(void)>> _onPendingDestroySetCallback{};
 };
 
 /**
@@ -262,66 +358,289 @@ private:
  * Components created out of the constructor are allocated in a separate memory pool leading to cache miss, I encourage you to always create all the components upfront in the constructor and removing them in begin play function,
  * components defined in the CDO will always be in contiguos memory right after the archetype.
  */
-class CWorldObject : public CWorldObjectCDO, public CTickable, public CDestroyable, private CWorldObjectArchetypesComponentsContainer
+class CWorldObject : public IWorldObjectCDO, public CTickable, public CDestroyable, public IComponentOwner, private CWorldObjectArchetypesComponentsContainer
 {
+	friend class CWorld;
 public:
-	std::set<std::string> Tags;
-
-	CWorldObject(const DWorldObjectInitializer& initializer, const bool canEverTick) : CWorldObjectCDO(initializer.StaticClassCDO == nullptr, initializer.ClassSize, initializer.ClassAlignment), CTickable(canEverTick), CDestroyable(initializer.PendingDestroyNotifier), CWorldObjectArchetypesComponentsContainer(this, initializer.StaticClassCDO), _runtimeComponentsAllocator(initializer.RuntimeComponentsAllocator) {
-		// TODO remove this check
-		if (initializer.StaticClassCDO)
+	CWorldObject(const DWorldObjectInitializer& initializer, const bool canEverTick) : CTickable(canEverTick), CDestroyable(initializer.PendingDestroyNotifier), CWorldObjectArchetypesComponentsContainer(this, initializer.StaticClassCDO), _staticClassCdo(initializer.StaticClassCDO), _runtimeComponentsAllocator(initializer.RuntimeComponentsAllocator), _frameComponentsAllocator(initializer.FrameComponentsAllocator), _staticClassId(initializer.ClassId) {
+		// Only the CDO owns the class layout, instances read it from their class CDO
+		if (!initializer.StaticClassCDO)
 		{
-			//assert(initializer.StaticClassCDO->GetComponentsReservedSize() > 0);
+			_cdoLayout = std::make_unique<CWorldObjectCDO>(true, initializer.ClassSize, initializer.ClassAlignment);
 		}
 	};
 
+	/**
+	 * /brief Prototype constructor, for the prototype constructors of the derived classes. Carries over the tick ability and the tags.
+	 * The derived class copies its own state, e.g. NewComponent<T>(*prototype.Component) which is a plain copy for trivially copyable components.
+	 */
+	CWorldObject(const DWorldObjectInitializer& initializer, const CWorldObject& prototype) : CWorldObject(initializer, prototype.CanEverTick()) {
+		assert(!prototype.IsCDO() && "The CDO can't be a prototype");
+		_tags = prototype._tags;
+	};
+
+	/**
+	 * /brief Relocating constructor, for the relocating constructors of the derived classes. Takes over the handle, the tags, the tick registration and the changed components.
+	 * The derived class moves its own state and hands every component to RelocateComponent, e.g. Position(RelocateComponent(std::move(other.Position), other)).
+	 * The moved from object is destroyed right after, the components not relocated are destroyed with it.
+	 */
+	CWorldObject(const DWorldObjectRelocation& relocation, CWorldObject&& other) noexcept : CTickable(other), CDestroyable(relocation.Initializer.PendingDestroyNotifier, std::move(other)), CWorldObjectArchetypesComponentsContainer(this, relocation.Initializer.StaticClassCDO),
+		_staticClassCdo(relocation.Initializer.StaticClassCDO), _runtimeComponentsAllocator(relocation.Initializer.RuntimeComponentsAllocator), _frameComponentsAllocator(relocation.Initializer.FrameComponentsAllocator),
+		_tags(std::move(other._tags)), _observer(other._observer), _handle(other._handle), _staticClassId(relocation.Initializer.ClassId), _changedComponents(other._changedComponents), _classSlot(other._classSlot), _numOfRuntimeComponents(other._numOfRuntimeComponents) {
+		assert(!other.IsCDO() && "The CDO can't be relocated");
+		assert(other._staticClassId == _staticClassId);
+		other._observer = nullptr;
+		other._handle = {};
+	};
+
 	virtual ~CWorldObject() {
 	};
 
+	inline bool IsCDO()const { return _cdoLayout != nullptr; }
+
+	template<typename T>
+	void StaticRegisterNewComponent() {
+		StaticRegisterNewComponentUnknown(sizeof(T), alignof(T), std::is_trivially_copyable_v<T>, CComponentTypeIndex::Of<T>());
+	};
+
+	void StaticRegisterNewComponentUnknown(const uint64_t sizeOfComponent, const uint64_t alignment, const bool triviallyCopyable = false, const uint32_t typeIndex = UINT32_MAX)
+	{
+		assert(IsCDO() && "Only the CDO registers components");
+		_cdoLayout->StaticRegisterNewComponentUnknown(sizeOfComponent, alignment, triviallyCopyable, typeIndex);
+	}
+
+	const std::vector<CEntityComponentMetadata>& GetCDOComponentsInfo()const override { return _getClassLayout().GetCDOComponentsInfo(); }
+	uint64_t GetClassSize() const override { return _getClassLayout().GetClassSize(); };
+	uint64_t GetClassAlignment() const override { return _getClassLayout().GetClassAlignment(); };
+	uint64_t ComputeComponentsMaxSizeForAllocation()const override { return _getClassLayout().ComputeComponentsMaxSizeForAllocation(); }
+
+	/**
+	 * /brief Tags are interned ids, see CTagRegistry.
+	 */
+	bool AddTag(const uint32_t tagId) {
+		if (!_tags.Add(tagId))
+			return false;
+		if (_observer)
+			_observer->OnTagAdded(this, tagId);
+		return true;
+	}
+
+	bool RemoveTag(const uint32_t tagId) {
+		if (!_tags.Remove(tagId))
+			return false;
+		if (_observer)
+			_observer->OnTagRemoved(this, tagId);
+		return true;
+	}
+
+	inline bool HasTag(const uint32_t tagId) const { return _tags.Contains(tagId); }
+	inline const CTagSet& GetTags() const { return _tags; }
+
+	/**
+	 * /brief Changed bit of the components outside the archetype, past the bits of the archetype slots.
+	 */
+	inline static constexpr uint64_t RUNTIME_COMPONENTS_CHANGED_BIT{ uint64_t{ 1 } << MAX_ARCHETYPE_COMPONENTS };
+	static_assert(MAX_ARCHETYPE_COMPONENTS < 64, "The runtime components need a changed bit of their own");
+
+	/**
+	 * /brief Changes are tracked with one bit per archetype slot, in the order the components are constructed.
+	 */
+	uint64_t GetComponentChangedBit(const void* component) const {
+		const uint64_t slot{ GetArchetypeSlot(this, component) };
+		return slot < MAX_ARCHETYPE_COMPONENTS ? uint64_t{ 1 } << slot : RUNTIME_COMPONENTS_CHANGED_BIT;
+	}
+
+	/**
+	 * /brief Marks components changed, the owning world records the object once until it records the changes at frame end.
+	 * Done by the mutable accessor of the component handles, call it directly for changes made through raw pointers.
+	 */
+	void MarkComponentsChanged(const uint64_t changedBits) {
+		assert(changedBits != 0);
+		const bool isFirstChange{ _changedComponents == 0 };
+		_changedComponents |= changedBits;
+		if (isFirstChange && _observer)
+			_observer->OnComponentsChanged(this);
+	}
+
+	/**
+	 * /brief Components changed since the world last recorded the changes.
+	 */
+	inline uint64_t GetChangedComponents() const { return _changedComponents; }
+
+	/**
+	 * /brief One bit per archetype slot holding a constructed component, a component reset or not constructed yet leaves its bit clear.
+	 */
+	inline uint64_t GetConstructedArchetypeSlots() const { return CWorldObjectArchetypesComponentsContainer::GetConstructedArchetypeSlots(); }
+
+	/**
+	 * /brief Components constructed in the runtime components allocator so far because they didn't fit the archetype slack, 0 unless NECS_STATS is 1.
+	 */
+	inline uint64_t GetNumOfRuntimeComponents() const { return _numOfRuntimeComponents.Get(); }
+
+	/**
+	 * /brief Generational handle given by the owning world, invalid if the object isn't owned by a world.
+	 */
+	inline DGenerationalId GetHandle() const { return _handle; }
+
+	/**
+	 * /brief The CDO of the concrete class, nullptr when this is the CDO.
+	 */
+	inline const IWorldObjectCDO* GetStaticClassCDO()const { return _staticClassCdo; }
+
+	/**
+	 * /brief Id of the concrete class in the entity factory, UINT32_MAX when this is the CDO.
+	 */
+	inline uint32_t GetStaticClassId()const { return _staticClassId; }
+
+	/**
+	 * /brief Tick group and component access of the class, hide it in a derived class to opt into concurrent ticking.
+	 */
+	static DTickSettings GetStaticTickSettings() { return {}; }
+
+	/**
+	 * /brief Constructs a component in the archetype's reserved memory, or in the runtime components allocator when it doesn't fit.
+	 * The handle destroys the component and gives its memory back to this object.
+	 */
 	template<typename T, typename... Args>
-	std::shared_ptr<std::decay_t<T>> NewComponent(Args&&... args) {
+	CComponentHandle<std::decay_t<T>> NewComponent(Args&&... args) {
+		using Component_T = std::decay_t<T>;
 
 		// CDO constructor
 		if (IsCDO())
 		{
-			StaticRegisterNewComponentUnknown(sizeof(T), alignof(T));
-			// Allocate object with new since it's easier just for the CDO
-			return std::make_shared<T>(std::forward<Args>(args)...);
+			StaticRegisterNewComponent<Component_T>();
+			// The CDO has no archetype memory, its components live on the heap
+			return _constructComponent<Component_T>(CHeapAlignedAllocator().Allocate(sizeof(Component_T), alignof(Component_T)), std::forward<Args>(args)...);
 		}
 
 		// Try to allocate in the archetype's reserved memory
-		T* componentPtr{ reinterpret_cast<T*>(MallocComponent(sizeof(std::decay_t<T>), alignof(std::decay_t<T>))) };
-		if (componentPtr)
+		void* memory{ MallocComponent(this, sizeof(Component_T), alignof(Component_T), CComponentTypeIndex::Of<Component_T>()) };
+		if (memory)
 		{
-			// Always alias using placement new, otherwise dynamic type is undefined leading to UB.
-			new(componentPtr) T(std::forward<Args>(args)...);
-			componentPtr = std::launder(componentPtr);
-
-			return std::shared_ptr<std::decay_t<T>>(componentPtr, [this](T* ptr) {
-				/*Free from reserved pool*/
-				FreeComponent(reinterpret_cast<void*>(ptr));
-				});
-
+			return _constructComponent<Component_T>(memory, std::forward<Args>(args)...);
 		}
 
-		// Allocate object with new. TODO use pool allocator memory
-		//return std::make_shared<T>(std::forward<Args>(args)...);
-
 		// Allocate with runtime component allocator
-		componentPtr = reinterpret_cast<T*>(_runtimeComponentsAllocator->Allocate(sizeof(std::decay_t<T>), alignof(std::decay_t<T>)));
-		if (!componentPtr)
+		if (!_runtimeComponentsAllocator)
+			throw std::runtime_error("CWorldEntity has no runtime components allocator!");
+
+		memory = _runtimeComponentsAllocator->Allocate(sizeof(Component_T), alignof(Component_T));
+		if (!memory)
 			throw std::runtime_error("CWorldEntity failed to allocate runtime component!");
+		_numOfRuntimeComponents.Add();
+
+		return _constructComponent<Component_T>(memory, std::forward<Args>(args)...);
+	};
 
-		// Always alias using placement new, otherwise dynamic type is undefined leading to UB.
-		new(componentPtr) T(std::forward<Args>(args)...);
-		componentPtr = std::launder(componentPtr);
+	/**
+	 * /brief Constructs a transient component in the frame arena, a pointer bump with nothing to free.
+	 * The component must be destroyed before the frame arena reclaims its frame, at the end of the frame following this one.
+	 */
+	template<typename T, typename... Args>
+	CComponentHandle<std::decay_t<T>> NewFrameComponent(Args&&... args) {
+		using Component_T = std::decay_t<T>;
+		assert(!IsCDO() && "The CDO has no use for transient components");
+
+		if (!_frameComponentsAllocator)
+			throw std::runtime_error("CWorldEntity has no frame components allocator!");
+
+		void* const memory{ _frameComponentsAllocator->Allocate(sizeof(Component_T), alignof(Component_T)) };
+		// The arena owns the memory, a throwing constructor leaves nothing to release
+		return CComponentHandle<Component_T>(std::launder(new(memory) Component_T(std::forward<Args>(args)...)), _frameComponentsAllocator);
+	};
+
+	/**
+	 * /brief For the relocating constructors, moves a component of the object being relocated to this object.
+	 * Archetype components are move constructed in the same slot and must be nothrow move constructible, the others keep their memory.
+	 */
+	template<typename T>
+	CComponentHandle<T> RelocateComponent(CComponentHandle<T>&& handle, CWorldObject& other) {
+		using Component_T = std::remove_cv_t<T>;
+		static_assert(std::is_nothrow_move_constructible_v<Component_T>, "Relocated components must be nothrow move constructible!");
+
+		// Empty handles and frame components don't belong to the object
+		if (handle.GetOwner() != static_cast<IComponentOwner*>(&other))
+			return std::move(handle);
+
+		Component_T* const component{ const_cast<Component_T*>(handle.Release()) };
+		const uint64_t slot{ other.GetArchetypeSlot(&other, component) };
+		// The runtime components allocator is shared by the objects of the world
+		if (slot == MAX_ARCHETYPE_COMPONENTS)
+			return CComponentHandle<T>(component, this);
+
+		Component_T* const relocated{ std::launder(new(ClaimArchetypeSlot(this, slot)) Component_T(std::move(*component))) };
+		component->~Component_T();
+		other.FreeComponent(&other, component);
+		return CComponentHandle<T>(relocated, this);
+	}
 
-		return std::shared_ptr<std::decay_t<T>>(componentPtr, [this](T* ptr) {
-			/*Free from reserved pool*/
-			_runtimeComponentsAllocator->Free(reinterpret_cast<void*>(ptr));
-			});
+	/**
+	 * /brief Shared ownership adapter of NewComponent, allocates a control block.
+	 */
+	template<typename T, typename... Args>
+	std::shared_ptr<std::decay_t<T>> NewSharedComponent(Args&&... args) {
+		return NewComponent<T>(std::forward<Args>(args)...).ToShared();
 	};
 
 private:
+	const IWorldObjectCDO* const _staticClassCdo;
 	IAlignedAllocator* const _runtimeComponentsAllocator;
+	CFrameArenaAllocator* const _frameComponentsAllocator;
+	/**
+	 * /brief Set only on the CDO.
+	 */
+	std::unique_ptr<CWorldObjectCDO> _cdoLayout;
+	CTagSet _tags;
+	/**
+	 * /brief The owning world, set after construction.
+	 */
+	IWorldObjectObserver* _observer{};
+	DGenerationalId _handle;
+	const uint32_t _staticClassId;
+	uint64_t _changedComponents{};
+	/**
+	 * /brief Position in the world list of the objects of its class.
+	 */
+	uint32_t _classSlot{ UINT32_MAX };
+	CStatCounter _numOfRuntimeComponents;
+
+	inline const IWorldObjectCDO& _getClassLayout()const {
+		return _cdoLayout ? *_cdoLayout : *_staticClassCdo;
+	}
+
+	void ReleaseComponent(void* ptr) override {
+		if (IsCDO())
+		{
+			CHeapAlignedAllocator().Free(ptr);
+		}
+		else if (IsArchetypeComponent(this, ptr))
+		{
+			FreeComponent(this, ptr);
+		}
+		else
+		{
+			_runtimeComponentsAllocator->Free(ptr);
+		}
+	}
+
+	void OnComponentChanged(void* ptr) override {
+		if (!IsCDO())
+			MarkComponentsChanged(GetComponentChangedBit(ptr));
+	}
+
+	template<typename Component_T, typename... Args>
+	CComponentHandle<Component_T> _constructComponent(void* memory, Args&&... args) {
+		Component_T* componentPtr{};
+		try
+		{
+			// Always alias using placement new, otherwise dynamic type is undefined leading to UB.
+			componentPtr = std::launder(new(memory) Component_T(std::forward<Args>(args)...));
+		}
+		catch (...)
+		{
+			ReleaseComponent(memory);
+			throw;
+		}
+		return CComponentHandle<Component_T>(componentPtr, this);
+	}
 };
\ No newline at end of file
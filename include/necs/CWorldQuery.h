@@ -0,0 +1,186 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CWorldQuery.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "necs/IEntityFactory.h"
+#include "necs/CWorldObject.h"
+#include "necs/CTypeIndex.h"
+
+struct DWorldQueryCategory;
+
+/**
+ * /brief Dense index of the query signatures, a world keeps one cache per signature.
+ */
+using CWorldQueryIndex = CTypeIndex<DWorldQueryCategory>;
+
+/**
+ * /brief The classes whose archetype holds every component type of a query, with the slot of each component.
+ * Class signatures never change once registered, a class is matched once and only classes registered since the last update are visited.
+ */
+class CWorldQueryCache final
+{
+public:
+	explicit CWorldQueryCache(std::vector<uint32_t> typeIndices) : _typeIndices(std::move(typeIndices)) {}
+
+	struct DMatch
+	{
+		uint32_t ClassId;
+		/**
+		 * /brief Bits of the archetype slots of the query components, all of them must be constructed.
+		 */
+		uint64_t RequiredSlots;
+	};
+
+	/**
+	 * /brief Matches the classes registered since the last update.
+	 */
+	void Update(const IEntityFactory& entityFactory) {
+		const uint32_t end{ entityFactory.GetClassIdsEnd() };
+		for (; _numOfClassesVisited < end; _numOfClassesVisited++)
+		{
+			if (entityFactory.IsClassRegistered(_numOfClassesVisited))
+				_match(_numOfClassesVisited, entityFactory.GetCDOFromClassId(_numOfClassesVisited).GetCDOComponentsInfo());
+		}
+	}
+
+	inline const std::vector<DMatch>& GetMatches() const { return _matches; }
+
+	/**
+	 * /brief Offsets of the query components from the start of the object, in the query order.
+	 */
+	inline const uint64_t* GetOffsets(const uint64_t matchIndex) const { return _offsets.data() + matchIndex * _typeIndices.size(); }
+
+private:
+	const std::vector<uint32_t> _typeIndices;
+	uint32_t _numOfClassesVisited{};
+	std::vector<DMatch> _matches;
+	std::vector<uint64_t> _offsets;
+
+	void _match(const uint32_t classId, const std::vector<CEntityComponentMetadata>& components) {
+		const uint64_t numOfSlots{ std::min<uint64_t>(components.size(), MAX_ARCHETYPE_COMPONENTS) };
+
+		uint64_t requiredSlots{};
+		const uint64_t firstOffset{ _offsets.size() };
+		for (const uint32_t typeIndex : _typeIndices)
+		{
+			// The first archetype component of the type, components past the archetype can't be located
+			uint64_t slot{};
+			while (slot < numOfSlots && components[slot].TypeIndex != typeIndex)
+			{
+				slot++;
+			}
+
+			if (slot == numOfSlots)
+			{
+				_offsets.resize(firstOffset);
+				return;
+			}
+
+			requiredSlots |= uint64_t{ 1 } << slot;
+			_offsets.push_back(components[slot].Offset);
+		}
+
+		_matches.push_back(DMatch{ classId, requiredSlots });
+	}
+};
+
+/**
+ * /brief View of the objects holding every component of Components_T in their archetype, obtained from CWorld::Query.
+ * Iterates the matching classes one after the other, each object list linearly with the component offsets fixed per class.
+ * Objects whose query components aren't all constructed are skipped. Invalidated by spawning or destroying objects.
+ */
+template<typename... Components_T>
+class CWorldQuery final
+{
+	static_assert(sizeof...(Components_T) > 0, "Query at least one component");
+public:
+	CWorldQuery(const CWorldQueryCache& cache, const std::vector<std::vector<CWorldObject*>>& classObjects) : _cache(cache), _classObjects(classObjects) {}
+
+	/**
+	 * /brief Calls fn(CWorldObject&, Components_T&...) for every matching object.
+	 */
+	template<typename Fn_T>
+	void ForEach(Fn_T&& fn) const {
+		_forEach(fn, std::index_sequence_for<Components_T...>{});
+	}
+
+	/**
+	 * /brief Number of objects of the matching classes, counting those with query components not constructed.
+	 */
+	uint64_t GetNumOfCandidates() const {
+		uint64_t count{};
+		for (const auto& match : _cache.GetMatches())
+		{
+			count += match.ClassId < _classObjects.size() ? _classObjects[match.ClassId].size() : 0;
+		}
+		return count;
+	}
+
+	inline uint64_t GetNumOfMatchedClasses() const { return _cache.GetMatches().size(); }
+
+private:
+	const CWorldQueryCache& _cache;
+	const std::vector<std::vector<CWorldObject*>>& _classObjects;
+
+	template<typename Fn_T, size_t... I>
+	void _forEach(Fn_T& fn, std::index_sequence<I...>) const {
+		const auto& matches{ _cache.GetMatches() };
+		for (uint64_t m{}; m < matches.size(); m++)
+		{
+			const auto& match{ matches[m] };
+			if (match.ClassId >= _classObjects.size())
+				continue;
+
+			const uint64_t* const offsets{ _cache.GetOffsets(m) };
+			const std::array<uint64_t, sizeof...(Components_T)> classOffsets{ offsets[I]... };
+			for (CWorldObject* const object : _classObjects[match.ClassId])
+			{
+				if ((object->GetConstructedArchetypeSlots() & match.RequiredSlots) != match.RequiredSlots)
+					continue;
+
+				uint8_t* const base{ reinterpret_cast<uint8_t*>(object) };
+				fn(*object, *std::launder(reinterpret_cast<Components_T*>(base + classOffsets[I]))...);
+			}
+		}
+	}
+};
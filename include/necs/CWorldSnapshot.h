@@ -0,0 +1,71 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CWorldSnapshot.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class CWorld;
+
+/**
+ * /brief Saves the world objects to a binary memory image and restores them, for quick saves and rollback.
+ * The image holds the handle table, then per class the handles and the raw archetype components block of each object, copied with one memcpy per object.
+ * Restoring constructs every object with its regular constructor, which re-establishes vtables, allocators and pointers, then copies the saved blocks over the fresh components.
+ * Handles are restored too, handles taken before the save resolve to the restored objects and no pointer needs relocation.
+ * Only archetype components are saved and they must be trivially copyable, state kept in the object itself or in runtime components is rebuilt by the constructor.
+ * Objects must hold every archetype component of their class, the constructor would bring back a reset one.
+ * Components should refer to other objects by handle, raw pointers are copied as they are.
+ * Constructors run while restoring must not spawn objects. The pending destroy queue and the frame components are not part of the image.
+ * Images are native endian and tied to the class layouts of the build that saved them.
+ */
+class CWorldSnapshot final
+{
+public:
+	/**
+	 * /brief Replaces the content of image. Throws runtime_error if a class has an archetype component not trivially copyable or an object reset one of its archetype components.
+	 */
+	static void Save(const CWorld& world, std::vector<uint8_t>& image);
+
+	/**
+	 * /brief The image is validated before the world is touched, a corrupted or incompatible image throws runtime_error and leaves the world untouched.
+	 * If a constructor throws while rebuilding, the exception is rethrown and the world is left empty.
+	 */
+	static void Restore(CWorld& world, const uint8_t* const image, const uint64_t bytes);
+	static inline void Restore(CWorld& world, const std::vector<uint8_t>& image) { Restore(world, image.data(), image.size()); }
+
+	static constexpr uint32_t MAGIC{ 0x5053434E }; // "NCSP"
+	static constexpr uint32_t VERSION{ 1 };
+};
@@ -0,0 +1,139 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: DTickSettings.h
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "necs/CTypeIndex.h"
+
+/**
+ * /brief Tick phases, each group completes before the next one starts.
+ */
+enum class ETickGroup : uint8_t
+{
+	PrePhysics,
+	Physics,
+	PostPhysics,
+	Count
+};
+
+/**
+ * /brief Per class tick declaration, a class overrides it by hiding CWorldObject::GetStaticTickSettings.
+ * By default a class is exclusive: its bucket ticks alone on a single thread, which is always safe.
+ * Declaring the component access opts the class into concurrent ticking, the instances of the class
+ * then tick in parallel chunks and its bucket shares a wave with every bucket it does not conflict with.
+ */
+struct DTickSettings final
+{
+	ETickGroup Group{ ETickGroup::PrePhysics };
+
+	/**
+	 * /brief Component type indices read and written by the tick of the class, see CComponentTypeIndex.
+	 */
+	std::vector<uint32_t> Reads;
+	std::vector<uint32_t> Writes;
+
+	/**
+	 * /brief True when no access was declared.
+	 */
+	bool Exclusive{ true };
+
+	/**
+	 * /brief False when instances of the class touch shared state of the written types and must tick one after the other.
+	 */
+	bool ParallelInstances{ true };
+
+	DTickSettings() = default;
+	DTickSettings(const ETickGroup group) : Group(group) {}
+
+	template<typename... Components>
+	DTickSettings& Reading()
+	{
+		(Reads.push_back(CComponentTypeIndex::Of<Components>()), ...);
+		Exclusive = false;
+		return *this;
+	}
+
+	template<typename... Components>
+	DTickSettings& Writing()
+	{
+		(Writes.push_back(CComponentTypeIndex::Of<Components>()), ...);
+		Exclusive = false;
+		return *this;
+	}
+
+	/**
+	 * /brief True if the two classes can not tick concurrently.
+	 */
+	bool ConflictsWith(const DTickSettings& other) const
+	{
+		if (Exclusive || other.Exclusive)
+		{
+			return true;
+		}
+
+		for (const auto write : Writes)
+		{
+			for (const auto otherWrite : other.Writes)
+			{
+				if (write == otherWrite)
+				{
+					return true;
+				}
+			}
+			for (const auto otherRead : other.Reads)
+			{
+				if (write == otherRead)
+				{
+					return true;
+				}
+			}
+		}
+
+		for (const auto read : Reads)
+		{
+			for (const auto otherWrite : other.Writes)
+			{
+				if (read == otherWrite)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+};
@@ -35,6 +35,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 /**
  * /brief Size unbound aligned allocator interface.
  */
@@ -47,4 +49,9 @@ public:
 
 	virtual void* Allocate(const uint64_t bytes, const uint64_t alignement) = 0;
 	virtual void Free(void* ptr) = 0;
+
+	/**
+	 * /brief Sizes are served without waste when multiple of it, callers sizing large buffers should round up to it.
+	 */
+	virtual uint64_t GetAllocationGranularity() const { return 1; }
 };
\ No newline at end of file
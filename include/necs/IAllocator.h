@@ -35,6 +35,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 /**
  * /brief Size unbound allocator interface.
  */
@@ -47,4 +49,10 @@ public:
 
 	virtual void* Allocate(uint64_t bytes) = 0;
 	virtual void Free(void* ptr) = 0;
+	/**
+	 * /brief Allocates count blocks of the same size in one pass.
+	 * /param out Must hold at least count pointers.
+	 */
+	virtual void AllocateBatch(const uint64_t bytes, const uint64_t count, void** const out) = 0;
+	virtual void FreeBatch(void* const* const ptrs, const uint64_t count) = 0;
 };
\ No newline at end of file
@@ -35,12 +35,73 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
+#include <type_traits>
 
 #include "necs/IWorldObjectCDO.h"
+#include "necs/DTickSettings.h"
+#include "necs/CTypeIndex.h"
 
 class CWorldObject;
 class CWorld;
+class IAlignedAllocator;
+class CFrameArenaAllocator;
+struct IWorldObjectPendingDestroyNotifier;
+struct DWorldObjectInitializer;
+
+/**
+ * /brief Ticks a bucket of objects of the same concrete class without virtual dispatch.
+ */
+using WorldObjectTickBucketFunc = void(*)(CWorldObject* const* const objects, const uint64_t count);
+
+/**
+ * /brief Moves the object into memory through the relocating constructor of its class.
+ */
+using WorldObjectRelocateFunc = CWorldObject* (*)(void* memory, const DWorldObjectInitializer& initializer, CWorldObject& object);
+
+struct DWorldObjectClassCategory;
+
+/**
+ * /brief Dense process wide world object class ids, indexing the factory registry directly.
+ */
+using CWorldObjectClassIndex = CTypeIndex<DWorldObjectClassCategory>;
+
+template<typename T>
+inline uint32_t GetClassId()
+{
+	return CWorldObjectClassIndex::Of<std::decay_t<T>>();
+}
+
+/**
+ * /brief Per class data read when spawning and destroying, plain function pointers packed in one cache line.
+ */
+struct alignas(64) DEntityClassDescriptor final
+{
+	using ConstructFunc = CWorldObject* (*)(void* memory, const DWorldObjectInitializer& initializer);
+	using CloneFunc = CWorldObject* (*)(void* memory, const DWorldObjectInitializer& initializer, const CWorldObject& prototype);
+	using DestroyFunc = void(*)(CWorldObject* const object);
+
+	ConstructFunc Construct{};
+	/**
+	 * /brief Set when the class has a prototype constructor T(const DWorldObjectInitializer&, const T&).
+	 */
+	CloneFunc Clone{};
+	DestroyFunc Destroy{};
+	WorldObjectTickBucketFunc TickBucket{};
+	/**
+	 * /brief The CDO holds the components layout.
+	 */
+	const CWorldObject* CDO{};
+	uint32_t Size{};
+	uint32_t Alignment{};
+	/**
+	 * /brief Class size plus the archetype components memory.
+	 */
+	uint64_t AllocationSize{};
+	uint32_t ClassId{ UINT32_MAX };
+};
+static_assert(sizeof(DEntityClassDescriptor) == 64);
 
 /**
  * /brief Handles entity allocations by class name.
@@ -50,10 +111,60 @@ public:
 	virtual ~IEntityFactory() = default;
 
 	// Create an instance based on the type name
+	/**
+	 * /param runtimeComponentsAllocator Serves the components that don't fit in the archetype memory of the object.
+	 * /param frameComponentsAllocator Serves the components created with NewFrameComponent.
+	 */
 	virtual CWorldObject* PlacementNewFromTypename(void* memory,
-		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const std::string& typeName) = 0;
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const std::string& typeName, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) = 0;
 
 	virtual const IWorldObjectCDO& GetCDOFromTypename(const std::string& typeName) const = 0;
+
+	/**
+	 * /brief Class id based variants, resolve the class with a single array index.
+	 */
+	virtual CWorldObject* PlacementNewFromClassId(void* memory,
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const uint32_t classId, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) = 0;
+	virtual const IWorldObjectCDO& GetCDOFromClassId(const uint32_t classId) const = 0;
+
+	/**
+	 * /brief Constructs a copy of the prototype through its class prototype constructor instead of the regular construction.
+	 * The class of the prototype must provide one, see DEntityClassDescriptor::Clone.
+	 */
+	virtual CWorldObject* PlacementCloneFromPrototype(void* memory,
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, const CWorldObject& prototype, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) = 0;
+	/**
+	 * /brief Constructs the object again in memory through its class relocating constructor, leaving it moved from for the caller to destroy.
+	 * The class must provide one, see IsClassRelocatable.
+	 */
+	virtual CWorldObject* PlacementRelocate(void* memory,
+		IWorldObjectPendingDestroyNotifier* const pendingDestroyNotifier, CWorldObject& object, IAlignedAllocator* const runtimeComponentsAllocator = nullptr, CFrameArenaAllocator* const frameComponentsAllocator = nullptr) = 0;
+	/**
+	 * /brief True when the class has a noexcept relocating constructor T(const DWorldObjectRelocation&, T&&).
+	 */
+	virtual bool IsClassRelocatable(const uint32_t classId) const = 0;
+	virtual uint32_t GetClassIdFromTypename(const std::string& typeName) const = 0;
+	/**
+	 * /brief Returns UINT32_MAX when the name isn't registered.
+	 */
+	virtual uint32_t FindClassIdFromTypename(const std::string& typeName) const = 0;
+	virtual const std::string& GetClassTypename(const uint32_t classId) const = 0;
+	virtual const DEntityClassDescriptor& GetClassDescriptor(const uint32_t classId) const = 0;
+	virtual bool IsClassRegistered(const uint32_t classId) const = 0;
+	/**
+	 * /brief Every registered class id is below it.
+	 */
+	virtual uint32_t GetClassIdsEnd() const = 0;
+
+	/**
+	 * /brief Returns the bucket tick function of the class owning the CDO.
+	 */
+	virtual WorldObjectTickBucketFunc GetTickBucketFunc(const IWorldObjectCDO& classCdo) const = 0;
+
+	/**
+	 * /brief Returns the tick group and component access declared by the class owning the CDO.
+	 */
+	virtual const DTickSettings& GetTickSettings(const IWorldObjectCDO& classCdo) const = 0;
 };
 
 /**
@@ -68,5 +179,36 @@ struct IWorldObjectManager
 		return reinterpret_cast<T*>(SpawnWorldObject(typeName));
 	}
 
+	/**
+	 * /brief Spawns without hashing the class name.
+	 */
+	template<typename T> T* SpawnWorldObject() {
+		static_assert(std::is_base_of<CWorldObject, T>::value, "Must derived from CWorldObject");
+		return static_cast<T*>(SpawnWorldObject(GetClassId<T>()));
+	}
+
+	/**
+	 * /brief Typed bulk spawn, see SpawnWorldObjects.
+	 */
+	template<typename T> void SpawnWorldObjects(const uint64_t count, T** const out, const std::function<void(T* object, uint64_t index)>& init = {}, const T* const prototype = nullptr) {
+		static_assert(std::is_base_of<CWorldObject, T>::value, "Must derived from CWorldObject");
+		SpawnWorldObjects(GetClassId<T>(), count, nullptr, [out, &init](CWorldObject* object, uint64_t index) {
+			T* const typed{ static_cast<T*>(object) };
+			if (out)
+				out[index] = typed;
+			if (init)
+				init(typed, index);
+			}, prototype);
+	}
+
 	virtual CWorldObject* SpawnWorldObject(const std::string& typeName) = 0;
+	virtual CWorldObject* SpawnWorldObject(const uint32_t classId) = 0;
+
+	/**
+	 * /brief Spawns count objects of the class at once, their memory is allocated in contiguous runs.
+	 * /param out Optional, receives the objects.
+	 * /param init Optional, called on every object in order once all of them are spawned.
+	 * /param prototype Optional, objects are copies of it made by the class prototype constructor instead of the regular construction.
+	 */
+	virtual void SpawnWorldObjects(const uint32_t classId, const uint64_t count, CWorldObject** const out, const std::function<void(CWorldObject* object, uint64_t index)>& init = {}, const CWorldObject* const prototype = nullptr) = 0;
 };
@@ -35,8 +35,11 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <set>
 #include <queue>
+#include <vector>
+#include <limits>
 #include <stdexcept>
 
 template<typename ID_T>
@@ -100,4 +103,122 @@ public:
 	ID_T GetMaxId()const override {
 		return next_id;
 	}
-};
\ No newline at end of file
+};
+
+/**
+ * /brief Slot index plus the generation of the slot when the id was generated, a released slot bumps its generation so stale ids never alias.
+ */
+struct DGenerationalId final
+{
+	static constexpr uint32_t INVALID_INDEX{ UINT32_MAX };
+
+	uint32_t Index{ INVALID_INDEX };
+	uint32_t Generation{};
+
+	inline bool IsValid() const { return Index != INVALID_INDEX; }
+	inline bool operator==(const DGenerationalId& other) const { return Index == other.Index && Generation == other.Generation; }
+	inline bool operator!=(const DGenerationalId& other) const { return !(*this == other); }
+};
+
+/**
+ * /brief O(1) generational id generator, slots are a dense array and released slots form an intrusive free list.
+ * No allocation per id, the slot array only grows when every slot is in use.
+ */
+class CGenerationalIdGenerator final : public IIdGenerator<DGenerationalId> {
+public:
+	explicit CGenerationalIdGenerator(const uint32_t maxNumOfSlots = DGenerationalId::INVALID_INDEX) : _maxNumOfSlots(maxNumOfSlots) {}
+
+	DGenerationalId Generate() override {
+		uint32_t index{ _freeHead };
+		if (index != FREE_LIST_END)
+		{
+			_freeHead = _slots[index].NextFree;
+		}
+		else
+		{
+			if (_slots.size() >= _maxNumOfSlots) {
+				throw std::runtime_error("ID limit exceeded!");
+			}
+			index = static_cast<uint32_t>(_slots.size());
+			_slots.push_back(DSlot{});
+		}
+
+		_slots[index].NextFree = IN_USE;
+		return DGenerationalId{ index, _slots[index].Generation };
+	}
+
+	void Release(DGenerationalId id) override {
+		if (!IsUsed(id)) {
+			throw std::invalid_argument("ID not currently in use");
+		}
+
+		auto& slot{ _slots[id.Index] };
+		slot.Generation++;
+		slot.NextFree = _freeHead;
+		_freeHead = id.Index;
+	}
+
+	bool IsUsed(DGenerationalId id) const override {
+		return id.Index < _slots.size() && _slots[id.Index].NextFree == IN_USE && _slots[id.Index].Generation == id.Generation;
+	}
+
+	/**
+	 * /brief Returns the number of slots, every index is below it.
+	 */
+	DGenerationalId GetMaxId()const override {
+		return DGenerationalId{ static_cast<uint32_t>(_slots.size()), 0 };
+	}
+
+	static constexpr uint32_t IN_USE{ UINT32_MAX };
+	static constexpr uint32_t FREE_LIST_END{ UINT32_MAX - 1 };
+
+	struct DSlot
+	{
+		uint32_t Generation{};
+		/**
+		 * /brief Next released slot, IN_USE while the slot's id is alive.
+		 */
+		uint32_t NextFree{ IN_USE };
+	};
+
+	/**
+	 * /brief The complete state, restoring it makes the generator hand out the same ids in the same order.
+	 */
+	inline const std::vector<DSlot>& GetSlots() const { return _slots; }
+	inline uint32_t GetFreeHead() const { return _freeHead; }
+
+	/**
+	 * /brief Throws invalid_argument when the free list is malformed, the generator is left untouched.
+	 */
+	void Restore(std::vector<DSlot> slots, const uint32_t freeHead) {
+		if (slots.size() > _maxNumOfSlots) {
+			throw std::invalid_argument("Too many slots");
+		}
+
+		// Every free slot must be reached exactly once from the head
+		uint64_t numOfFree{};
+		for (const auto& slot : slots)
+		{
+			numOfFree += slot.NextFree != IN_USE;
+		}
+
+		uint64_t numOfVisited{};
+		for (uint32_t index{ freeHead }; index != FREE_LIST_END; index = slots[index].NextFree)
+		{
+			if (index >= slots.size() || slots[index].NextFree == IN_USE || ++numOfVisited > numOfFree) {
+				throw std::invalid_argument("Malformed free list");
+			}
+		}
+		if (numOfVisited != numOfFree) {
+			throw std::invalid_argument("Malformed free list");
+		}
+
+		_slots = std::move(slots);
+		_freeHead = freeHead;
+	}
+
+private:
+	const uint32_t _maxNumOfSlots;
+	std::vector<DSlot> _slots;
+	uint32_t _freeHead{ FREE_LIST_END };
+};
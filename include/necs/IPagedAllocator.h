@@ -35,8 +35,27 @@
 
 #pragma once
 
+#include <stdint.h>
+
+class IPagedAllocator;
+
+/**
+ * /brief Observes the slabs lifetime of a paged allocator, used to build address to owner indices.
+ */
+struct IPagedAllocatorSlabListener
+{
+	virtual ~IPagedAllocatorSlabListener() = default;
+
+	/**
+	 * /brief Slabs are aligned and sized to a multiple of the granularity, so that no two slabs share the same granule.
+	 */
+	virtual uint64_t GetSlabGranularity()const = 0;
+	virtual void OnSlabAllocated(IPagedAllocator* const owner, const uint64_t slabIndex, void* const slab, const uint64_t bytes) = 0;
+	virtual void OnSlabReleased(IPagedAllocator* const owner, const uint64_t slabIndex, void* const slab, const uint64_t bytes) = 0;
+};
+
 /**
- * /brief Unlimited fixed size arenas, each arena is a freelist allocator
+ * /brief Unlimited fixed size arenas, each arena is a fixed size block pool
  */
 class IPagedAllocator
 {
@@ -47,6 +66,20 @@ public:
 
 	virtual void* Allocate() = 0;
 	virtual void Free(void* ptr) = 0;
+	/**
+	 * /brief Allocates count blocks in one pass, blocks are carved in contiguous runs whenever possible.
+	 * /param out Must hold at least count pointers.
+	 */
+	virtual void AllocateBatch(const uint64_t count, void** const out) = 0;
+	virtual void FreeBatch(void* const* const ptrs, const uint64_t count) = 0;
+	/**
+	 * /brief Frees a block when the owning slab is already known, skipping the slab search.
+	 */
+	virtual void FreeFromSlab(void* ptr, const uint64_t slabIndex) = 0;
 	virtual uint64_t GetFixedBlockSize()const = 0;
+	/**
+	 * /brief Must be set before the first allocation, the listener must outlive the allocator.
+	 */
+	virtual void SetSlabListener(IPagedAllocatorSlabListener* const listener) = 0;
 };
 
@@ -39,10 +39,29 @@
 #include <vector>
 
 
+/**
+ * /brief Only the first components of a class get a slot in the archetype memory, the others use the runtime components allocator.
+ * One short of 64, the last bit of the changed components mask is left to the runtime components.
+ */
+inline constexpr uint64_t MAX_ARCHETYPE_COMPONENTS{ 63 };
+inline constexpr uint64_t NO_ARCHETYPE_OFFSET{ UINT64_MAX };
+
 struct CEntityComponentMetadata final
 {
 	const uint64_t Size;
 	const uint64_t Alignment;
+	/**
+	 * /brief Byte offset of the component from the start of the object, NO_ARCHETYPE_OFFSET if it has no archetype slot.
+	 */
+	const uint64_t Offset{ NO_ARCHETYPE_OFFSET };
+	/**
+	 * /brief Known when registered with the component type, trivially copyable components can be saved as raw bytes.
+	 */
+	const bool TriviallyCopyable{};
+	/**
+	 * /brief CComponentTypeIndex of the component, UINT32_MAX when registered without its type.
+	 */
+	const uint32_t TypeIndex{ UINT32_MAX };
 };
 
 /**
@@ -54,5 +73,8 @@ public:
 	virtual const std::vector<CEntityComponentMetadata>& GetCDOComponentsInfo()const = 0;
 	virtual uint64_t GetClassSize()const = 0;
 	virtual uint64_t GetClassAlignment()const = 0;
+	/**
+	 * /brief Exact bytes the archetype components occupy after the class, the layout is fixed at registration.
+	 */
 	virtual uint64_t ComputeComponentsMaxSizeForAllocation()const = 0;
 };
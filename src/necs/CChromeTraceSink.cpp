@@ -0,0 +1,115 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CChromeTraceSink.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CChromeTraceSink.h"
+
+#include <atomic>
+
+namespace
+{
+	// Small stable ids read better in the viewers than hashed thread ids
+	uint32_t GetTraceThreadId()
+	{
+		static std::atomic<uint32_t> nextThreadId{};
+		thread_local const uint32_t threadId{ nextThreadId.fetch_add(1, std::memory_order_relaxed) };
+		return threadId;
+	}
+
+	void WriteEscaped(std::ostream& out, const char* name)
+	{
+		for (; *name; name++)
+		{
+			if (*name == '"' || *name == '\\')
+				out << '\\';
+			out << *name;
+		}
+	}
+}
+
+void CChromeTraceSink::BeginZone(const char* name)
+{
+	_record(name, 'B', 0);
+}
+
+void CChromeTraceSink::EndZone(const char* name)
+{
+	_record(name, 'E', 0);
+}
+
+void CChromeTraceSink::Counter(const char* name, const int64_t value)
+{
+	_record(name, 'C', value);
+}
+
+void CChromeTraceSink::Write(std::ostream& out) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	out << "{\"traceEvents\":[";
+	for (uint64_t i{}; i < _events.size(); i++)
+	{
+		const auto& event{ _events[i] };
+		out << (i ? ",\n" : "\n") << "{\"name\":\"";
+		WriteEscaped(out, event.Name);
+		out << "\",\"ph\":\"" << event.Phase << "\",\"ts\":" << event.Microseconds << ",\"pid\":0,\"tid\":" << event.ThreadId;
+		if (event.Phase == 'C')
+		{
+			out << ",\"args\":{\"value\":" << event.Value << "}";
+		}
+		out << "}";
+	}
+	out << "\n]}\n";
+}
+
+void CChromeTraceSink::Clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_events.clear();
+}
+
+uint64_t CChromeTraceSink::GetNumOfEvents() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _events.size();
+}
+
+void CChromeTraceSink::_record(const char* const name, const char phase, const int64_t value)
+{
+	const auto microseconds{ std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count() };
+	const uint32_t threadId{ GetTraceThreadId() };
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_events.push_back(DEvent{ name, phase, threadId, static_cast<int64_t>(microseconds), value });
+}
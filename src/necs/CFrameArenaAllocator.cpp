@@ -0,0 +1,109 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CFrameArenaAllocator.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CFrameArenaAllocator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <assert.h>
+
+CFrameArenaAllocator::CFrameArenaAllocator(const uint64_t chunkSize, IAlignedAllocator* const backingAllocator) : _chunkSize(chunkSize), _backingAllocator(backingAllocator ? *backingAllocator : _heapAllocator)
+{
+	assert(chunkSize > 0);
+}
+
+CFrameArenaAllocator::~CFrameArenaAllocator()
+{
+	for (auto& frame : _frames)
+	{
+		for (auto& chunk : frame.Chunks)
+		{
+			_backingAllocator.Free(chunk->Memory);
+		}
+	}
+}
+
+void CFrameArenaAllocator::SwapFrames()
+{
+	std::lock_guard<std::mutex> lock(_chunksMutex);
+	_currentFrame ^= 1;
+
+	auto& frame{ _frames[_currentFrame] };
+	for (uint64_t i{}; i < frame.NumOfUsedChunks; i++)
+	{
+		frame.Chunks[i]->Cursor.store(0, std::memory_order_relaxed);
+	}
+
+	frame.NumOfUsedChunks = frame.Chunks.empty() ? 0 : 1;
+	_current.store(frame.Chunks.empty() ? nullptr : frame.Chunks.front().get(), std::memory_order_release);
+}
+
+void CFrameArenaAllocator::_nextChunk(DChunk* const full, const uint64_t bytes, const uint64_t alignement)
+{
+	std::lock_guard<std::mutex> lock(_chunksMutex);
+	if (_current.load(std::memory_order_relaxed) != full)
+	{
+		return;
+	}
+
+	auto& frame{ _frames[_currentFrame] };
+	const uint64_t required{ bytes + alignement - 1 };
+
+	// Reuse a chunk kept from an earlier frame when it is large enough, swapping it in place keeps the used ones at the front
+	for (uint64_t i{ frame.NumOfUsedChunks }; i < frame.Chunks.size(); i++)
+	{
+		if (frame.Chunks[i]->Size >= required)
+		{
+			std::swap(frame.Chunks[i], frame.Chunks[frame.NumOfUsedChunks]);
+			_current.store(frame.Chunks[frame.NumOfUsedChunks++].get(), std::memory_order_release);
+			return;
+		}
+	}
+
+	const uint64_t size{ std::max(_chunkSize, required) };
+	uint8_t* const memory{ static_cast<uint8_t*>(_backingAllocator.Allocate(size, alignof(std::max_align_t))) };
+	if (!memory)
+		throw std::bad_alloc{};
+
+	auto chunk{ std::make_unique<DChunk>() };
+	chunk->Memory = memory;
+	chunk->Size = size;
+	_reservedBytes += size;
+
+	frame.Chunks.push_back(std::move(chunk));
+	std::swap(frame.Chunks.back(), frame.Chunks[frame.NumOfUsedChunks]);
+	_current.store(frame.Chunks[frame.NumOfUsedChunks++].get(), std::memory_order_release);
+}
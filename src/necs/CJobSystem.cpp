@@ -0,0 +1,226 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CJobSystem.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CJobSystem.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace
+{
+	struct DJobThreadContext
+	{
+		const CJobSystem* System{};
+		uint32_t QueueIndex{};
+	};
+
+	thread_local DJobThreadContext t_jobThreadContext;
+}
+
+CJobSystem::CJobSystem(const uint32_t numOfWorkers)
+{
+	_queues.reserve(numOfWorkers + 1);
+	for (uint32_t i{}; i < numOfWorkers + 1; i++)
+	{
+		_queues.push_back(std::make_unique<DJobQueue>());
+	}
+
+	_workers.reserve(numOfWorkers);
+	for (uint32_t i{}; i < numOfWorkers; i++)
+	{
+		_workers.emplace_back(&CJobSystem::_workerLoop, this, i + 1);
+	}
+}
+
+CJobSystem::~CJobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_running.store(false, std::memory_order_release);
+	}
+	_wakeUp.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		worker.join();
+	}
+
+	assert(_numOfQueuedJobs.load() == 0 && "Jobs were scheduled but never waited for");
+}
+
+uint32_t CJobSystem::GetDefaultNumOfWorkers()
+{
+	const auto hardwareThreads{ std::thread::hardware_concurrency() };
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+void CJobSystem::Schedule(Job job, CJobCounter& counter)
+{
+	assert(job);
+
+	counter._pending.fetch_add(1, std::memory_order_relaxed);
+
+	// Counted before it is visible so a thief never decrements below zero
+	_numOfQueuedJobs.fetch_add(1, std::memory_order_release);
+
+	auto& queue{ *_queues[_getQueueIndexOfCallingThread()] };
+	{
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		queue.Jobs.push_back(DJob{ std::move(job), &counter });
+	}
+
+	if (!_workers.empty())
+	{
+		// Taking the lock orders the notification after a worker checked the predicate
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+		}
+		_wakeUp.notify_one();
+	}
+}
+
+void CJobSystem::Wait(const CJobCounter& counter)
+{
+	const auto queueIndex{ _getQueueIndexOfCallingThread() };
+	while (!counter.IsDone())
+	{
+		if (!_tryRunOne(queueIndex))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void CJobSystem::ParallelFor(const uint64_t count, const uint64_t grainSize, const std::function<void(uint64_t begin, uint64_t end)>& fn)
+{
+	assert(grainSize > 0);
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (count <= grainSize || _workers.empty())
+	{
+		fn(0, count);
+		return;
+	}
+
+	CJobCounter counter;
+	for (uint64_t begin{}; begin < count; begin += grainSize)
+	{
+		const auto end{ std::min(begin + grainSize, count) };
+		Schedule([&fn, begin, end]() { fn(begin, end); }, counter);
+	}
+	Wait(counter);
+}
+
+uint32_t CJobSystem::_getQueueIndexOfCallingThread() const
+{
+	return t_jobThreadContext.System == this ? t_jobThreadContext.QueueIndex : 0;
+}
+
+bool CJobSystem::_tryRunOne(const uint32_t queueIndex)
+{
+	DJob job;
+	if (!_tryPop(queueIndex, job) && !_trySteal(queueIndex, job))
+	{
+		return false;
+	}
+
+	_numOfQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	job.Fn();
+	job.Counter->_pending.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+bool CJobSystem::_tryPop(const uint32_t queueIndex, DJob& job)
+{
+	auto& queue{ *_queues[queueIndex] };
+	std::lock_guard<std::mutex> lock(queue.Mutex);
+	if (queue.Jobs.empty())
+	{
+		return false;
+	}
+
+	// Newest first, its data is most likely still in cache
+	job = std::move(queue.Jobs.back());
+	queue.Jobs.pop_back();
+	return true;
+}
+
+bool CJobSystem::_trySteal(const uint32_t thiefQueueIndex, DJob& job)
+{
+	const auto numOfQueues{ static_cast<uint32_t>(_queues.size()) };
+	for (uint32_t i{ 1 }; i < numOfQueues; i++)
+	{
+		auto& queue{ *_queues[(thiefQueueIndex + i) % numOfQueues] };
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Jobs.empty())
+		{
+			// Oldest first, it is usually the largest remaining chunk
+			job = std::move(queue.Jobs.front());
+			queue.Jobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void CJobSystem::_workerLoop(const uint32_t queueIndex)
+{
+	t_jobThreadContext.System = this;
+	t_jobThreadContext.QueueIndex = queueIndex;
+
+	while (true)
+	{
+		if (_tryRunOne(queueIndex))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wakeUp.wait(lock, [this]() {
+			return !_running.load(std::memory_order_acquire) || _numOfQueuedJobs.load(std::memory_order_acquire) > 0;
+			});
+
+		if (!_running.load(std::memory_order_acquire))
+		{
+			break;
+		}
+	}
+
+	t_jobThreadContext = {};
+}
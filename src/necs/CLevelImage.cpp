@@ -0,0 +1,246 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CLevelImage.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CLevelImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <assert.h>
+
+#include "necs/CBinaryImage.h"
+#include "necs/CMappedFile.h"
+#include "necs/CWorld.h"
+
+namespace
+{
+	struct DLevelHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t NumOfTags;
+		uint32_t NumOfClasses;
+	};
+
+	/**
+	 * /brief A validated class record, the arrays point into the image.
+	 */
+	struct DClassImage
+	{
+		uint32_t ClassId;
+		uint64_t BlockOffset;
+		uint64_t BlockBytes;
+		uint64_t Count;
+		const uint8_t* Blocks;
+		const uint8_t* TagCounts;
+		const uint8_t* Tags;
+	};
+}
+
+void CLevelImage::Bake(const IEntityFactory& entityFactory, const CWorldObject* const* const objects, const uint64_t count, std::vector<uint8_t>& image)
+{
+	image.clear();
+	CBinaryImageWriter writer(image);
+
+	std::vector<const CWorldObject*> sorted(objects, objects + count);
+	std::stable_sort(sorted.begin(), sorted.end(), [](const CWorldObject* const a, const CWorldObject* const b) { return a->GetStaticClassId() < b->GetStaticClassId(); });
+
+	// Tag ids are interned per process, the image carries their names
+	std::vector<uint32_t> tagIds;
+	std::unordered_map<uint32_t, uint32_t> tagToIndex;
+	// Pairs of first object and end of each class
+	std::vector<std::pair<uint64_t, uint64_t>> classes;
+	for (uint64_t i{}; i < sorted.size(); i++)
+	{
+		assert(sorted[i] && !sorted[i]->IsCDO() && "CDOs can't be baked");
+		if (!HoldsEveryArchetypeComponent(sorted[i]->GetConstructedArchetypeSlots()))
+			throw std::runtime_error("Baking an object with reset archetype components!");
+		if (i == 0 || sorted[i]->GetStaticClassId() != sorted[i - 1]->GetStaticClassId())
+			classes.emplace_back(i, i);
+		classes.back().second = i + 1;
+
+		for (const auto tagId : sorted[i]->GetTags())
+		{
+			if (tagToIndex.emplace(tagId, static_cast<uint32_t>(tagIds.size())).second)
+				tagIds.push_back(tagId);
+		}
+	}
+
+	const DLevelHeader header{ MAGIC, VERSION, static_cast<uint32_t>(tagIds.size()), static_cast<uint32_t>(classes.size()) };
+	writer.AppendValue(header);
+	for (const auto tagId : tagIds)
+	{
+		writer.AppendString(CTagRegistry::GetName(tagId));
+	}
+
+	// The class table comes first, instantiating resolves every class before reading any object
+	std::vector<uint64_t> blockOffsets, blockBytes;
+	for (const auto& [begin, end] : classes)
+	{
+		const uint32_t classId{ sorted[begin]->GetStaticClassId() };
+		uint64_t offset, bytes;
+		if (!GetArchetypeComponentsBlock(entityFactory.GetCDOFromClassId(classId), offset, bytes))
+			throw std::runtime_error("Baking a class with archetype components not trivially copyable!");
+
+		writer.AppendString(entityFactory.GetClassTypename(classId));
+		writer.AppendValue(offset);
+		writer.AppendValue(bytes);
+		writer.AppendValue(end - begin);
+		blockOffsets.push_back(offset);
+		blockBytes.push_back(bytes);
+	}
+
+	for (uint64_t c{}; c < classes.size(); c++)
+	{
+		const auto [begin, end] { classes[c] };
+
+		uint8_t* block{ writer.AppendUninitialized((end - begin) * blockBytes[c]) };
+		for (uint64_t i{ begin }; i < end; i++, block += blockBytes[c])
+		{
+			std::memcpy(block, reinterpret_cast<const uint8_t*>(sorted[i]) + blockOffsets[c], blockBytes[c]);
+		}
+
+		for (uint64_t i{ begin }; i < end; i++)
+		{
+			writer.AppendValue(sorted[i]->GetTags().Size());
+		}
+		for (uint64_t i{ begin }; i < end; i++)
+		{
+			for (const auto tagId : sorted[i]->GetTags())
+			{
+				writer.AppendValue(tagToIndex[tagId]);
+			}
+		}
+	}
+}
+
+void CLevelImage::Instantiate(CWorld& world, const CMappedFile& file, std::vector<CWorldObject*>* const spawned)
+{
+	Instantiate(world, file.GetData(), file.GetSize(), spawned);
+}
+
+void CLevelImage::Instantiate(CWorld& world, const uint8_t* const image, const uint64_t bytes, std::vector<CWorldObject*>* const spawned)
+{
+	const IEntityFactory& entityFactory{ world.GetEntityFactory() };
+	CBinaryImageReader reader(image, bytes);
+
+	const auto header{ reader.ReadValue<DLevelHeader>() };
+	if (header.Magic != MAGIC || header.Version != VERSION)
+		throw std::runtime_error("Unknown level format");
+
+	std::vector<uint32_t> tagIds(header.NumOfTags);
+	for (auto& tagId : tagIds)
+	{
+		tagId = CTagRegistry::Intern(reader.ReadString());
+	}
+
+	std::vector<DClassImage> classes(header.NumOfClasses);
+	uint64_t numOfObjects{};
+	for (auto& record : classes)
+	{
+		record.ClassId = entityFactory.FindClassIdFromTypename(reader.ReadString());
+		if (record.ClassId == UINT32_MAX)
+			throw std::runtime_error("Level class not registered");
+
+		record.BlockOffset = reader.ReadValue<uint64_t>();
+		record.BlockBytes = reader.ReadValue<uint64_t>();
+		record.Count = reader.ReadValue<uint64_t>();
+		numOfObjects += record.Count;
+
+		uint64_t blockOffset, blockBytes;
+		if (!GetArchetypeComponentsBlock(entityFactory.GetCDOFromClassId(record.ClassId), blockOffset, blockBytes) || blockOffset != record.BlockOffset || blockBytes != record.BlockBytes)
+			throw std::runtime_error("Level class layout mismatch");
+	}
+
+	for (auto& record : classes)
+	{
+		record.Blocks = reader.ReadArray(record.Count, record.BlockBytes);
+
+		record.TagCounts = reader.ReadArray(record.Count, sizeof(uint32_t));
+		uint64_t numOfTags{};
+		for (uint64_t i{}; i < record.Count; i++)
+		{
+			numOfTags += LoadUnaligned<uint32_t>(record.TagCounts, i);
+		}
+
+		record.Tags = reader.ReadArray(numOfTags, sizeof(uint32_t));
+		for (uint64_t i{}; i < numOfTags; i++)
+		{
+			if (LoadUnaligned<uint32_t>(record.Tags, i) >= tagIds.size())
+				throw std::runtime_error("Corrupted image");
+		}
+	}
+
+	if (!reader.IsAtEnd())
+		throw std::runtime_error("Corrupted image");
+
+	std::vector<CWorldObject*> local;
+	std::vector<CWorldObject*>& objects{ spawned ? *spawned : local };
+	const uint64_t first{ objects.size() };
+	objects.resize(first + numOfObjects);
+
+	uint64_t numOfSpawned{};
+	try
+	{
+		for (const auto& record : classes)
+		{
+			if (record.Count == 0)
+				continue;
+
+			const uint8_t* tag{ record.Tags };
+			world.SpawnWorldObjects(record.ClassId, record.Count, objects.data() + first + numOfSpawned, [&](CWorldObject* const object, const uint64_t i) {
+				// The fresh components are overwritten with the baked ones
+				std::memcpy(reinterpret_cast<uint8_t*>(object) + record.BlockOffset, record.Blocks + i * record.BlockBytes, record.BlockBytes);
+
+				const uint32_t numOfTags{ LoadUnaligned<uint32_t>(record.TagCounts, i) };
+				for (uint32_t t{}; t < numOfTags; t++, tag += sizeof(uint32_t))
+				{
+					object->AddTag(tagIds[LoadUnaligned<uint32_t>(tag, 0)]);
+				}
+				});
+			numOfSpawned += record.Count;
+		}
+	}
+	catch (...)
+	{
+		for (uint64_t i{}; i < numOfSpawned; i++)
+		{
+			objects[first + i]->SetPendingDestroy();
+		}
+		objects.resize(first);
+		throw;
+	}
+}
@@ -0,0 +1,125 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CMappedFile.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CMappedFile.h"
+
+#include <stdexcept>
+
+#if _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if _WIN32
+CMappedFile::CMappedFile(const std::string& path)
+{
+	_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+	{
+		_file = nullptr;
+		throw std::runtime_error("Failed to open " + path);
+	}
+
+	LARGE_INTEGER size{};
+	GetFileSizeEx(_file, &size);
+	_size = static_cast<uint64_t>(size.QuadPart);
+	// Empty files can't be mapped
+	if (_size == 0)
+		return;
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	_data = _mapping ? static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	if (!_data)
+	{
+		if (_mapping)
+			CloseHandle(_mapping);
+		CloseHandle(_file);
+		throw std::runtime_error("Failed to map " + path);
+	}
+}
+
+CMappedFile::~CMappedFile()
+{
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file)
+		CloseHandle(_file);
+}
+#else
+CMappedFile::CMappedFile(const std::string& path)
+{
+	const int file{ open(path.c_str(), O_RDONLY) };
+	if (file < 0)
+		throw std::runtime_error("Failed to open " + path);
+
+	struct stat status {};
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw std::runtime_error("Failed to open " + path);
+	}
+
+	_size = static_cast<uint64_t>(status.st_size);
+	// Empty files can't be mapped
+	if (_size == 0)
+	{
+		close(file);
+		return;
+	}
+
+	// The mapping keeps its own reference to the file
+	void* const data{ mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0) };
+	close(file);
+	if (data == MAP_FAILED)
+		throw std::runtime_error("Failed to map " + path);
+
+	// Objects are instantiated front to back
+	madvise(data, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const uint8_t*>(data);
+}
+
+CMappedFile::~CMappedFile()
+{
+	if (_data)
+		munmap(const_cast<uint8_t*>(_data), _size);
+}
+#endif
@@ -0,0 +1,66 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CStats.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CStats.h"
+
+#include <iomanip>
+
+void DWorldStats::Dump(std::ostream& out) const
+{
+#if !NECS_STATS
+	out << "NECS_STATS is disabled, counters read 0\n";
+#endif
+	out << "Objects: " << NumOfObjects << ", pending destroy: " << NumOfPendingDestroy << ", frame components reserved bytes: " << FrameComponentsReservedBytes << "\n";
+
+	out << "Size classes:\n";
+	for (const auto& sizeClass : SizeClasses)
+	{
+		out << "  " << std::setw(8) << sizeClass.BlockSize << "B"
+			<< " live " << sizeClass.LiveBlocks << " (peak " << sizeClass.HighWaterLiveBlocks << ")"
+			<< " slabs " << sizeClass.Slabs << " (peak " << sizeClass.HighWaterSlabs << ", allocated " << sizeClass.SlabsAllocated << ", released " << sizeClass.SlabsReleased << ")"
+			<< " reserved " << sizeClass.ReservedBytes << "B"
+			<< " fragmentation " << std::fixed << std::setprecision(1) << sizeClass.GetFragmentation() * 100.0 << "%"
+			<< " allocations " << sizeClass.Allocations << " frees " << sizeClass.Frees << "\n";
+	}
+
+	out << "Entity classes:\n";
+	for (const auto& entityClass : Classes)
+	{
+		out << "  " << entityClass.Name << " [" << entityClass.ClassId << "]"
+			<< " objects " << entityClass.Objects << " (peak " << entityClass.HighWaterObjects << ")"
+			<< " spawned " << entityClass.Spawned << " destroyed " << entityClass.Destroyed
+			<< " runtime components " << entityClass.RuntimeComponents << "\n";
+	}
+}
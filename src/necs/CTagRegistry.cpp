@@ -0,0 +1,76 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTagRegistry.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CTagRegistry.h"
+
+#include <assert.h>
+
+CTagRegistry& CTagRegistry::_get()
+{
+	static CTagRegistry registry;
+	return registry;
+}
+
+uint32_t CTagRegistry::Intern(const std::string& name)
+{
+	auto& registry{ _get() };
+	std::lock_guard<std::mutex> lock(registry._mutex);
+
+	const auto it{ registry._nameToId.find(name) };
+	if (it != registry._nameToId.end())
+	{
+		return it->second;
+	}
+
+	const auto tagId{ static_cast<uint32_t>(registry._names.size()) };
+	registry._names.push_back(name);
+	registry._nameToId.emplace(name, tagId);
+	return tagId;
+}
+
+const std::string& CTagRegistry::GetName(const uint32_t tagId)
+{
+	auto& registry{ _get() };
+	std::lock_guard<std::mutex> lock(registry._mutex);
+	assert(tagId < registry._names.size() && "Tag not interned");
+	return registry._names[tagId];
+}
+
+uint32_t CTagRegistry::Count()
+{
+	auto& registry{ _get() };
+	std::lock_guard<std::mutex> lock(registry._mutex);
+	return static_cast<uint32_t>(registry._names.size());
+}
@@ -0,0 +1,278 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CTickManager.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CTickManager.h"
+#include "necs/CTrace.h"
+
+#include <algorithm>
+#include <assert.h>
+
+#include "necs/CWorldObject.h"
+#include "necs/CJobSystem.h"
+
+void CTickManager::Register(CWorldObject* const object)
+{
+	assert(object);
+	assert(object->GetStaticClassCDO() && "The CDO is never ticked");
+
+	if (!object->CanEverTick())
+	{
+		return;
+	}
+
+	assert(object->_tickBucket == UINT32_MAX && "Object is already registered");
+	if (_ticking)
+	{
+		_pendingRegistrations.push_back(object);
+		return;
+	}
+
+	const auto bucketIndex{ _findOrAddBucket(object->GetStaticClassCDO()) };
+	auto& bucket{ _buckets[bucketIndex] };
+
+	object->_tickBucket = bucketIndex;
+	object->_tickBucketSlot = static_cast<uint32_t>(bucket.Objects.size());
+	bucket.Objects.push_back(object);
+}
+
+void CTickManager::Unregister(CWorldObject* const object)
+{
+	assert(object);
+
+	if (object->_tickBucket == UINT32_MAX)
+	{
+		// Destroyed before its registration, e.g. by a bulk spawn failing in a tick
+		const auto it{ std::find(_pendingRegistrations.begin(), _pendingRegistrations.end(), object) };
+		if (it != _pendingRegistrations.end())
+			_pendingRegistrations.erase(it);
+		return;
+	}
+	assert(!_ticking && "Can not unregister while ticking");
+
+	auto& objects{ _buckets[object->_tickBucket].Objects };
+	assert(objects[object->_tickBucketSlot] == object);
+
+	CWorldObject* const last{ objects.back() };
+	objects[object->_tickBucketSlot] = last;
+	last->_tickBucketSlot = object->_tickBucketSlot;
+	objects.pop_back();
+
+	object->_tickBucket = UINT32_MAX;
+	object->_tickBucketSlot = UINT32_MAX;
+}
+
+void CTickManager::Relocate(CWorldObject* const from, CWorldObject* const to)
+{
+	assert(from->_tickBucket == to->_tickBucket && from->_tickBucketSlot == to->_tickBucketSlot && "The relocated object must carry over the tick registration");
+	assert(!_ticking && "Can not relocate while ticking");
+	if (to->_tickBucket == UINT32_MAX)
+	{
+		return;
+	}
+
+	auto& objects{ _buckets[to->_tickBucket].Objects };
+	assert(to->_tickBucketSlot < objects.size() && objects[to->_tickBucketSlot] == from);
+	objects[to->_tickBucketSlot] = to;
+	from->_tickBucket = UINT32_MAX;
+	from->_tickBucketSlot = UINT32_MAX;
+}
+
+void CTickManager::Tick()
+{
+	for (uint8_t group{}; group < static_cast<uint8_t>(ETickGroup::Count); group++)
+	{
+		TickGroup(static_cast<ETickGroup>(group));
+	}
+}
+
+void CTickManager::TickGroup(const ETickGroup group)
+{
+	NECS_TRACE_ZONE("necs::TickGroup");
+	assert(!_ticking && "Tick groups can't be nested");
+	_ticking = true;
+	for (const auto& wave : GetWaves(group))
+	{
+		_tickWave(wave);
+	}
+	_ticking = false;
+
+	for (auto* const object : _pendingRegistrations)
+	{
+		Register(object);
+	}
+	_pendingRegistrations.clear();
+}
+
+const std::vector<std::vector<uint32_t>>& CTickManager::GetWaves(const ETickGroup group)
+{
+	if (_wavesDirty)
+	{
+		_rebuildWaves();
+	}
+	return _waves[static_cast<size_t>(group)];
+}
+
+void CTickManager::SortBucketsByAddress()
+{
+	for (auto& bucket : _buckets)
+	{
+		_sortBucketByAddress(bucket);
+	}
+}
+
+void CTickManager::SortBucketByAddress(const IWorldObjectCDO* const classCdo)
+{
+	const auto it{ _classCdoToBucket.find(classCdo) };
+	if (it != _classCdoToBucket.end())
+	{
+		_sortBucketByAddress(_buckets[it->second]);
+	}
+}
+
+uint64_t CTickManager::GetNumOfTickingObjects() const
+{
+	uint64_t count{};
+	for (const auto& bucket : _buckets)
+	{
+		count += bucket.Objects.size();
+	}
+	return count;
+}
+
+uint32_t CTickManager::_findOrAddBucket(const IWorldObjectCDO* const classCdo)
+{
+	const auto it{ _classCdoToBucket.find(classCdo) };
+	if (it != _classCdoToBucket.end())
+	{
+		return it->second;
+	}
+
+	const auto bucketIndex{ static_cast<uint32_t>(_buckets.size()) };
+	_buckets.push_back(DTickBucket{ classCdo, _entityFactory.GetTickBucketFunc(*classCdo), _entityFactory.GetTickSettings(*classCdo), {} });
+	_classCdoToBucket.emplace(classCdo, bucketIndex);
+	_wavesDirty = true;
+	return bucketIndex;
+}
+
+void CTickManager::_sortBucketByAddress(DTickBucket& bucket)
+{
+	assert(!_ticking && "Can not sort while ticking");
+	std::sort(bucket.Objects.begin(), bucket.Objects.end());
+
+	for (uint32_t i{}; i < bucket.Objects.size(); i++)
+	{
+		bucket.Objects[i]->_tickBucketSlot = i;
+	}
+}
+
+void CTickManager::_rebuildWaves()
+{
+	for (auto& waves : _waves)
+	{
+		waves.clear();
+	}
+
+	// Greedy coloring in registration order, a bucket joins the first wave it does not conflict with
+	for (uint32_t bucketIndex{}; bucketIndex < _buckets.size(); bucketIndex++)
+	{
+		const auto& settings{ _buckets[bucketIndex].Settings };
+		auto& waves{ _waves[static_cast<size_t>(settings.Group)] };
+
+		bool placed{};
+		for (auto& wave : waves)
+		{
+			const bool conflicts{ std::any_of(wave.begin(), wave.end(), [&](const uint32_t other) {
+				return settings.ConflictsWith(_buckets[other].Settings);
+				}) };
+
+			if (!conflicts)
+			{
+				wave.push_back(bucketIndex);
+				placed = true;
+				break;
+			}
+		}
+
+		if (!placed)
+		{
+			waves.push_back({ bucketIndex });
+		}
+	}
+
+	_wavesDirty = false;
+}
+
+void CTickManager::_tickWave(const std::vector<uint32_t>& wave)
+{
+	if (!_jobSystem || _jobSystem->GetNumOfWorkers() == 0)
+	{
+		for (const auto bucketIndex : wave)
+		{
+			const auto& bucket{ _buckets[bucketIndex] };
+			if (!bucket.Objects.empty())
+			{
+				NECS_TRACE_ZONE("necs::TickBucket");
+				bucket.TickFunc(bucket.Objects.data(), bucket.Objects.size());
+			}
+		}
+		return;
+	}
+
+	CJobCounter counter;
+	for (const auto bucketIndex : wave)
+	{
+		const auto& bucket{ _buckets[bucketIndex] };
+		const auto numOfObjects{ static_cast<uint64_t>(bucket.Objects.size()) };
+		if (numOfObjects == 0)
+		{
+			continue;
+		}
+
+		const bool serial{ bucket.Settings.Exclusive || !bucket.Settings.ParallelInstances };
+		const uint64_t chunkSize{ serial ? numOfObjects : _tickChunkSize };
+
+		for (uint64_t begin{}; begin < numOfObjects; begin += chunkSize)
+		{
+			const auto count{ std::min(chunkSize, numOfObjects - begin) };
+			CWorldObject* const* const objects{ bucket.Objects.data() + begin };
+			const auto tickFunc{ bucket.TickFunc };
+			_jobSystem->Schedule([tickFunc, objects, count]() {
+				NECS_TRACE_ZONE("necs::TickChunk");
+				tickFunc(objects, count);
+				}, counter);
+		}
+	}
+	_jobSystem->Wait(counter);
+}
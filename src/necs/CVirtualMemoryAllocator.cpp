@@ -0,0 +1,291 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CVirtualMemoryAllocator.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CVirtualMemoryAllocator.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <new>
+#include <utility>
+
+#include "necs/BitUtils.h"
+
+#if _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if _WIN32
+	void* ReserveRange(const uint64_t bytes)
+	{
+		return VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+	}
+
+	void ReleaseRange(void* const ptr, const uint64_t bytes)
+	{
+		VirtualFree(ptr, 0, MEM_RELEASE);
+	}
+#else
+	void* ReserveRange(const uint64_t bytes)
+	{
+		void* const ptr{ mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0) };
+		return ptr == MAP_FAILED ? nullptr : ptr;
+	}
+
+	void ReleaseRange(void* const ptr, const uint64_t bytes)
+	{
+		munmap(ptr, bytes);
+	}
+#endif
+}
+
+CVirtualMemoryAllocator::CVirtualMemoryAllocator(const DVirtualMemorySettings& settings) : _settings(settings), _pageSize(GetSystemPageSize())
+{
+	assert(_settings.NumaNode < 64 && "NUMA nodes above 63 are not supported");
+	assert(_settings.RegionBytes > 0);
+
+	if (_settings.HugePages)
+	{
+#if _WIN32
+		const uint64_t largePageSize{ GetLargePageMinimum() };
+		_pageSize = largePageSize ? largePageSize : _pageSize;
+		_settings.HugePages = largePageSize != 0;
+#else
+		_pageSize = std::max(_pageSize, HUGE_PAGE_SIZE);
+#endif
+	}
+}
+
+CVirtualMemoryAllocator::CVirtualMemoryAllocator(CVirtualMemoryAllocator&& other) noexcept : _settings(other._settings), _pageSize(other._pageSize)
+{
+	std::lock_guard<std::mutex> lock(other._mutex);
+	_regions.swap(other._regions);
+	_allocations.swap(other._allocations);
+	_freeRanges.swap(other._freeRanges);
+	_committedBytes = std::exchange(other._committedBytes, 0);
+}
+
+CVirtualMemoryAllocator::~CVirtualMemoryAllocator()
+{
+	for (const auto& [ptr, allocation] : _allocations)
+	{
+		if (allocation.Dedicated)
+		{
+			ReleaseRange(ptr, allocation.Bytes);
+		}
+	}
+
+	for (const auto& region : _regions)
+	{
+		ReleaseRange(region.Base, region.Bytes);
+	}
+}
+
+void* CVirtualMemoryAllocator::Allocate(const uint64_t bytes, const uint64_t alignement)
+{
+	assert(bytes > 0);
+	const uint64_t size{ AlignUp(bytes, _pageSize) };
+	const uint64_t alignment{ std::max(alignement, _pageSize) };
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// Reuse a decommitted range unless it would waste more than the allocation itself
+	for (auto it{ _freeRanges.lower_bound(size) }; it != _freeRanges.end() && it->first <= size * 2; ++it)
+	{
+		if (reinterpret_cast<uintptr_t>(it->second) % alignment == 0)
+		{
+			void* const ptr{ it->second };
+			const uint64_t rangeBytes{ it->first };
+			if (!_commit(ptr, rangeBytes))
+			{
+				throw std::bad_alloc();
+			}
+
+			_freeRanges.erase(it);
+			_allocations.emplace(ptr, DAllocation{ rangeBytes, false });
+			_committedBytes += rangeBytes;
+			return ptr;
+		}
+	}
+
+#if _WIN32
+	// Large pages must be committed with their reservation
+	if (_settings.HugePages)
+	{
+		void* const ptr{ _settings.NumaNode >= 0 ?
+			VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, static_cast<DWORD>(_settings.NumaNode)) :
+			VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE) };
+		if (ptr)
+		{
+			_allocations.emplace(ptr, DAllocation{ size, true });
+			_committedBytes += size;
+			return ptr;
+		}
+	}
+#endif
+
+	void* ptr{};
+	for (auto& region : _regions)
+	{
+		const uint64_t begin{ AlignUp(reinterpret_cast<uintptr_t>(region.Base) + region.Used, alignment) - reinterpret_cast<uintptr_t>(region.Base) };
+		if (begin + size <= region.Bytes)
+		{
+			ptr = region.Base + begin;
+			region.Used = begin + size;
+			break;
+		}
+	}
+
+	if (!ptr)
+	{
+		DRegion region{};
+		region.Bytes = std::max(_settings.RegionBytes, size + alignment);
+		region.Base = static_cast<uint8_t*>(ReserveRange(region.Bytes));
+		if (!region.Base)
+		{
+			throw std::bad_alloc();
+		}
+
+		const uint64_t begin{ AlignUp(reinterpret_cast<uintptr_t>(region.Base), alignment) - reinterpret_cast<uintptr_t>(region.Base) };
+		ptr = region.Base + begin;
+		region.Used = begin + size;
+		_regions.push_back(region);
+	}
+
+	if (!_commit(ptr, size))
+	{
+		_freeRanges.emplace(size, ptr);
+		throw std::bad_alloc();
+	}
+
+	_allocations.emplace(ptr, DAllocation{ size, false });
+	_committedBytes += size;
+	return ptr;
+}
+
+void CVirtualMemoryAllocator::Free(void* ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	const auto it{ _allocations.find(ptr) };
+	assert(it != _allocations.end() && "Pointer not allocated by this allocator");
+	if (it == _allocations.end())
+	{
+		return;
+	}
+
+	const DAllocation allocation{ it->second };
+	_allocations.erase(it);
+	_committedBytes -= allocation.Bytes;
+
+	if (allocation.Dedicated)
+	{
+		ReleaseRange(ptr, allocation.Bytes);
+	}
+	else
+	{
+		_decommit(ptr, allocation.Bytes);
+		_freeRanges.emplace(allocation.Bytes, ptr);
+	}
+}
+
+uint64_t CVirtualMemoryAllocator::GetCommittedBytes() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _committedBytes;
+}
+
+uint64_t CVirtualMemoryAllocator::GetSystemPageSize()
+{
+#if _WIN32
+	SYSTEM_INFO info{};
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+bool CVirtualMemoryAllocator::_commit(void* const ptr, const uint64_t bytes)
+{
+#if _WIN32
+	const void* const committed{ _settings.NumaNode >= 0 ?
+		VirtualAllocExNuma(GetCurrentProcess(), ptr, bytes, MEM_COMMIT, PAGE_READWRITE, static_cast<DWORD>(_settings.NumaNode)) :
+		VirtualAlloc(ptr, bytes, MEM_COMMIT, PAGE_READWRITE) };
+	return committed != nullptr;
+#else
+	if (mprotect(ptr, bytes, PROT_READ | PROT_WRITE) != 0)
+	{
+		return false;
+	}
+
+	// Both are hints, the pages are faulted in later and follow them when the system supports it
+#ifdef MADV_HUGEPAGE
+	if (_settings.HugePages)
+	{
+		madvise(ptr, bytes, MADV_HUGEPAGE);
+	}
+#endif
+#ifdef SYS_mbind
+	if (_settings.NumaNode >= 0)
+	{
+		constexpr int MPOL_BIND_MODE{ 2 };
+		const unsigned long nodeMask{ 1ul << _settings.NumaNode };
+		syscall(SYS_mbind, ptr, bytes, MPOL_BIND_MODE, &nodeMask, sizeof(nodeMask) * 8 + 1, 0);
+	}
+#endif
+	return true;
+#endif
+}
+
+void CVirtualMemoryAllocator::_decommit(void* const ptr, const uint64_t bytes)
+{
+#if _WIN32
+	VirtualFree(ptr, bytes, MEM_DECOMMIT);
+#else
+	// Mapping fresh inaccessible pages over the range gives the memory back and drops its NUMA policy
+	mmap(ptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+#endif
+}
@@ -0,0 +1,641 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CWorld.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CWorld.h"
+#include "necs/CTrace.h"
+
+#include <algorithm>
+#include <assert.h>
+
+CWorld::CWorld(IEntityFactory& entityFactory, const uint64_t maxObjectsPerSlab, CJobSystem* const jobSystem) : _entityFactory(entityFactory), _objectsAllocator(maxObjectsPerSlab), _tickManager(entityFactory, jobSystem)
+{
+}
+
+CWorld::~CWorld()
+{
+	_destroyAll();
+}
+
+void CWorld::_destroyAll()
+{
+	{
+		std::lock_guard<std::mutex> lock(_pendingDestroyMutex);
+		_pendingDestroy.clear();
+	}
+	_compactionQueue.clear();
+	_compactionNext = 0;
+
+	// Destructors may still spawn or mark objects, drain until the world is empty
+	while (!_worldObjects.empty())
+	{
+		_destroyBatch.clear();
+		for (CWorldObject* const object : _worldObjects)
+		{
+			_destroyBatch.emplace_back(_objectsAllocator.GetClassSize(_entityFactory.GetClassDescriptor(object->GetStaticClassId()).AllocationSize), object);
+		}
+		_destroyBatchSorted();
+	}
+}
+
+CWorldObject* CWorld::SpawnWorldObject(const std::string& typeName)
+{
+	return SpawnWorldObject(_entityFactory.GetClassIdFromTypename(typeName));
+}
+
+CWorldObject* CWorld::SpawnWorldObject(const uint32_t classId)
+{
+	NECS_TRACE_ZONE("necs::SpawnWorldObject");
+	const auto& descriptor{ _entityFactory.GetClassDescriptor(classId) };
+	assert(descriptor.Alignment <= alignof(std::max_align_t) && "Over aligned classes are not supported");
+
+	void* const memory{ _objectsAllocator.Allocate(descriptor.AllocationSize) };
+
+	CWorldObject* object{};
+	try
+	{
+		object = _entityFactory.PlacementNewFromClassId(memory, this, classId, &_runtimeComponentsAllocator, &_frameComponentsAllocator);
+	}
+	catch (...)
+	{
+		_objectsAllocator.Free(memory);
+		throw;
+	}
+
+	_addSpawned(object);
+	return object;
+}
+
+void CWorld::SpawnWorldObjects(const uint32_t classId, const uint64_t count, CWorldObject** const out, const std::function<void(CWorldObject* object, uint64_t index)>& init, const CWorldObject* const prototype)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	NECS_TRACE_ZONE("necs::SpawnWorldObjects");
+
+	const auto& descriptor{ _entityFactory.GetClassDescriptor(classId) };
+	assert(descriptor.Alignment <= alignof(std::max_align_t) && "Over aligned classes are not supported");
+	assert((!prototype || prototype->GetStaticClassId() == classId) && "The prototype must be of the spawned class");
+	if (prototype && !descriptor.Clone)
+	{
+		throw std::runtime_error("Class has no prototype constructor!");
+	}
+
+	// Taken by the spawn so constructors and init may spawn in bulk too
+	std::vector<void*> batch{ std::move(_spawnBatch) };
+	batch.resize(count);
+	// Runs are carved contiguously from the untouched slab tails
+	_objectsAllocator.AllocateBatch(descriptor.AllocationSize, count, batch.data());
+
+	uint64_t constructed{};
+	try
+	{
+		for (; constructed < count; constructed++)
+		{
+			void* const memory{ batch[constructed] };
+			batch[constructed] = prototype ?
+				_entityFactory.PlacementCloneFromPrototype(memory, this, *prototype, &_runtimeComponentsAllocator, &_frameComponentsAllocator) :
+				_entityFactory.PlacementNewFromClassId(memory, this, classId, &_runtimeComponentsAllocator, &_frameComponentsAllocator);
+		}
+	}
+	catch (...)
+	{
+		for (uint64_t i{}; i < constructed; i++)
+		{
+			descriptor.Destroy(static_cast<CWorldObject*>(batch[i]));
+		}
+		_objectsAllocator.FreeBatch(batch.data(), count);
+		throw;
+	}
+
+	for (uint64_t i{}; i < count; i++)
+	{
+		CWorldObject* const object{ static_cast<CWorldObject*>(batch[i]) };
+		_addSpawned(object);
+		if (out)
+		{
+			out[i] = object;
+		}
+	}
+
+	if (init)
+	{
+		for (uint64_t i{}; i < count; i++)
+		{
+			init(static_cast<CWorldObject*>(batch[i]), i);
+		}
+	}
+
+	_spawnBatch = std::move(batch);
+}
+
+void CWorld::MarkPendingDestroy(CWorldObject* ptr)
+{
+	assert(ptr);
+	std::lock_guard<std::mutex> lock(_pendingDestroyMutex);
+	_pendingDestroy.push_back(ptr);
+}
+
+void CWorld::FlushPendingDestroy()
+{
+	NECS_TRACE_ZONE("necs::FlushPendingDestroy");
+	_destroyBatch.clear();
+	{
+		std::lock_guard<std::mutex> lock(_pendingDestroyMutex);
+		for (CWorldObject* const object : _pendingDestroy)
+		{
+			assert(_worldObjects.find(object) != _worldObjects.end() && "Object not owned by this world");
+			_destroyBatch.emplace_back(_objectsAllocator.GetClassSize(_entityFactory.GetClassDescriptor(object->GetStaticClassId()).AllocationSize), object);
+		}
+		_pendingDestroy.clear();
+	}
+
+	NECS_TRACE_COUNTER("necs::DestroyedObjects", _destroyBatch.size());
+	_destroyBatchSorted();
+}
+
+void CWorld::Tick()
+{
+	{
+		NECS_TRACE_ZONE("necs::WorldTick");
+		_tickManager.Tick();
+		FlushPendingDestroy();
+		_recordChanges();
+		_frameComponentsAllocator.SwapFrames();
+	}
+	NECS_TRACE_COUNTER("necs::WorldObjects", _worldObjects.size());
+	NECS_TRACE_END_FRAME();
+}
+
+uint64_t CWorld::GetNumOfPendingDestroy() const
+{
+	std::lock_guard<std::mutex> lock(_pendingDestroyMutex);
+	return _pendingDestroy.size();
+}
+
+const std::vector<CWorldObject*>& CWorld::GetObjectsWithTag(const uint32_t tagId) const
+{
+	static const std::vector<CWorldObject*> empty;
+	return tagId < _tagIndex.size() ? _tagIndex[tagId].Objects : empty;
+}
+
+DWorldStats CWorld::GetStats() const
+{
+	DWorldStats stats{};
+	stats.NumOfObjects = _worldObjects.size();
+	stats.NumOfPendingDestroy = GetNumOfPendingDestroy();
+	stats.FrameComponentsReservedBytes = _frameComponentsAllocator.GetReservedBytes();
+	_objectsAllocator.GetStats(stats.SizeClasses);
+
+	for (uint32_t classId{}; classId < _classCounters.size(); classId++)
+	{
+		const auto& counters{ _classCounters[classId] };
+		if (counters.Spawned.Get() == 0 && _classObjects[classId].empty())
+			continue;
+
+		DEntityClassStats entityClass{};
+		entityClass.ClassId = classId;
+		entityClass.Name = _entityFactory.GetClassTypename(classId);
+		entityClass.Objects = counters.Objects.Get();
+		entityClass.HighWaterObjects = counters.Objects.GetHighWater();
+		entityClass.Spawned = counters.Spawned.Get();
+		entityClass.Destroyed = counters.Destroyed.Get();
+		entityClass.RuntimeComponents = counters.DestroyedRuntimeComponents.Get();
+		for (const CWorldObject* const object : _classObjects[classId])
+		{
+			entityClass.RuntimeComponents += object->GetNumOfRuntimeComponents();
+		}
+		stats.Classes.push_back(std::move(entityClass));
+	}
+	return stats;
+}
+
+void CWorld::BeginCompaction(const uint32_t classId, const std::function<bool(const CWorldObject& a, const CWorldObject& b)>& less)
+{
+	if (!_entityFactory.IsClassRelocatable(classId))
+	{
+		throw std::runtime_error("Class has no relocating constructor!");
+	}
+	if (classId >= _classObjects.size())
+	{
+		return;
+	}
+
+	_compactionRun = _classObjects[classId];
+	if (less)
+	{
+		std::stable_sort(_compactionRun.begin(), _compactionRun.end(), [&less](const CWorldObject* const a, const CWorldObject* const b) { return less(*a, *b); });
+	}
+	else
+	{
+		std::sort(_compactionRun.begin(), _compactionRun.end());
+	}
+
+	_compactionQueue.erase(_compactionQueue.begin(), _compactionQueue.begin() + _compactionNext);
+	_compactionNext = 0;
+	for (const CWorldObject* const object : _compactionRun)
+	{
+		_compactionQueue.push_back(object->_handle);
+	}
+	_compactionRun.clear();
+}
+
+bool CWorld::StepCompaction(const uint64_t maxRelocations)
+{
+	NECS_TRACE_ZONE("necs::StepCompaction");
+	if (_tickManager.IsTicking())
+	{
+		throw std::runtime_error("Can not compact while ticking!");
+	}
+
+	uint64_t relocated{};
+	while (_compactionNext < _compactionQueue.size() && relocated < maxRelocations)
+	{
+		// Runs are cut at class boundaries, the queue is grouped by class
+		_compactionRun.clear();
+		uint32_t classId{ UINT32_MAX };
+		for (; _compactionNext < _compactionQueue.size() && relocated + _compactionRun.size() < maxRelocations; _compactionNext++)
+		{
+			CWorldObject* const object{ _handles.Resolve(_compactionQueue[_compactionNext]) };
+			// Destroyed since, or queued for destruction by address
+			if (!object || object->IsPendingDestroy())
+				continue;
+			if (classId != UINT32_MAX && object->GetStaticClassId() != classId)
+				break;
+
+			classId = object->GetStaticClassId();
+			_compactionRun.push_back(object);
+		}
+
+		if (!_compactionRun.empty())
+		{
+			_compactRun(classId);
+			relocated += _compactionRun.size();
+			_compactionRun.clear();
+		}
+	}
+
+	if (_compactionNext == _compactionQueue.size())
+	{
+		_compactionQueue.clear();
+		_compactionNext = 0;
+	}
+	NECS_TRACE_COUNTER("necs::PendingRelocations", GetNumOfPendingRelocations());
+	return _compactionQueue.empty();
+}
+
+bool CWorld::ForEachChangeSince(const uint64_t version, const std::function<void(CWorldObject* object, uint64_t changedBits)>& fn)
+{
+	if (version >= _changeVersion)
+	{
+		return true;
+	}
+	if (_changeHistory.empty() || _changeHistory.front().Version > version + 1)
+	{
+		return false;
+	}
+
+	// Merge the frames, an object changed in several frames is reported once
+	_accumulatedSlots.clear();
+	for (auto it{ _changeHistory.begin() + (version + 1 - _changeHistory.front().Version) }; it != _changeHistory.end(); ++it)
+	{
+		for (const auto& record : it->Records)
+		{
+			if (!_handles.IsAlive(record.Handle))
+				continue;
+
+			if (_accumulatedChanges.size() <= record.Handle.Index)
+			{
+				_accumulatedChanges.resize(record.Handle.Index + 1);
+			}
+			if (_accumulatedChanges[record.Handle.Index] == 0)
+			{
+				_accumulatedSlots.push_back(record.Handle.Index);
+			}
+			_accumulatedChanges[record.Handle.Index] |= record.ChangedBits;
+		}
+	}
+
+	for (const uint32_t slot : _accumulatedSlots)
+	{
+		const uint64_t changedBits{ _accumulatedChanges[slot] };
+		_accumulatedChanges[slot] = 0;
+		fn(_handles.Resolve(DWorldObjectHandle{ slot, _handles.GetGenerator().GetSlots()[slot].Generation }), changedBits);
+	}
+	return true;
+}
+
+void CWorld::SetChangeHistoryLength(const uint64_t numOfFrames)
+{
+	_changeHistoryLength = numOfFrames;
+	while (_changeHistory.size() > _changeHistoryLength)
+	{
+		_changeHistory.pop_front();
+	}
+}
+
+void CWorld::OnComponentsChanged(CWorldObject* const object)
+{
+	std::lock_guard<std::mutex> lock(_changedObjectsMutex);
+	_changedObjects.push_back(object->_handle);
+}
+
+void CWorld::_recordChanges()
+{
+	// Recycle the storage of the frame falling out of the history
+	std::vector<DChangeRecord> records;
+	if (!_changeHistory.empty() && _changeHistory.size() >= _changeHistoryLength)
+	{
+		records = std::move(_changeHistory.front().Records);
+		records.clear();
+		_changeHistory.pop_front();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_changedObjectsMutex);
+		for (const auto handle : _changedObjects)
+		{
+			CWorldObject* const object{ _handles.Resolve(handle) };
+			if (object && object->_changedComponents != 0)
+			{
+				records.push_back(DChangeRecord{ handle, object->_changedComponents });
+				object->_changedComponents = 0;
+			}
+		}
+		_changedObjects.clear();
+	}
+
+	_changeVersion++;
+	if (_changeHistoryLength > 0)
+	{
+		_changeHistory.push_back(DChangeFrame{ _changeVersion, std::move(records) });
+	}
+}
+
+void CWorld::_clearChangeHistory()
+{
+	std::lock_guard<std::mutex> lock(_changedObjectsMutex);
+	_changedObjects.clear();
+	_changeHistory.clear();
+}
+
+void CWorld::OnTagAdded(CWorldObject* const object, const uint32_t tagId)
+{
+	if (_tagIndex.size() <= tagId)
+	{
+		_tagIndex.resize(tagId + 1);
+	}
+
+	auto& index{ _tagIndex[tagId] };
+	assert(index.Slots.find(object) == index.Slots.end());
+	index.Slots.emplace(object, static_cast<uint32_t>(index.Objects.size()));
+	index.Objects.push_back(object);
+}
+
+void CWorld::OnTagRemoved(CWorldObject* const object, const uint32_t tagId)
+{
+	assert(tagId < _tagIndex.size());
+	auto& index{ _tagIndex[tagId] };
+
+	const auto it{ index.Slots.find(object) };
+	assert(it != index.Slots.end());
+	const uint32_t slot{ it->second };
+	index.Slots.erase(it);
+
+	CWorldObject* const last{ index.Objects.back() };
+	index.Objects.pop_back();
+	if (last != object)
+	{
+		index.Objects[slot] = last;
+		index.Slots[last] = slot;
+	}
+}
+
+void CWorld::_addSpawned(CWorldObject* const object)
+{
+	// Construction isn't a change
+	object->_changedComponents = 0;
+	_worldObjects.insert(object);
+	_addToClassObjects(object);
+	_tickManager.Register(object);
+
+	object->_handle = _handles.Add(object);
+
+	// Tags added by the constructor predate the observer
+	object->_observer = this;
+	for (const auto tagId : object->GetTags())
+	{
+		OnTagAdded(object, tagId);
+	}
+}
+
+void CWorld::_addRestored(CWorldObject* const object, const DWorldObjectHandle handle, const uint32_t* const tags, const uint32_t numOfTags)
+{
+	assert(!object->_observer && "Tags must be replaced before the object is indexed");
+	object->_changedComponents = 0;
+	object->_tags.Clear();
+	for (uint32_t i{}; i < numOfTags; i++)
+	{
+		object->_tags.Add(tags[i]);
+	}
+
+	_worldObjects.insert(object);
+	_addToClassObjects(object);
+	_tickManager.Register(object);
+
+	object->_handle = handle;
+	_handles.Bind(handle, object);
+
+	object->_observer = this;
+	for (const auto tagId : object->GetTags())
+	{
+		OnTagAdded(object, tagId);
+	}
+}
+
+void CWorld::_addToClassObjects(CWorldObject* const object)
+{
+	const uint32_t classId{ object->GetStaticClassId() };
+	if (_classObjects.size() <= classId)
+	{
+		_classObjects.resize(classId + 1);
+	}
+
+	auto& objects{ _classObjects[classId] };
+	object->_classSlot = static_cast<uint32_t>(objects.size());
+	objects.push_back(object);
+
+	if (_classCounters.size() <= classId)
+	{
+		_classCounters.resize(classId + 1);
+	}
+	_classCounters[classId].Objects.Add();
+	_classCounters[classId].Spawned.Add();
+}
+
+void CWorld::_removeFromClassObjects(CWorldObject* const object)
+{
+	auto& objects{ _classObjects[object->GetStaticClassId()] };
+	assert(object->_classSlot < objects.size() && objects[object->_classSlot] == object);
+
+	CWorldObject* const last{ objects.back() };
+	objects[object->_classSlot] = last;
+	last->_classSlot = object->_classSlot;
+	objects.pop_back();
+	object->_classSlot = UINT32_MAX;
+
+	auto& counters{ _classCounters[object->GetStaticClassId()] };
+	counters.Objects.Sub();
+	counters.Destroyed.Add();
+	counters.DestroyedRuntimeComponents.Add(object->GetNumOfRuntimeComponents());
+}
+
+void CWorld::_compactRun(const uint32_t classId)
+{
+	const auto& descriptor{ _entityFactory.GetClassDescriptor(classId) };
+	const uint64_t count{ _compactionRun.size() };
+	const uint64_t stride{ AlignUp(descriptor.AllocationSize, alignof(std::max_align_t)) };
+
+	// Everything that may throw comes first, before any object moves
+	_compactionBlocks.resize(count * 2);
+	_objectsAllocator.AllocateBatch(descriptor.AllocationSize, count, _compactionBlocks.data());
+	CHeapAlignedAllocator stagingAllocator;
+	uint8_t* staging{};
+	try
+	{
+		staging = static_cast<uint8_t*>(stagingAllocator.Allocate(count * stride, alignof(std::max_align_t)));
+	}
+	catch (...)
+	{
+		_objectsAllocator.FreeBatch(_compactionBlocks.data(), count);
+		throw;
+	}
+
+	for (uint64_t i{}; i < count; i++)
+	{
+		_compactionBlocks[count + i] = _compactionRun[i];
+		_compactionRun[i] = _relocate(_compactionRun[i], staging + i * stride);
+	}
+
+	// The lowest addresses take the run in order, the others go back to the allocator
+	std::sort(_compactionBlocks.begin(), _compactionBlocks.end());
+	for (uint64_t i{}; i < count; i++)
+	{
+		_relocate(_compactionRun[i], _compactionBlocks[i]);
+	}
+	_objectsAllocator.FreeBatch(_compactionBlocks.data() + count, count);
+	stagingAllocator.Free(staging);
+
+	// Queries and the tick walk the class in address order again
+	auto& objects{ _classObjects[classId] };
+	std::sort(objects.begin(), objects.end());
+	for (uint32_t i{}; i < objects.size(); i++)
+	{
+		objects[i]->_classSlot = i;
+	}
+	_tickManager.SortBucketByAddress(descriptor.CDO);
+}
+
+CWorldObject* CWorld::_relocate(CWorldObject* const object, void* const memory)
+{
+#if _DEBUG
+	const uint64_t constructedSlots{ object->GetConstructedArchetypeSlots() };
+#endif
+	CWorldObject* const relocated{ _entityFactory.PlacementRelocate(memory, this, *object, &_runtimeComponentsAllocator, &_frameComponentsAllocator) };
+#if _DEBUG
+	assert(relocated->GetConstructedArchetypeSlots() == constructedSlots && "The relocating constructor must relocate every archetype component");
+#endif
+
+	// Nodes are moved between keys, relocating allocates nothing past this point
+	auto node{ _worldObjects.extract(object) };
+	node.value() = relocated;
+	_worldObjects.insert(std::move(node));
+	_classObjects[relocated->GetStaticClassId()][relocated->_classSlot] = relocated;
+	_tickManager.Relocate(object, relocated);
+	_handles.Rebind(relocated->_handle, relocated);
+
+	for (const auto tagId : relocated->GetTags())
+	{
+		auto& index{ _tagIndex[tagId] };
+		auto slot{ index.Slots.extract(object) };
+		assert(!slot.empty());
+		index.Objects[slot.mapped()] = relocated;
+		slot.key() = relocated;
+		index.Slots.insert(std::move(slot));
+	}
+
+	_entityFactory.GetClassDescriptor(relocated->GetStaticClassId()).Destroy(object);
+	return relocated;
+}
+
+void CWorld::_destroyBatchSorted()
+{
+	if (_destroyBatch.empty())
+	{
+		return;
+	}
+
+	// Same size class means same column, ascending addresses walk its slabs in order
+	std::sort(_destroyBatch.begin(), _destroyBatch.end());
+	// An object marked more than once must be destroyed once
+	_destroyBatch.erase(std::unique(_destroyBatch.begin(), _destroyBatch.end()), _destroyBatch.end());
+
+	// Batch objects can't outlive the batch, detach all of them before running any destructor
+	for (const auto& [bytes, object] : _destroyBatch)
+	{
+		_tickManager.Unregister(object);
+		_worldObjects.erase(object);
+		_removeFromClassObjects(object);
+
+		for (const auto tagId : object->GetTags())
+		{
+			OnTagRemoved(object, tagId);
+		}
+		object->_observer = nullptr;
+
+		_handles.Remove(object->_handle);
+		object->_handle = {};
+	}
+
+	_freeBatch.clear();
+	for (const auto& [bytes, object] : _destroyBatch)
+	{
+		_entityFactory.GetClassDescriptor(object->GetStaticClassId()).Destroy(object);
+		_freeBatch.push_back(object);
+	}
+
+	_objectsAllocator.FreeBatch(_freeBatch.data(), _freeBatch.size());
+	_destroyBatch.clear();
+}
@@ -35,17 +35,16 @@
 
 #include "necs/CWorldObject.h"
 
-bool CDestroyable::IsPendingDestroy()const { return PendingDestroy; }
+bool CDestroyable::IsPendingDestroy()const { return PendingDestroy.load(std::memory_order_acquire); }
 
 void CDestroyable::SetPendingDestroy() {
-	if (!PendingDestroy)
+	// Objects may be marked by several threads ticking concurrently, only the first mark notifies
+	if (!PendingDestroy.exchange(true, std::memory_order_acq_rel))
 	{
-		PendingDestroy = true;
-
 		_pendingDestroyNotifier->MarkPendingDestroy(static_cast<CWorldObject*>(this));
 		if (_onPendingDestroySetCallback)
 		{
-			_onPendingDestroySetCallback();
+			(*_onPendingDestroySetCallback)();
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,303 @@
+// //////////////////////////////////////////////////////////////////////////////////////////
+// FILE: CWorldSnapshot.cpp
+// 
+// AUTHOR: Kirichenko Stanislav
+// 
+// DATE: 14 oct 2026
+// 
+// LICENSE: BSD-2
+// Copyright (c) 2025, Kirichenko Stanislav
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions, and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions, and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// //////////////////////////////////////////////////////////////////////////////////////////
+
+#include "necs/CWorldSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <assert.h>
+
+#include "necs/CBinaryImage.h"
+#include "necs/CWorld.h"
+
+namespace
+{
+	struct DSnapshotHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t NumOfSlots;
+		uint32_t FreeHead;
+		uint32_t NumOfTags;
+		uint32_t NumOfClasses;
+	};
+
+	/**
+	 * /brief A validated class record, the arrays point into the image.
+	 */
+	struct DClassImage
+	{
+		uint32_t ClassId;
+		uint64_t BlockOffset;
+		uint64_t BlockBytes;
+		uint64_t Count;
+		const uint8_t* Handles;
+		const uint8_t* Blocks;
+		const uint8_t* TagCounts;
+		const uint8_t* Tags;
+	};
+}
+
+void CWorldSnapshot::Save(const CWorld& world, std::vector<uint8_t>& image)
+{
+	// Grouped by class and ordered by handle, the same world always gives the same image
+	std::vector<CWorldObject*> objects(world._worldObjects.begin(), world._worldObjects.end());
+	std::sort(objects.begin(), objects.end(), [](const CWorldObject* const a, const CWorldObject* const b) {
+		return a->GetStaticClassId() != b->GetStaticClassId() ? a->GetStaticClassId() < b->GetStaticClassId() : a->GetHandle().Index < b->GetHandle().Index;
+		});
+
+	// Tag ids are interned per process, the image carries their names
+	std::vector<uint32_t> tagIds;
+	std::unordered_map<uint32_t, uint32_t> tagToIndex;
+	uint32_t numOfClasses{};
+	for (uint64_t i{}; i < objects.size(); i++)
+	{
+		if (!HoldsEveryArchetypeComponent(objects[i]->GetConstructedArchetypeSlots()))
+			throw std::runtime_error("Snapshot of an object with reset archetype components!");
+
+		numOfClasses += i == 0 || objects[i]->GetStaticClassId() != objects[i - 1]->GetStaticClassId();
+		for (const auto tagId : objects[i]->GetTags())
+		{
+			if (tagToIndex.emplace(tagId, static_cast<uint32_t>(tagIds.size())).second)
+				tagIds.push_back(tagId);
+		}
+	}
+
+	image.clear();
+	CBinaryImageWriter writer(image);
+	const auto& generator{ world._handles.GetGenerator() };
+	const auto& slots{ generator.GetSlots() };
+
+	const DSnapshotHeader header{ MAGIC, VERSION, static_cast<uint32_t>(slots.size()), generator.GetFreeHead(), static_cast<uint32_t>(tagIds.size()), numOfClasses };
+	writer.AppendValue(header);
+	writer.Append(slots.data(), slots.size() * sizeof(CGenerationalIdGenerator::DSlot));
+	for (const auto tagId : tagIds)
+	{
+		writer.AppendString(CTagRegistry::GetName(tagId));
+	}
+
+	for (uint64_t begin{}; begin < objects.size();)
+	{
+		const uint32_t classId{ objects[begin]->GetStaticClassId() };
+		uint64_t end{ begin + 1 };
+		while (end < objects.size() && objects[end]->GetStaticClassId() == classId)
+		{
+			end++;
+		}
+
+		uint64_t blockOffset, blockBytes;
+		if (!GetArchetypeComponentsBlock(world._entityFactory.GetCDOFromClassId(classId), blockOffset, blockBytes))
+			throw std::runtime_error("Snapshot of a class with archetype components not trivially copyable!");
+
+		writer.AppendString(world._entityFactory.GetClassTypename(classId));
+		writer.AppendValue(blockOffset);
+		writer.AppendValue(blockBytes);
+		writer.AppendValue(end - begin);
+
+		// One contiguous array per field, restoring reads each of them in one pass
+		for (uint64_t i{ begin }; i < end; i++)
+		{
+			writer.AppendValue(objects[i]->GetHandle());
+		}
+
+		uint8_t* block{ writer.AppendUninitialized((end - begin) * blockBytes) };
+		for (uint64_t i{ begin }; i < end; i++, block += blockBytes)
+		{
+			std::memcpy(block, reinterpret_cast<const uint8_t*>(objects[i]) + blockOffset, blockBytes);
+		}
+
+		for (uint64_t i{ begin }; i < end; i++)
+		{
+			writer.AppendValue(objects[i]->GetTags().Size());
+		}
+		for (uint64_t i{ begin }; i < end; i++)
+		{
+			for (const auto tagId : objects[i]->GetTags())
+			{
+				writer.AppendValue(tagToIndex[tagId]);
+			}
+		}
+
+		begin = end;
+	}
+}
+
+void CWorldSnapshot::Restore(CWorld& world, const uint8_t* const image, const uint64_t bytes)
+{
+	// Parse and validate everything first, the world is only touched by a valid image
+	CBinaryImageReader reader(image, bytes);
+
+	const auto header{ reader.ReadValue<DSnapshotHeader>() };
+	if (header.Magic != MAGIC || header.Version != VERSION)
+		throw std::runtime_error("Unknown snapshot format");
+
+	std::vector<CGenerationalIdGenerator::DSlot> slots(header.NumOfSlots);
+	std::memcpy(slots.data(), reader.ReadArray(header.NumOfSlots, sizeof(CGenerationalIdGenerator::DSlot)), slots.size() * sizeof(CGenerationalIdGenerator::DSlot));
+	try
+	{
+		CGenerationalIdGenerator validator;
+		validator.Restore(slots, header.FreeHead);
+	}
+	catch (const std::invalid_argument&)
+	{
+		throw std::runtime_error("Corrupted snapshot");
+	}
+
+	std::vector<uint32_t> tagIds(header.NumOfTags);
+	for (auto& tagId : tagIds)
+	{
+		tagId = CTagRegistry::Intern(reader.ReadString());
+	}
+
+	uint64_t numOfInUse{};
+	for (const auto& slot : slots)
+	{
+		numOfInUse += slot.NextFree == CGenerationalIdGenerator::IN_USE;
+	}
+
+	// Every id in use must be bound to exactly one object
+	std::vector<bool> bound(slots.size());
+	uint64_t numOfObjects{};
+
+	std::vector<DClassImage> classes(header.NumOfClasses);
+	for (auto& record : classes)
+	{
+		record.ClassId = world._entityFactory.FindClassIdFromTypename(reader.ReadString());
+		if (record.ClassId == UINT32_MAX)
+			throw std::runtime_error("Snapshot class not registered");
+
+		record.BlockOffset = reader.ReadValue<uint64_t>();
+		record.BlockBytes = reader.ReadValue<uint64_t>();
+		record.Count = reader.ReadValue<uint64_t>();
+
+		uint64_t blockOffset, blockBytes;
+		if (!GetArchetypeComponentsBlock(world._entityFactory.GetCDOFromClassId(record.ClassId), blockOffset, blockBytes) || blockOffset != record.BlockOffset || blockBytes != record.BlockBytes)
+			throw std::runtime_error("Snapshot class layout mismatch");
+
+		record.Handles = reader.ReadArray(record.Count, sizeof(DWorldObjectHandle));
+		for (uint64_t i{}; i < record.Count; i++)
+		{
+			const auto handle{ LoadUnaligned<DWorldObjectHandle>(record.Handles, i) };
+			if (handle.Index >= slots.size() || bound[handle.Index] || slots[handle.Index].NextFree != CGenerationalIdGenerator::IN_USE || slots[handle.Index].Generation != handle.Generation)
+				throw std::runtime_error("Corrupted snapshot");
+			bound[handle.Index] = true;
+		}
+		numOfObjects += record.Count;
+
+		record.Blocks = reader.ReadArray(record.Count, record.BlockBytes);
+
+		record.TagCounts = reader.ReadArray(record.Count, sizeof(uint32_t));
+		uint64_t numOfTags{};
+		for (uint64_t i{}; i < record.Count; i++)
+		{
+			numOfTags += LoadUnaligned<uint32_t>(record.TagCounts, i);
+		}
+
+		record.Tags = reader.ReadArray(numOfTags, sizeof(uint32_t));
+		for (uint64_t i{}; i < numOfTags; i++)
+		{
+			if (LoadUnaligned<uint32_t>(record.Tags, i) >= tagIds.size())
+				throw std::runtime_error("Corrupted snapshot");
+		}
+	}
+
+	if (numOfObjects != numOfInUse || !reader.IsAtEnd())
+		throw std::runtime_error("Corrupted snapshot");
+
+	world._destroyAll();
+	world._clearChangeHistory();
+	world._handles.Restore(std::move(slots), header.FreeHead);
+
+	std::vector<void*> batch;
+	std::vector<uint32_t> tags;
+	try
+	{
+		for (const auto& record : classes)
+		{
+			if (record.Count == 0)
+				continue;
+
+			const auto& descriptor{ world._entityFactory.GetClassDescriptor(record.ClassId) };
+			batch.resize(record.Count);
+			world._objectsAllocator.AllocateBatch(descriptor.AllocationSize, record.Count, batch.data());
+
+			[[maybe_unused]] const uint64_t numOfRestored{ world.GetNumOfWorldObjects() };
+			uint64_t constructed{};
+			try
+			{
+				for (; constructed < record.Count; constructed++)
+				{
+					batch[constructed] = world._entityFactory.PlacementNewFromClassId(batch[constructed], &world, record.ClassId, &world._runtimeComponentsAllocator, &world._frameComponentsAllocator);
+				}
+			}
+			catch (...)
+			{
+				for (uint64_t i{}; i < constructed; i++)
+				{
+					descriptor.Destroy(static_cast<CWorldObject*>(batch[i]));
+				}
+				world._objectsAllocator.FreeBatch(batch.data(), record.Count);
+				throw;
+			}
+			assert(world.GetNumOfWorldObjects() == numOfRestored && "Constructors must not spawn while restoring");
+
+			// The fresh components are overwritten with the saved ones, fixed offsets need no relocation
+			const uint8_t* block{ record.Blocks };
+			const uint8_t* tag{ record.Tags };
+			for (uint64_t i{}; i < record.Count; i++, block += record.BlockBytes)
+			{
+				CWorldObject* const object{ static_cast<CWorldObject*>(batch[i]) };
+				std::memcpy(reinterpret_cast<uint8_t*>(object) + record.BlockOffset, block, record.BlockBytes);
+
+				const uint32_t numOfTags{ LoadUnaligned<uint32_t>(record.TagCounts, i) };
+				tags.resize(numOfTags);
+				for (uint32_t t{}; t < numOfTags; t++, tag += sizeof(uint32_t))
+				{
+					tags[t] = tagIds[LoadUnaligned<uint32_t>(tag, 0)];
+				}
+
+				world._addRestored(object, LoadUnaligned<DWorldObjectHandle>(record.Handles, i), tags.data(), numOfTags);
+			}
+		}
+	}
+	catch (...)
+	{
+		world._destroyAll();
+		world._handles.Restore({}, CGenerationalIdGenerator::FREE_LIST_END);
+		throw;
+	}
+}
@@ -1,6 +1,12 @@
 
 
 #include <array>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <algorithm>
 #include "limits"
 
 #include "gtest/gtest.h"
@@ -10,6 +16,21 @@
 #include "necs/CEntityFactory.h"
 #include "necs/CWorldObject.h"
 #include "necs/CMatrixAllocator.h"
+#include "necs/CSlabPageMap.h"
+#include "necs/CConcurrentPagedAllocator.h"
+#include "necs/CDenseComponentStore.h"
+#include "necs/CTickManager.h"
+#include "necs/CJobSystem.h"
+#include "necs/CWorld.h"
+#include "necs/CTagRegistry.h"
+#include "necs/CHandleTable.h"
+#include "necs/CConcurrentIDGenerator.h"
+#include "necs/CFrameArenaAllocator.h"
+#include "necs/CVirtualMemoryAllocator.h"
+#include "necs/CWorldSnapshot.h"
+#include "necs/CLevelImage.h"
+#include "necs/CMappedFile.h"
+#include "necs/CChromeTraceSink.h"
 
 #pragma region CPagedAllocator
 
@@ -20,6 +41,25 @@ public:
 	MOCK_METHOD(void, Free, (void*), (override));
 };
 
+class CHeapAlignedAllocatorStub final : public IAlignedAllocator
+{
+public:
+	void* Allocate(const uint64_t bytes, const uint64_t alignement) override {
+#if _WIN32
+		return _aligned_malloc(bytes, alignement);
+#else
+		return std::aligned_alloc(alignement, ((bytes + alignement - 1) / alignement) * alignement);
+#endif
+	};
+	void Free(void* ptr) override {
+#if _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	};
+};
+
 // Test fixture for reusing common setup and teardown logic
 class CPagedAllocatorFixture : public ::testing::Test {
 protected:
@@ -27,7 +67,7 @@ protected:
 	inline static constexpr uint64_t SIZE_OF_OBJECTS{ 32 };
 
 	CPagedAllocator<CAlignedAllocatorMock>* AllocatorUnderTest{};
-	alignas(max_align_t) std::array<uint8_t, NUM_OF_OBJECTS* SIZE_OF_OBJECTS * sizeof(freelist_block)> Buffer{};
+	alignas(sizeof(max_align_t)) std::array<uint8_t, NUM_OF_OBJECTS* SIZE_OF_OBJECTS * sizeof(max_align_t)> Buffer{};
 
 	void SetUp() override {
 		AllocatorUnderTest = new CPagedAllocator<CAlignedAllocatorMock>(NUM_OF_OBJECTS, SIZE_OF_OBJECTS);
@@ -54,6 +94,8 @@ protected:
 		EXPECT_CALL(AllocatorUnderTest->_alignedAllocator, Allocate).Times(times).WillRepeatedly(::testing::Return(Buffer.data()));
 		EXPECT_CALL(AllocatorUnderTest->_alignedAllocator, Free).Times(times);
 	}
+
+	CAlignedAllocatorMock& GetAlignedAllocatorMock() { return AllocatorUnderTest->_alignedAllocator; }
 };
 
 TEST_F(CPagedAllocatorFixture, DoesntAllocateOnConstruction) {
@@ -99,6 +141,370 @@ TEST_F(CPagedAllocatorFixture, AllocateThenFreeMultiplePages) {
 	AllocatorUnderTest = nullptr;
 }
 
+TEST_F(CPagedAllocatorFixture, MustReuseFreedBlockBeforeGrowing) {
+	SetAllocatorReturnsBuffer(1);
+
+	std::array<void*, NUM_OF_OBJECTS> allocations{};
+	for (auto& allocation : allocations)
+	{
+		allocation = AllocatorUnderTest->Allocate();
+	}
+
+	AllocatorUnderTest->Free(allocations[3]);
+	EXPECT_EQ(AllocatorUnderTest->Allocate(), allocations[3]);
+}
+
+TEST_F(CPagedAllocatorFixture, MustGrowOnlyWhenEverySlabIsFull) {
+	alignas(sizeof(max_align_t)) std::array<uint8_t, NUM_OF_OBJECTS* SIZE_OF_OBJECTS * sizeof(max_align_t)> secondBuffer{};
+	EXPECT_CALL(GetAlignedAllocatorMock(), Allocate).Times(2).WillOnce(::testing::Return(Buffer.data())).WillOnce(::testing::Return(secondBuffer.data()));
+	EXPECT_CALL(GetAlignedAllocatorMock(), Free).Times(2);
+
+	std::array<void*, NUM_OF_OBJECTS> firstSlab{};
+	for (auto& allocation : firstSlab)
+	{
+		allocation = AllocatorUnderTest->Allocate();
+		EXPECT_GE(reinterpret_cast<uintptr_t>(allocation), reinterpret_cast<uintptr_t>(Buffer.data()));
+		EXPECT_LT(reinterpret_cast<uintptr_t>(allocation), reinterpret_cast<uintptr_t>(Buffer.data() + Buffer.size()));
+	}
+
+	void* const secondSlabAllocation{ AllocatorUnderTest->Allocate() };
+	EXPECT_EQ(secondSlabAllocation, secondBuffer.data());
+
+	// Once the current slab is full the freed block of the first slab is found again through the bitmap
+	AllocatorUnderTest->Free(firstSlab[0]);
+	for (uint64_t i{ 1 }; i < NUM_OF_OBJECTS; i++)
+	{
+		EXPECT_NE(AllocatorUnderTest->Allocate(), firstSlab[0]);
+	}
+	EXPECT_EQ(AllocatorUnderTest->Allocate(), firstSlab[0]);
+
+	delete AllocatorUnderTest;
+	AllocatorUnderTest = nullptr;
+}
+
+TEST_F(CPagedAllocatorFixture, MustAllocateBatchAsContiguousRun) {
+	SetAllocatorReturnsBuffer(1);
+
+	std::array<void*, NUM_OF_OBJECTS> allocations{};
+	AllocatorUnderTest->AllocateBatch(allocations.size(), allocations.data());
+
+	for (uint64_t i{ 1 }; i < allocations.size(); i++)
+	{
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(allocations[i]) - reinterpret_cast<uintptr_t>(allocations[i - 1]), SIZE_OF_OBJECTS);
+	}
+}
+
+TEST_F(CPagedAllocatorFixture, MustFreeBatchAndReuseEveryBlock) {
+	SetAllocatorReturnsBuffer(1);
+
+	std::array<void*, NUM_OF_OBJECTS> allocations{};
+	AllocatorUnderTest->AllocateBatch(allocations.size(), allocations.data());
+	AllocatorUnderTest->FreeBatch(allocations.data(), allocations.size());
+
+	// The slab is reused entirely, no new slab is requested
+	std::array<void*, NUM_OF_OBJECTS> reallocations{};
+	AllocatorUnderTest->AllocateBatch(reallocations.size(), reallocations.data());
+	EXPECT_TRUE(std::is_permutation(allocations.begin(), allocations.end(), reallocations.begin()));
+}
+
+TEST_F(CPagedAllocatorFixture, MustSpanBatchOverMultipleSlabs) {
+	alignas(sizeof(max_align_t)) std::array<uint8_t, NUM_OF_OBJECTS* SIZE_OF_OBJECTS * sizeof(max_align_t)> secondBuffer{};
+	EXPECT_CALL(GetAlignedAllocatorMock(), Allocate).Times(2).WillOnce(::testing::Return(Buffer.data())).WillOnce(::testing::Return(secondBuffer.data()));
+	EXPECT_CALL(GetAlignedAllocatorMock(), Free).Times(2);
+
+	std::array<void*, NUM_OF_OBJECTS + 1> allocations{};
+	AllocatorUnderTest->AllocateBatch(allocations.size(), allocations.data());
+	EXPECT_EQ(allocations.back(), secondBuffer.data());
+
+	delete AllocatorUnderTest;
+	AllocatorUnderTest = nullptr;
+}
+
+TEST(CPagedAllocatorCheckedTest, MustThrowOnDoubleFree) {
+	CPagedAllocator<CHeapAlignedAllocatorStub, true> allocator(4, 32);
+	void* const block{ allocator.Allocate() };
+	allocator.Free(block);
+
+	EXPECT_THROW(allocator.Free(block), std::runtime_error);
+}
+
+TEST(CPagedAllocatorCheckedTest, MustThrowOnPointerInsideABlock) {
+	CPagedAllocator<CHeapAlignedAllocatorStub, true> allocator(4, 32);
+	uint8_t* const block{ reinterpret_cast<uint8_t*>(allocator.Allocate()) };
+
+	EXPECT_THROW(allocator.Free(block + 8), std::runtime_error);
+}
+
+TEST(CPagedAllocatorCheckedTest, MustThrowOnWriteAfterFree) {
+	CPagedAllocator<CHeapAlignedAllocatorStub, true> allocator(4, 32);
+	uint8_t* const block{ reinterpret_cast<uint8_t*>(allocator.Allocate()) };
+	allocator.Free(block);
+	block[16] = 0;
+
+	EXPECT_THROW(allocator.Allocate(), std::runtime_error);
+}
+
+TEST(CPagedAllocatorUncheckedTest, MustAllocateAndReuseBlocks) {
+	CPagedAllocator<CHeapAlignedAllocatorStub, false> allocator(4, 32);
+	void* const block{ allocator.Allocate() };
+	allocator.Free(block);
+
+	EXPECT_EQ(allocator.Allocate(), block);
+}
+
+TEST(CPagedAllocatorSlabGranularityTest, MustFillTheRoundedSlab) {
+	CPagedAllocator<CHeapAlignedAllocatorStub> allocator(10, 32);
+	allocator.SetSlabGranularity(1024);
+
+	// 10 blocks rounded up to 1024 bytes hold 32 blocks in a single slab
+	std::vector<uintptr_t> blocks;
+	for (uint64_t i{}; i < 32; i++)
+		blocks.push_back(reinterpret_cast<uintptr_t>(allocator.Allocate()));
+	std::sort(blocks.begin(), blocks.end());
+	EXPECT_EQ(blocks.back() - blocks.front(), 31u * 32u);
+
+	for (const auto block : blocks)
+		allocator.Free(reinterpret_cast<void*>(block));
+}
+
+TEST(CPagedAllocatorReclamationTest, MustReleaseEmptySlabsBeyondTheRetention) {
+	CPagedAllocator<CHeapAlignedAllocatorStub> allocator(4, 32);
+	std::vector<void*> blocks(16);
+	allocator.AllocateBatch(blocks.size(), blocks.data());
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 4u);
+
+	// Unbounded retention keeps every slab
+	allocator.FreeBatch(blocks.data(), 8);
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 4u);
+	EXPECT_EQ(allocator.GetNumOfEmptySlabs(), 2u);
+
+	allocator.SetEmptySlabRetention(1);
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 3u);
+	EXPECT_EQ(allocator.GetNumOfEmptySlabs(), 1u);
+
+	allocator.FreeBatch(blocks.data() + 8, 8);
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 1u);
+	EXPECT_EQ(allocator.GetNumOfEmptySlabs(), 1u);
+	EXPECT_EQ(allocator.ReleaseEmptySlabs(), 4u * 32u);
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 0u);
+
+	// Released slab indices are reused
+	allocator.AllocateBatch(blocks.size(), blocks.data());
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 4u);
+	allocator.FreeBatch(blocks.data(), blocks.size());
+}
+
+TEST(CPagedAllocatorReclamationTest, MustRelocateBlocksOutOfSparseSlabs) {
+	CPagedAllocator<CHeapAlignedAllocatorStub> allocator(4, 32);
+	allocator.SetEmptySlabRetention(0);
+
+	std::vector<uint64_t*> blocks(12);
+	allocator.AllocateBatch(blocks.size(), reinterpret_cast<void**>(blocks.data()));
+	for (uint64_t i{}; i < blocks.size(); i++)
+		*blocks[i] = i;
+
+	// Leave one block in the first slab, one free block in the second and keep the third full
+	allocator.Free(blocks[1]);
+	allocator.Free(blocks[2]);
+	allocator.Free(blocks[3]);
+	allocator.Free(blocks[4]);
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 3u);
+
+	std::vector<uint64_t> moved;
+	const auto relocated{ allocator.Defragment([&moved](void* from, void* to) {
+		moved.push_back(*static_cast<uint64_t*>(from));
+		*static_cast<uint64_t*>(to) = *static_cast<uint64_t*>(from);
+		return true;
+		}) };
+
+	EXPECT_EQ(relocated, 1u);
+	EXPECT_THAT(moved, ::testing::ElementsAre(0u));
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 2u);
+}
+
+TEST(CPagedAllocatorReclamationTest, MustKeepPinnedBlocksInPlace) {
+	CPagedAllocator<CHeapAlignedAllocatorStub> allocator(4, 32);
+	std::vector<void*> blocks(8);
+	allocator.AllocateBatch(blocks.size(), blocks.data());
+	allocator.Free(blocks[1]);
+	allocator.Free(blocks[2]);
+	allocator.Free(blocks[3]);
+	allocator.Free(blocks[4]);
+
+	EXPECT_EQ(allocator.Defragment([](void*, void*) { return false; }), 0u);
+	EXPECT_EQ(allocator.GetNumOfSlabs(), 2u);
+
+	// Every block is still handed out exactly once
+	allocator.Free(blocks[0]);
+	for (uint64_t i{ 5 }; i < blocks.size(); i++)
+		allocator.Free(blocks[i]);
+	EXPECT_EQ(allocator.GetNumOfEmptySlabs(), 2u);
+}
+
+#pragma endregion
+
+#pragma region CVirtualMemoryAllocator
+TEST(CVirtualMemoryAllocatorTest, MustCommitWholePagesAndReuseFreedRanges) {
+	CVirtualMemoryAllocator allocator;
+	const uint64_t pageSize{ CVirtualMemoryAllocator::GetSystemPageSize() };
+	EXPECT_EQ(allocator.GetAllocationGranularity(), pageSize);
+
+	auto* const first{ static_cast<uint8_t*>(allocator.Allocate(100, 16)) };
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % pageSize, 0u);
+	EXPECT_EQ(allocator.GetCommittedBytes(), pageSize);
+	std::fill(first, first + pageSize, uint8_t(0xAB));
+
+	auto* const second{ static_cast<uint8_t*>(allocator.Allocate(pageSize + 1, 16)) };
+	EXPECT_EQ(allocator.GetCommittedBytes(), pageSize * 3);
+	std::fill(second, second + pageSize * 2, uint8_t(0xCD));
+	EXPECT_EQ(first[pageSize - 1], 0xAB);
+
+	allocator.Free(first);
+	EXPECT_EQ(allocator.GetCommittedBytes(), pageSize * 2);
+
+	// Decommitted pages come back zeroed
+	auto* const reused{ static_cast<uint8_t*>(allocator.Allocate(pageSize, 16)) };
+	EXPECT_EQ(reused, first);
+	EXPECT_EQ(reused[0], 0);
+
+	allocator.Free(reused);
+	allocator.Free(second);
+	EXPECT_EQ(allocator.GetCommittedBytes(), 0u);
+}
+
+TEST(CVirtualMemoryAllocatorTest, MustServeRequestsLargerThanARegion) {
+	DVirtualMemorySettings settings{};
+	settings.RegionBytes = CVirtualMemoryAllocator::GetSystemPageSize();
+	CVirtualMemoryAllocator allocator(settings);
+
+	auto* const ptr{ static_cast<uint8_t*>(allocator.Allocate(settings.RegionBytes * 4, 16)) };
+	ptr[settings.RegionBytes * 4 - 1] = 1;
+	EXPECT_EQ(allocator.GetCommittedBytes(), settings.RegionBytes * 4);
+	allocator.Free(ptr);
+}
+
+TEST(CVirtualMemoryAllocatorTest, MustSizeSlabsToWholePages) {
+	// 10 blocks of 32 bytes are rounded up to a page
+	CPagedAllocator<CVirtualMemoryAllocator> allocator(10, 32);
+	const uint64_t blocksPerPage{ CVirtualMemoryAllocator::GetSystemPageSize() / 32 };
+
+	std::vector<uintptr_t> blocks;
+	for (uint64_t i{}; i < blocksPerPage; i++)
+		blocks.push_back(reinterpret_cast<uintptr_t>(allocator.Allocate()));
+	std::sort(blocks.begin(), blocks.end());
+	EXPECT_EQ(blocks.back() - blocks.front(), (blocksPerPage - 1) * 32);
+
+	for (const auto block : blocks)
+		allocator.Free(reinterpret_cast<void*>(block));
+}
+
+TEST(CVirtualMemoryAllocatorTest, MustKeepTheSlabsMappedWhenMoved) {
+	auto source{ std::make_unique<CPagedAllocator<CVirtualMemoryAllocator>>(10, 32) };
+	auto* const block{ static_cast<uint8_t*>(source->Allocate()) };
+
+	CPagedAllocator<CVirtualMemoryAllocator> allocator(std::move(*source));
+	source.reset();
+	std::fill(block, block + 32, uint8_t(1));
+	auto* const other{ allocator.Allocate() };
+	EXPECT_NE(other, block);
+	allocator.Free(block);
+	allocator.Free(other);
+}
+
+TEST(CVirtualMemoryAllocatorTest, MustRoundToHugePagesWhenRequested) {
+	CHugePageAllocator<0> allocator;
+	EXPECT_GE(allocator.GetAllocationGranularity(), CVirtualMemoryAllocator::GetSystemPageSize());
+
+	auto* const ptr{ static_cast<uint8_t*>(allocator.Allocate(64, 16)) };
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % allocator.GetAllocationGranularity(), 0u);
+	EXPECT_EQ(allocator.GetCommittedBytes(), allocator.GetAllocationGranularity());
+	std::fill(ptr, ptr + allocator.GetAllocationGranularity(), uint8_t(1));
+	allocator.Free(ptr);
+}
+#pragma endregion
+
+#pragma region CConcurrentPagedAllocator
+
+class CConcurrentPagedAllocatorTest : public ::testing::Test {
+protected:
+	inline static constexpr uint64_t NUM_OF_THREADS{ 4 };
+	inline static constexpr uint64_t NUM_OF_OBJECTS{ 1000 };
+	inline static constexpr uint64_t MAGAZINE_SIZE{ 8 };
+
+	using CAllocatorUnderTest = CConcurrentPagedAllocator<CHeapAlignedAllocatorStub, MAGAZINE_SIZE>;
+	CAllocatorUnderTest AllocatorUnderTest{ 16, sizeof(uint64_t) };
+
+	uint64_t GetRemoteCount()const { return AllocatorUnderTest._remoteCount.load(); }
+};
+
+TEST_F(CConcurrentPagedAllocatorTest, MustReuseBlocksFreedByTheSameThread)
+{
+	void* const block{ AllocatorUnderTest.Allocate() };
+	AllocatorUnderTest.Free(block);
+	EXPECT_EQ(AllocatorUnderTest.Allocate(), block);
+}
+
+TEST_F(CConcurrentPagedAllocatorTest, MustNeverHandOutTheSameBlockTwice)
+{
+	std::array<std::vector<void*>, NUM_OF_THREADS> allocations{};
+	std::vector<std::thread> threads;
+	for (uint64_t t{}; t < NUM_OF_THREADS; t++)
+	{
+		threads.emplace_back([this, t, &allocations]() {
+			for (uint64_t i{}; i < NUM_OF_OBJECTS; i++)
+			{
+				uint64_t* const block{ reinterpret_cast<uint64_t*>(AllocatorUnderTest.Allocate()) };
+				*block = t;
+				allocations[t].push_back(block);
+				// Churn to exercise magazine refills and flushes
+				if (i % 3 == 0)
+				{
+					AllocatorUnderTest.Free(allocations[t].back());
+					allocations[t].pop_back();
+				}
+			}
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	std::unordered_set<void*> unique;
+	for (uint64_t t{}; t < NUM_OF_THREADS; t++)
+	{
+		for (void* block : allocations[t])
+		{
+			EXPECT_EQ(*reinterpret_cast<uint64_t*>(block), t);
+			EXPECT_TRUE(unique.insert(block).second);
+		}
+	}
+}
+
+TEST_F(CConcurrentPagedAllocatorTest, MustReturnCrossThreadFreesThroughTheRemoteList)
+{
+	std::vector<void*> allocations;
+	for (uint64_t i{}; i < NUM_OF_OBJECTS; i++)
+	{
+		allocations.push_back(AllocatorUnderTest.Allocate());
+	}
+
+	std::thread freeingThread([this, &allocations]() {
+		for (void* block : allocations)
+		{
+			AllocatorUnderTest.Free(block);
+		}
+		});
+	freeingThread.join();
+
+	// The freeing thread overflowed its magazine into the remote list
+	EXPECT_GT(GetRemoteCount(), 0u);
+
+	const std::unordered_set<void*> freed(allocations.begin(), allocations.end());
+	EXPECT_EQ(freed.count(AllocatorUnderTest.Allocate()), 1u);
+
+	AllocatorUnderTest.Trim();
+	EXPECT_EQ(GetRemoteCount(), 0u);
+}
+
 #pragma endregion
 
 #pragma region CMatrixAllocator
@@ -111,7 +517,11 @@ public:
 
 	void* Allocate() override { return (void*)&BlockSize; };
 	void Free(void* ptr) override {};
+	void AllocateBatch(const uint64_t count, void** const out) override { std::fill(out, out + count, (void*)&BlockSize); };
+	void FreeBatch(void* const* const ptrs, const uint64_t count) override {};
+	void FreeFromSlab(void* ptr, const uint64_t slabIndex) override {};
 	uint64_t GetFixedBlockSize()const override { return BlockSize; };
+	void SetSlabListener(IPagedAllocatorSlabListener* const listener) override {};
 
 	volatile const uint64_t BlockSize;
 };
@@ -134,156 +544,653 @@ TEST(CMatrixAllocatorTest, ShouldAllocateCorrectPageForDifferentSizeTypes)
 	for (uint64_t i{ 1 }; i < UINT32_MAX; i += UINT32_MAX / 10)
 	{
 		const uint64_t* const blockSize{ reinterpret_cast<const uint64_t* const>(allocator.Allocate(i)) };
-		EXPECT_EQ(*blockSize, i);
-		EXPECT_EQ(allocator._perSizeAllocator.size(), ++expectedNumOfAllocators);
+		EXPECT_EQ(*blockSize, allocator.GetClassSize(i));
+		const auto numOfClassColumns{ std::count_if(allocator._sizeClasses.begin(), allocator._sizeClasses.end(), [](const auto& column) { return column != nullptr; }) };
+		EXPECT_EQ(numOfClassColumns + allocator._largeSizeAllocators.size(), ++expectedNumOfAllocators);
 	}
 }
 
-#pragma endregion
-
-#pragma region CEntityFactory
-// Test fixture for reusing common setup and teardown logic
-class CEntityFactoryFixture : public ::testing::Test {
-protected:
-	struct CTestWorldObject : public CWorldObject
+TEST(CMatrixAllocatorTest, MustRoundSizesToGeometricClasses)
+{
+	CMatrixAllocator<CPagedAllocatorStub> allocator(1);
+	const std::vector<std::pair<uint64_t, uint64_t>> expected{ {1, 16}, {16, 16}, {17, 32}, {64, 64}, {65, 80}, {128, 128}, {129, 160}, {257, 320}, {1000, 1024}, {1025, 1280} };
+	for (const auto& [bytes, classSize] : expected)
 	{
-		CTestWorldObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {}
-		double A{};
-	};
-
-	CEntityFactory* FactoryUnderTest{};
-
-	void SetUp() override {
-		FactoryUnderTest = new CEntityFactory();
+		EXPECT_EQ(allocator.GetClassSize(bytes), classSize);
+		EXPECT_EQ(*reinterpret_cast<const uint64_t*>(allocator.Allocate(bytes)), classSize);
 	}
 
-	void TearDown() override {
-		delete FactoryUnderTest;
+	// Internal fragmentation stays below a quarter of the block
+	for (uint64_t bytes{ 65 }; bytes < 100000; bytes += 7)
+	{
+		const uint64_t classSize{ allocator.GetClassSize(bytes) };
+		EXPECT_GE(classSize, bytes);
+		EXPECT_LT(classSize - bytes, classSize / 4);
 	}
+}
 
-	const std::unordered_map<std::string, std::pair<CEntityFactory::CreateFunc, std::unique_ptr<CWorldObject>>>& GetClassNamesMap()const { return FactoryUnderTest->_classNameToCreateFnAndCdo; }
-};
+TEST(CMatrixAllocatorTest, MustShareSlabsBetweenSizesOfTheSameClass)
+{
+	CMatrixAllocator<CPagedAllocator<CHeapAlignedAllocatorStub>> allocator(4);
+	void* const first{ allocator.Allocate(100) };
+	void* const second{ allocator.Allocate(112) };
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(second) - reinterpret_cast<uintptr_t>(first), 112u);
 
-TEST_F(CEntityFactoryFixture, MustRegisterClassName) {
-	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+	allocator.Free(first);
+	EXPECT_EQ(allocator.Allocate(97), first);
+}
 
-	EXPECT_NE(GetClassNamesMap().find("CTestWorldObject"), GetClassNamesMap().end());
-};
+TEST(CMatrixAllocatorTest, MustHonorTheSizeClassPolicy)
+{
+	DSizeClassPolicy policy{};
+	policy.StepsPerDoubling = 1;
+	policy.MaxClassSize = 1024;
+	CMatrixAllocator<CPagedAllocatorStub> allocator(1, policy);
+
+	EXPECT_EQ(allocator.GetClassSize(17), 32u);
+	EXPECT_EQ(allocator.GetClassSize(600), 1024u);
+	// Above the table sizes are exact
+	EXPECT_EQ(allocator.GetClassSize(1025), 1025u);
+	EXPECT_EQ(*reinterpret_cast<const uint64_t*>(allocator.Allocate(1025)), 1025u);
+}
 
-TEST_F(CEntityFactoryFixture, MustThrowIfRegisterClassNameTwice) {
-	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
-	EXPECT_DEATH(FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject"), ".*");
-};
+TEST(CMatrixAllocatorTest, MustFreeIntoTheOwningSizeClass)
+{
+	CMatrixAllocator<CPagedAllocator<CHeapAlignedAllocatorStub>> allocator(4);
 
-TEST_F(CEntityFactoryFixture, MustAssertIfMemoryIsNullptr) {
-	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
-	EXPECT_DEATH(FactoryUnderTest->PlacementNewFromTypename(nullptr, nullptr, "CTestWorldObject"), ".*");
-};
+	void* const small{ allocator.Allocate(32) };
+	void* const big{ allocator.Allocate(256) };
+	EXPECT_NE(small, nullptr);
+	EXPECT_NE(big, nullptr);
 
-TEST_F(CEntityFactoryFixture, MustAssertIfPendingDestroyedIsNullptr) {
-	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
-	EXPECT_DEATH(FactoryUnderTest->PlacementNewFromTypename(nullptr, nullptr, "CTestWorldObject"), ".*");
-};
+	allocator.Free(small);
+	allocator.Free(big);
 
-TEST_F(CEntityFactoryFixture, MustNotAssertWhenQueryingClassCDO) {
-	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+	EXPECT_EQ(allocator.Allocate(32), small);
+	EXPECT_EQ(allocator.Allocate(256), big);
+}
 
-	EXPECT_NO_FATAL_FAILURE(FactoryUnderTest->GetCDOFromTypename("CTestWorldObject"));
-};
+TEST(CMatrixAllocatorTest, MustAllocateAndFreeBatch)
+{
+	CMatrixAllocator<CPagedAllocator<CHeapAlignedAllocatorStub>> allocator(64);
 
-TEST_F(CEntityFactoryFixture, MustAssertWhenQueryingNonRegisteredClassCDO) {
-	EXPECT_DEATH(FactoryUnderTest->GetCDOFromTypename("CTestWorldObject"), ".*");
-};
+	std::array<void*, 10> allocations{};
+	allocator.AllocateBatch(48, allocations.size(), allocations.data());
+	for (uint64_t i{ 1 }; i < allocations.size(); i++)
+	{
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(allocations[i]) - reinterpret_cast<uintptr_t>(allocations[i - 1]), 48u);
+	}
 
-TEST_F(CEntityFactoryFixture, MustReturnCorrectCDOData) {
-	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+	allocator.FreeBatch(allocations.data(), allocations.size());
+	EXPECT_NE(std::find(allocations.begin(), allocations.end(), allocator.Allocate(48)), allocations.end());
+}
 
-	EXPECT_EQ(GetClassNamesMap().find("CTestWorldObject")->second.second->GetClassSize(), sizeof(CTestWorldObject));
-	EXPECT_EQ(GetClassNamesMap().find("CTestWorldObject")->second.second->GetClassAlignment(), alignof(CTestWorldObject));
-	EXPECT_EQ(GetClassNamesMap().find("CTestWorldObject")->second.second->ComputeComponentsMaxSizeForAllocation(), 0u);
-	EXPECT_EQ(GetClassNamesMap().find("CTestWorldObject")->second.second->GetCDOComponentsInfo().size(), 0u);
-};
+TEST(CMatrixAllocatorTest, MustIgnoreFreeOfNotOwnedPointer)
+{
+	CMatrixAllocator<CPagedAllocator<CHeapAlignedAllocatorStub>> allocator(4);
+	allocator.Allocate(32);
+
+	uint64_t notOwned{};
+	EXPECT_NO_FATAL_FAILURE(allocator.Free(&notOwned));
+}
 
 #pragma endregion
 
-#pragma region CWorldObject
+#pragma region CSlabPageMap
 
-TEST(CWorldObjectCDOZeroSizeTest, MustAssertOnZeroClassSizeWhenCDO) {
-	EXPECT_DEATH(CWorldObjectCDO(true, 0, 0), ".*");
-};
+class CSlabPageMapTest : public ::testing::Test {
+protected:
+	alignas(CSlabPageMap::PAGE_SIZE) inline static std::array<uint8_t, CSlabPageMap::PAGE_SIZE * 4> Slabs{};
 
-TEST(CWorldObjectCDOZeroSizeTest, MustAssertOnZeroClassSizeWhenNotCDO) {
-	EXPECT_DEATH(CWorldObjectCDO(false, 0, 0), ".*");
-};
+	CSlabPageMap PageMapUnderTest;
+	CPagedAllocatorStub OwnerA{ 1, 8 };
+	CPagedAllocatorStub OwnerB{ 1, 16 };
 
-class CWorldObjectCDOFixture : public ::testing::Test {
-protected:
-	inline static constexpr uint64_t CLASS_SIZE{ 32 };
-	inline static constexpr uint64_t CLASS_ALIGNMENT{ 8 };
-	CWorldObjectCDO* cdo{};
+	uint64_t GetNumOfPages()const { return PageMapUnderTest._pageToOwner.size(); }
+};
 
-	void SetUp() override {
-		cdo = new CWorldObjectCDO(true, CLASS_SIZE, CLASS_ALIGNMENT);
-	}
+TEST_F(CSlabPageMapTest, MustResolveOwnerForEveryAddressInsideTheSlab)
+{
+	PageMapUnderTest.OnSlabAllocated(&OwnerA, 0, Slabs.data(), CSlabPageMap::PAGE_SIZE * 2);
+	PageMapUnderTest.OnSlabAllocated(&OwnerB, 3, Slabs.data() + CSlabPageMap::PAGE_SIZE * 2, CSlabPageMap::PAGE_SIZE * 2);
 
-	void TearDown() override {
-		delete cdo;
+	for (uint64_t i{}; i < CSlabPageMap::PAGE_SIZE * 2; i += 64)
+	{
+		EXPECT_EQ(PageMapUnderTest.Find(Slabs.data() + i).Allocator, &OwnerA);
+		EXPECT_EQ(PageMapUnderTest.Find(Slabs.data() + i).SlabIndex, 0u);
+		EXPECT_EQ(PageMapUnderTest.Find(Slabs.data() + CSlabPageMap::PAGE_SIZE * 2 + i).Allocator, &OwnerB);
+		EXPECT_EQ(PageMapUnderTest.Find(Slabs.data() + CSlabPageMap::PAGE_SIZE * 2 + i).SlabIndex, 3u);
 	}
+	EXPECT_EQ(GetNumOfPages(), 4u);
+}
 
-};
+TEST_F(CSlabPageMapTest, MustForgetReleasedSlabs)
+{
+	PageMapUnderTest.OnSlabAllocated(&OwnerA, 0, Slabs.data(), CSlabPageMap::PAGE_SIZE);
+	PageMapUnderTest.OnSlabReleased(&OwnerA, 0, Slabs.data(), CSlabPageMap::PAGE_SIZE);
 
-TEST_F(CWorldObjectCDOFixture, MustReturnIsCdoTrue) {
-	EXPECT_EQ(cdo->IsCDO(), true);
-};
+	EXPECT_EQ(PageMapUnderTest.Find(Slabs.data()).Allocator, nullptr);
+	EXPECT_EQ(GetNumOfPages(), 0u);
+}
 
-TEST_F(CWorldObjectCDOFixture, MustHaveExpectedClassSize) {
-	EXPECT_EQ(cdo->GetClassSize(), CLASS_SIZE);
-};
+TEST_F(CSlabPageMapTest, MustDieWhenSlabIsNotPageAligned)
+{
+	EXPECT_DEATH(PageMapUnderTest.OnSlabAllocated(&OwnerA, 0, Slabs.data() + 8, CSlabPageMap::PAGE_SIZE), ".*");
+}
 
-TEST_F(CWorldObjectCDOFixture, MustHaveExpectedClassAlignment) {
-	EXPECT_EQ(cdo->GetClassAlignment(), CLASS_ALIGNMENT);
-};
+#pragma endregion
 
-TEST_F(CWorldObjectCDOFixture, MustReturnZeroBytesForZeroComponents) {
-	EXPECT_EQ(cdo->ComputeComponentsMaxSizeForAllocation(), 0);
-};
+#pragma region CDenseComponentStore
 
-TEST_F(CWorldObjectCDOFixture, MustReturnEmptyComponentsInfo) {
-	EXPECT_EQ(cdo->GetCDOComponentsInfo().size(), 0);
+struct DTransformComponent
+{
+	float X{}, Y{}, Z{};
 };
 
-TEST_F(CWorldObjectCDOFixture, MustReturnOneComponentsInfoForTemplateComponent) {
-	struct Component
+TEST(CDenseComponentStoreTest, MustResolveHandlesAfterRemovals)
+{
+	CDenseComponentStore<DTransformComponent> store;
+	std::vector<DDenseComponentHandle> handles;
+	for (uint64_t i{}; i < 10; i++)
 	{
-		uint32_t a, b, c, d;
-	};
-	constexpr uint64_t COMPONENT_SIZE{ sizeof(Component) };
-	constexpr uint64_t COMPONENT_ALIGNMENT{ alignof(Component) };
-	cdo->StaticRegisterNewComponent<Component>();
+		handles.push_back(store.Add(DTransformComponent{ static_cast<float>(i) }));
+	}
 
-	EXPECT_EQ(cdo->GetCDOComponentsInfo().size(), 1u);
-	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Size, COMPONENT_SIZE);
-	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Alignment, COMPONENT_ALIGNMENT);
-};
+	EXPECT_TRUE(store.Remove(handles[0]));
+	EXPECT_TRUE(store.Remove(handles[5]));
 
-TEST_F(CWorldObjectCDOFixture, MustReturnOneComponentsInfoForUnkownComponent) {
-	constexpr uint64_t COMPONENT_SIZE{ 16 };
-	constexpr uint64_t COMPONENT_ALIGNMENT{ 4 };
-	cdo->StaticRegisterNewComponentUnknown(COMPONENT_SIZE, COMPONENT_ALIGNMENT);
+	EXPECT_EQ(store.Size(), 8u);
+	EXPECT_EQ(store.Get(handles[0]), nullptr);
+	EXPECT_EQ(store.Get(handles[5]), nullptr);
+	for (uint64_t i : { 1, 2, 3, 4, 6, 7, 8, 9 })
+	{
+		ASSERT_NE(store.Get(handles[i]), nullptr);
+		EXPECT_EQ(store.Get(handles[i])->X, static_cast<float>(i));
+	}
+}
 
-	EXPECT_EQ(cdo->GetCDOComponentsInfo().size(), 1u);
-	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Size, COMPONENT_SIZE);
-	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Alignment, COMPONENT_ALIGNMENT);
-};
+TEST(CDenseComponentStoreTest, MustKeepComponentsPacked)
+{
+	CDenseComponentStore<DTransformComponent> store;
+	const DDenseComponentHandle first{ store.Add() };
+	store.Add(DTransformComponent{ 1.f });
+	store.Add(DTransformComponent{ 2.f });
+	store.Remove(first);
+
+	float sum{};
+	for (const auto& transform : store)
+	{
+		sum += transform.X;
+	}
+	EXPECT_EQ(sum, 3.f);
+	EXPECT_EQ(store.Data() + 1, store.Get(store.GetHandleAt(1)));
+}
 
-TEST_F(CWorldObjectCDOFixture, MustAssertIfComponentSizeIsZero) {
+TEST(CDenseComponentStoreTest, MustNotAliasStaleHandleWithReusedSlot)
+{
+	CDenseComponentStore<DTransformComponent> store;
+	const DDenseComponentHandle stale{ store.Add() };
+	store.Remove(stale);
+	const DDenseComponentHandle fresh{ store.Add() };
+
+	EXPECT_EQ(fresh.Slot, stale.Slot);
+	EXPECT_NE(fresh, stale);
+	EXPECT_EQ(store.Get(stale), nullptr);
+	EXPECT_FALSE(store.Remove(stale));
+	EXPECT_NE(store.Get(fresh), nullptr);
+}
 
-	EXPECT_DEATH(cdo->StaticRegisterNewComponentUnknown(0, 2), ".*");
-};
+TEST(CDenseComponentStorageTest, MustReturnOneStorePerType)
+{
+	CDenseComponentStorage storage;
+	EXPECT_FALSE(storage.HasStore<DTransformComponent>());
 
-TEST_F(CWorldObjectCDOFixture, MustAssertIfComponentAlignmentIsZero) {
+	auto& transforms{ storage.GetStore<DTransformComponent>() };
+	EXPECT_EQ(&transforms, &storage.GetStore<DTransformComponent>());
+	EXPECT_NE(static_cast<void*>(&transforms), static_cast<void*>(&storage.GetStore<uint64_t>()));
+	EXPECT_TRUE(storage.HasStore<DTransformComponent>());
+}
 
-	EXPECT_DEATH(cdo->StaticRegisterNewComponentUnknown(2, 0), ".*");
+#pragma endregion
+
+#pragma region CConcurrentIDGenerator
+TEST(CConcurrentIDGeneratorTest, MustReuseReleasedIdsAndThrowWhenExhausted) {
+	CConcurrentIDGenerator<uint32_t> generator(2);
+	const auto first{ generator.Generate() };
+	const auto second{ generator.Generate() };
+	EXPECT_NE(first, second);
+	EXPECT_TRUE(generator.IsUsed(first));
+
+	uint32_t id{};
+	EXPECT_FALSE(generator.TryGenerate(id));
+	EXPECT_THROW(generator.Generate(), std::runtime_error);
+
+	generator.Release(first);
+	EXPECT_FALSE(generator.IsUsed(first));
+	EXPECT_THROW(generator.Release(first), std::invalid_argument);
+	EXPECT_EQ(generator.Generate(), first);
+	EXPECT_EQ(generator.GetMaxId(), 2u);
+}
+
+TEST(CConcurrentIDGeneratorTest, MustNeverHandOutTheSameIdTwiceAcrossThreads) {
+	constexpr uint32_t NUM_OF_THREADS{ 4 };
+	constexpr uint32_t IDS_PER_THREAD{ 256 };
+	constexpr uint32_t ITERATIONS{ 200 };
+	CConcurrentIDGenerator<uint32_t> generator(NUM_OF_THREADS * IDS_PER_THREAD);
+
+	std::array<std::vector<uint32_t>, NUM_OF_THREADS> held;
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < NUM_OF_THREADS; t++)
+	{
+		threads.emplace_back([&generator, &ids = held[t]]()
+			{
+				for (uint32_t i = 0; i < ITERATIONS; i++)
+				{
+					for (uint32_t j = 0; j < IDS_PER_THREAD; j++)
+						ids.push_back(generator.Generate());
+					// Keep the last round so the ids can be checked for uniqueness
+					if (i + 1 == ITERATIONS)
+						break;
+					for (const auto id : ids)
+						generator.Release(id);
+					ids.clear();
+				}
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	std::unordered_set<uint32_t> unique;
+	for (const auto& ids : held)
+	{
+		for (const auto id : ids)
+		{
+			EXPECT_TRUE(generator.IsUsed(id));
+			EXPECT_TRUE(unique.insert(id).second);
+		}
+	}
+	EXPECT_EQ(unique.size(), NUM_OF_THREADS * IDS_PER_THREAD);
+	EXPECT_LE(generator.GetMaxId(), NUM_OF_THREADS * IDS_PER_THREAD);
+}
+#pragma endregion
+
+#pragma region CFrameArenaAllocator
+TEST(CFrameArenaAllocatorTest, MustBumpAlignedAllocationsAndReuseChunksAfterTwoSwaps) {
+	CFrameArenaAllocator arena(256);
+	auto* const first{ static_cast<uint8_t*>(arena.Allocate(3, 1)) };
+	auto* const second{ static_cast<uint8_t*>(arena.Allocate(8, 8)) };
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 8, 0u);
+	EXPECT_GT(second, first);
+	EXPECT_LT(second - first, 16);
+
+	// Larger than a chunk, served by a dedicated one
+	EXPECT_NE(arena.Allocate(1024, 16), nullptr);
+	const auto reserved{ arena.GetReservedBytes() };
+
+	// The previous frame stays valid, the frame before it is reclaimed
+	arena.SwapFrames();
+	EXPECT_NE(arena.Allocate(3, 1), first);
+	arena.SwapFrames();
+	EXPECT_EQ(arena.Allocate(3, 1), first);
+	EXPECT_NE(arena.Allocate(1024, 16), nullptr);
+	EXPECT_EQ(arena.GetReservedBytes(), reserved + 256);
+}
+
+TEST(CFrameArenaAllocatorTest, MustThrowWhenTheBackingAllocatorFails) {
+	CAlignedAllocatorMock backing;
+	EXPECT_CALL(backing, Allocate(testing::_, testing::_)).WillOnce(testing::Return(nullptr));
+	EXPECT_CALL(backing, Free(testing::_)).Times(0);
+
+	CFrameArenaAllocator arena(256, &backing);
+	EXPECT_THROW(arena.Allocate(8, 8), std::bad_alloc);
+	EXPECT_EQ(arena.GetReservedBytes(), 0u);
+}
+
+TEST(CFrameArenaAllocatorTest, MustNeverOverlapConcurrentAllocations) {
+	constexpr uint32_t NUM_OF_THREADS{ 4 };
+	constexpr uint32_t ALLOCATIONS_PER_THREAD{ 4096 };
+	CFrameArenaAllocator arena(1024);
+
+	std::array<std::vector<uint64_t*>, NUM_OF_THREADS> allocations;
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < NUM_OF_THREADS; t++)
+	{
+		threads.emplace_back([&arena, &out = allocations[t], t]()
+			{
+				for (uint32_t i = 0; i < ALLOCATIONS_PER_THREAD; i++)
+				{
+					auto* const ptr{ static_cast<uint64_t*>(arena.Allocate(sizeof(uint64_t), alignof(uint64_t))) };
+					*ptr = uint64_t(t) << 32 | i;
+					out.push_back(ptr);
+				}
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	for (uint32_t t = 0; t < NUM_OF_THREADS; t++)
+	{
+		for (uint32_t i = 0; i < ALLOCATIONS_PER_THREAD; i++)
+		{
+			EXPECT_EQ(*allocations[t][i], uint64_t(t) << 32 | i);
+		}
+	}
+}
+#pragma endregion
+
+#pragma region CHandleTable
+TEST(CGenerationalIdGeneratorTest, MustBumpGenerationOnReuse) {
+	CGenerationalIdGenerator generator;
+	const auto first{ generator.Generate() };
+	EXPECT_TRUE(generator.IsUsed(first));
+
+	generator.Release(first);
+	EXPECT_FALSE(generator.IsUsed(first));
+
+	const auto second{ generator.Generate() };
+	EXPECT_EQ(second.Index, first.Index);
+	EXPECT_NE(second.Generation, first.Generation);
+	EXPECT_TRUE(generator.IsUsed(second));
+	EXPECT_FALSE(generator.IsUsed(first));
+	EXPECT_EQ(generator.GetMaxId().Index, 1u);
+}
+
+TEST(CGenerationalIdGeneratorTest, MustThrowReleasingStaleOrUnknownId) {
+	CGenerationalIdGenerator generator;
+	const auto id{ generator.Generate() };
+	generator.Release(id);
+
+	EXPECT_THROW(generator.Release(id), std::invalid_argument);
+	EXPECT_THROW(generator.Release(DGenerationalId{ 42, 0 }), std::invalid_argument);
+	EXPECT_FALSE(generator.IsUsed(DGenerationalId{}));
+}
+
+TEST(CGenerationalIdGeneratorTest, MustThrowPastTheLimit) {
+	CGenerationalIdGenerator generator(2);
+	generator.Generate();
+	const auto id{ generator.Generate() };
+	EXPECT_THROW(generator.Generate(), std::runtime_error);
+
+	generator.Release(id);
+	EXPECT_NO_THROW(generator.Generate());
+}
+
+TEST(CHandleTableTest, MustResolveOnlyLiveHandles) {
+	int a{}, b{};
+	CHandleTable<int> table;
+	const auto handleA{ table.Add(&a) };
+	const auto handleB{ table.Add(&b) };
+	EXPECT_EQ(table.Resolve(handleA), &a);
+	EXPECT_EQ(table.Resolve(handleB), &b);
+	EXPECT_EQ(table.Size(), 2u);
+
+	table.Remove(handleA);
+	EXPECT_EQ(table.Resolve(handleA), nullptr);
+
+	const auto handleC{ table.Add(&b) };
+	EXPECT_EQ(handleC.Index, handleA.Index);
+	EXPECT_EQ(table.Resolve(handleA), nullptr);
+	EXPECT_EQ(table.Resolve(handleC), &b);
+	EXPECT_EQ(table.Size(), 2u);
+}
+#pragma endregion
+
+#pragma region CTagSet
+TEST(CTagRegistryTest, MustInternSameNameToSameId) {
+	const auto enemy{ CTagRegistry::Intern("Enemy") };
+	const auto player{ CTagRegistry::Intern("Player") };
+
+	EXPECT_NE(enemy, player);
+	EXPECT_EQ(CTagRegistry::Intern("Enemy"), enemy);
+	EXPECT_EQ(CTagRegistry::GetName(player), "Player");
+	EXPECT_LT(enemy, CTagRegistry::Count());
+}
+
+TEST(CTagSetTest, MustAddEachTagOnce) {
+	CTagSet tags;
+	EXPECT_TRUE(tags.Add(3));
+	EXPECT_FALSE(tags.Add(3));
+	EXPECT_TRUE(tags.Contains(3));
+	EXPECT_FALSE(tags.Contains(4));
+	EXPECT_EQ(tags.Size(), 1u);
+}
+
+TEST(CTagSetTest, MustSpillPastInlineCapacityAndKeepTags) {
+	CTagSet tags;
+	constexpr uint32_t NUM_TAGS{ CTagSet::INLINE_CAPACITY * 4 };
+	for (uint32_t i{}; i < NUM_TAGS; i++)
+	{
+		EXPECT_TRUE(tags.Add(i));
+	}
+
+	CTagSet copy{ tags };
+	for (uint32_t i{}; i < NUM_TAGS; i++)
+	{
+		EXPECT_TRUE(tags.Contains(i));
+		EXPECT_TRUE(copy.Contains(i));
+	}
+
+	EXPECT_TRUE(tags.Remove(0));
+	EXPECT_FALSE(tags.Remove(0));
+	EXPECT_EQ(tags.Size(), NUM_TAGS - 1);
+	EXPECT_EQ(copy.Size(), NUM_TAGS);
+
+	tags.Clear();
+	EXPECT_TRUE(tags.IsEmpty());
+	EXPECT_TRUE(tags.Add(1));
+}
+#pragma endregion
+
+#pragma region CEntityFactory
+class CWorldObjectPendingDestroyNotifierMock : public IWorldObjectPendingDestroyNotifier
+{
+public:
+	MOCK_METHOD(void, MarkPendingDestroy, (class CWorldObject*), (override));
+};
+
+// Test fixture for reusing common setup and teardown logic
+class CEntityFactoryFixture : public ::testing::Test {
+protected:
+	struct CTestWorldObject : public CWorldObject
+	{
+		CTestWorldObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {}
+		double A{};
+	};
+
+	CEntityFactory* FactoryUnderTest{};
+
+	void SetUp() override {
+		FactoryUnderTest = new CEntityFactory();
+	}
+
+	void TearDown() override {
+		delete FactoryUnderTest;
+	}
+
+	const std::unordered_map<std::string, uint32_t>& GetClassNamesMap()const { return FactoryUnderTest->_classNameToClassId; }
+	const CWorldObject& GetClassCDO(const std::string& typeName)const { return *FactoryUnderTest->_descriptors[GetClassNamesMap().at(typeName)].CDO; }
+};
+
+TEST_F(CEntityFactoryFixture, MustRegisterClassName) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+
+	EXPECT_NE(GetClassNamesMap().find("CTestWorldObject"), GetClassNamesMap().end());
+};
+
+TEST_F(CEntityFactoryFixture, MustThrowIfRegisterClassNameTwice) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+	EXPECT_DEATH(FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject"), ".*");
+};
+
+TEST_F(CEntityFactoryFixture, MustAssertIfMemoryIsNullptr) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+	EXPECT_DEATH(FactoryUnderTest->PlacementNewFromTypename(nullptr, nullptr, "CTestWorldObject"), ".*");
+};
+
+TEST_F(CEntityFactoryFixture, MustAssertIfPendingDestroyedIsNullptr) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+	EXPECT_DEATH(FactoryUnderTest->PlacementNewFromTypename(nullptr, nullptr, "CTestWorldObject"), ".*");
+};
+
+TEST_F(CEntityFactoryFixture, MustNotAssertWhenQueryingClassCDO) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+
+	EXPECT_NO_FATAL_FAILURE(FactoryUnderTest->GetCDOFromTypename("CTestWorldObject"));
+};
+
+TEST_F(CEntityFactoryFixture, MustAssertWhenQueryingNonRegisteredClassCDO) {
+	EXPECT_DEATH(FactoryUnderTest->GetCDOFromTypename("CTestWorldObject"), ".*");
+};
+
+TEST_F(CEntityFactoryFixture, MustReturnCorrectCDOData) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+
+	EXPECT_EQ(GetClassCDO("CTestWorldObject").GetClassSize(), sizeof(CTestWorldObject));
+	EXPECT_EQ(GetClassCDO("CTestWorldObject").GetClassAlignment(), alignof(CTestWorldObject));
+	EXPECT_EQ(GetClassCDO("CTestWorldObject").ComputeComponentsMaxSizeForAllocation(), 0u);
+	EXPECT_EQ(GetClassCDO("CTestWorldObject").GetCDOComponentsInfo().size(), 0u);
+};
+
+TEST_F(CEntityFactoryFixture, MustResolveSameClassByIdAndName) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+
+	const auto classId{ GetClassId<CTestWorldObject>() };
+	EXPECT_TRUE(FactoryUnderTest->IsClassRegistered(classId));
+	EXPECT_EQ(FactoryUnderTest->GetClassIdFromTypename("CTestWorldObject"), classId);
+	EXPECT_EQ(&FactoryUnderTest->GetCDOFromClassId(classId), &FactoryUnderTest->GetCDOFromTypename("CTestWorldObject"));
+};
+
+TEST_F(CEntityFactoryFixture, MustAssignDistinctClassIds) {
+	struct COtherWorldObject : public CWorldObject
+	{
+		COtherWorldObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {}
+	};
+
+	EXPECT_EQ(GetClassId<CTestWorldObject>(), GetClassId<const CTestWorldObject>());
+	EXPECT_NE(GetClassId<CTestWorldObject>(), GetClassId<COtherWorldObject>());
+	EXPECT_FALSE(FactoryUnderTest->IsClassRegistered(GetClassId<COtherWorldObject>()));
+};
+
+TEST_F(CEntityFactoryFixture, MustDescribeClassInOneCacheLine) {
+	FactoryUnderTest->RegisterEntityClass<CTestWorldObject>("CTestWorldObject");
+
+	const auto& descriptor{ FactoryUnderTest->GetClassDescriptor(GetClassId<CTestWorldObject>()) };
+	EXPECT_EQ(alignof(DEntityClassDescriptor), 64u);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(&descriptor) % 64, 0u);
+	EXPECT_EQ(descriptor.ClassId, GetClassId<CTestWorldObject>());
+	EXPECT_EQ(descriptor.Size, sizeof(CTestWorldObject));
+	EXPECT_EQ(descriptor.Alignment, alignof(CTestWorldObject));
+	EXPECT_EQ(descriptor.AllocationSize, sizeof(CTestWorldObject));
+	EXPECT_EQ(descriptor.CDO, &GetClassCDO("CTestWorldObject"));
+};
+
+TEST_F(CEntityFactoryFixture, MustConstructAndDestroyThroughDescriptor) {
+	static uint32_t numOfDestroyed{};
+	struct CDestroyCountingObject : public CWorldObject
+	{
+		CDestroyCountingObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {}
+		~CDestroyCountingObject() { numOfDestroyed++; }
+	};
+	FactoryUnderTest->RegisterEntityClass<CDestroyCountingObject>("CDestroyCountingObject");
+	numOfDestroyed = 0;
+
+	CWorldObjectPendingDestroyNotifierMock notifier;
+	std::aligned_storage_t<sizeof(CDestroyCountingObject), alignof(CDestroyCountingObject)> memory;
+	const auto& descriptor{ FactoryUnderTest->GetClassDescriptor(GetClassId<CDestroyCountingObject>()) };
+
+	CWorldObject* const object{ FactoryUnderTest->PlacementNewFromClassId(&memory, &notifier, descriptor.ClassId) };
+	EXPECT_EQ(object->GetStaticClassId(), descriptor.ClassId);
+	EXPECT_EQ(object->GetStaticClassCDO(), descriptor.CDO);
+
+	descriptor.Destroy(object);
+	EXPECT_EQ(numOfDestroyed, 1u);
+
+	// The CDO is destroyed with the factory
+	delete FactoryUnderTest;
+	FactoryUnderTest = nullptr;
+	EXPECT_EQ(numOfDestroyed, 2u);
+};
+
+#pragma endregion
+
+#pragma region CWorldObject
+
+TEST(CWorldObjectCDOZeroSizeTest, MustAssertOnZeroClassSizeWhenCDO) {
+	EXPECT_DEATH(CWorldObjectCDO(true, 0, 0), ".*");
+};
+
+TEST(CWorldObjectCDOZeroSizeTest, MustAssertOnZeroClassSizeWhenNotCDO) {
+	EXPECT_DEATH(CWorldObjectCDO(false, 0, 0), ".*");
+};
+
+class CWorldObjectCDOFixture : public ::testing::Test {
+protected:
+	inline static constexpr uint64_t CLASS_SIZE{ 32 };
+	inline static constexpr uint64_t CLASS_ALIGNMENT{ 8 };
+	CWorldObjectCDO* cdo{};
+
+	void SetUp() override {
+		cdo = new CWorldObjectCDO(true, CLASS_SIZE, CLASS_ALIGNMENT);
+	}
+
+	void TearDown() override {
+		delete cdo;
+	}
+
+};
+
+TEST_F(CWorldObjectCDOFixture, MustReturnIsCdoTrue) {
+	EXPECT_EQ(cdo->IsCDO(), true);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustHaveExpectedClassSize) {
+	EXPECT_EQ(cdo->GetClassSize(), CLASS_SIZE);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustHaveExpectedClassAlignment) {
+	EXPECT_EQ(cdo->GetClassAlignment(), CLASS_ALIGNMENT);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustReturnZeroBytesForZeroComponents) {
+	EXPECT_EQ(cdo->ComputeComponentsMaxSizeForAllocation(), 0);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustReturnEmptyComponentsInfo) {
+	EXPECT_EQ(cdo->GetCDOComponentsInfo().size(), 0);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustReturnOneComponentsInfoForTemplateComponent) {
+	struct Component
+	{
+		uint32_t a, b, c, d;
+	};
+	constexpr uint64_t COMPONENT_SIZE{ sizeof(Component) };
+	constexpr uint64_t COMPONENT_ALIGNMENT{ alignof(Component) };
+	cdo->StaticRegisterNewComponent<Component>();
+
+	EXPECT_EQ(cdo->GetCDOComponentsInfo().size(), 1u);
+	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Size, COMPONENT_SIZE);
+	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Alignment, COMPONENT_ALIGNMENT);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustReturnOneComponentsInfoForUnkownComponent) {
+	constexpr uint64_t COMPONENT_SIZE{ 16 };
+	constexpr uint64_t COMPONENT_ALIGNMENT{ 4 };
+	cdo->StaticRegisterNewComponentUnknown(COMPONENT_SIZE, COMPONENT_ALIGNMENT);
+
+	EXPECT_EQ(cdo->GetCDOComponentsInfo().size(), 1u);
+	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Size, COMPONENT_SIZE);
+	EXPECT_EQ(cdo->GetCDOComponentsInfo().at(0).Alignment, COMPONENT_ALIGNMENT);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustAssertIfComponentSizeIsZero) {
+
+	EXPECT_DEATH(cdo->StaticRegisterNewComponentUnknown(0, 2), ".*");
+};
+
+TEST_F(CWorldObjectCDOFixture, MustAssertIfComponentAlignmentIsZero) {
+
+	EXPECT_DEATH(cdo->StaticRegisterNewComponentUnknown(2, 0), ".*");
 };
 
 TEST_F(CWorldObjectCDOFixture, MustNotAssertIfComponentAlignmentIsOne) {
@@ -325,6 +1232,32 @@ TEST_F(CWorldObjectCDOFixture, MustReturnMultipleComponentsInfo) {
 	}
 };
 
+TEST_F(CWorldObjectCDOFixture, MustPackComponentOffsetsAtRegistration) {
+	cdo->StaticRegisterNewComponentUnknown(1, 1);
+	cdo->StaticRegisterNewComponentUnknown(8, 8);
+	cdo->StaticRegisterNewComponentUnknown(2, 2);
+	cdo->StaticRegisterNewComponentUnknown(16, 16);
+
+	const auto& components{ cdo->GetCDOComponentsInfo() };
+	EXPECT_EQ(components.at(0).Offset, CLASS_SIZE);
+	EXPECT_EQ(components.at(1).Offset, CLASS_SIZE + 8);
+	EXPECT_EQ(components.at(2).Offset, CLASS_SIZE + 16);
+	EXPECT_EQ(components.at(3).Offset, CLASS_SIZE + 32);
+	EXPECT_EQ(cdo->ComputeComponentsMaxSizeForAllocation(), 48u);
+};
+
+TEST_F(CWorldObjectCDOFixture, MustGiveNoArchetypeSlotPastTheLimit) {
+	for (uint64_t i{}; i < MAX_ARCHETYPE_COMPONENTS + 2; i++)
+	{
+		cdo->StaticRegisterNewComponentUnknown(4, 4);
+	}
+
+	const auto& components{ cdo->GetCDOComponentsInfo() };
+	EXPECT_EQ(components.at(MAX_ARCHETYPE_COMPONENTS - 1).Offset, CLASS_SIZE + (MAX_ARCHETYPE_COMPONENTS - 1) * 4);
+	EXPECT_EQ(components.at(MAX_ARCHETYPE_COMPONENTS).Offset, NO_ARCHETYPE_OFFSET);
+	EXPECT_EQ(cdo->ComputeComponentsMaxSizeForAllocation(), MAX_ARCHETYPE_COMPONENTS * 4);
+};
+
 class CWorldObjectCDOMock : public IWorldObjectCDO
 {
 public:
@@ -385,9 +1318,10 @@ TEST(CWorldObjectArchetypesComponentsContainerTest, MustDieIfClassSizeIsZero)
 class CWorldObjectArchetypesComponentsContainerFixture : public ::testing::Test {
 protected:
 	CWorldObjectArchetypesComponentsContainer* ContainerUnderTest{};
-	alignas(4) std::array<uint8_t, 64> Buffer;
+	alignas(alignof(std::max_align_t)) std::array<uint8_t, 64> Buffer;
 	CWorldObjectCDOMock* cdoMock{};
-	const std::vector<CEntityComponentMetadata> ComponentsInfo{ CEntityComponentMetadata{Buffer.size() / 2,4} };
+	// Two slots of 16 bytes after a 32 bytes class
+	const std::vector<CEntityComponentMetadata> ComponentsInfo{ CEntityComponentMetadata{16, 4, 32}, CEntityComponentMetadata{16, 4, 48} };
 	const std::vector<CEntityComponentMetadata> EmptyComponentsInfo{};
 	void SetUp() override
 	{
@@ -416,8 +1350,8 @@ protected:
 		delete cdoMock;
 	}
 
-	void* MallocComponent(const uint64_t size, const uint64_t alignment) { return ContainerUnderTest->MallocComponent(size, alignment); }
-	void FreeComponent(void* ptr) { ContainerUnderTest->FreeComponent(ptr); }
+	void* MallocComponent(const uint64_t size, const uint64_t alignment, const uint32_t typeIndex = UINT32_MAX) { return ContainerUnderTest->MallocComponent(Buffer.data(), size, alignment, typeIndex); }
+	void FreeComponent(void* ptr) { ContainerUnderTest->FreeComponent(Buffer.data(), ptr); }
 };
 
 TEST_F(CWorldObjectArchetypesComponentsContainerFixture, MustNotDoAnythingWhenInitializedWithNullptrCDO)
@@ -478,11 +1412,37 @@ TEST_F(CWorldObjectArchetypesComponentsContainerFixture, MustCorrectlyFillAllSpa
 	}
 }
 
-class CWorldObjectPendingDestroyNotifierMock : public IWorldObjectPendingDestroyNotifier
+TEST_F(CWorldObjectArchetypesComponentsContainerFixture, MustPlaceComponentsAtRegisteredOffsets)
 {
-public:
-	MOCK_METHOD(void, MarkPendingDestroy, (class CWorldObject*), (override));
-};
+	InitializeCorrectly();
+
+	EXPECT_EQ(MallocComponent(16, 4), Buffer.data() + 32);
+	EXPECT_EQ(MallocComponent(16, 4), Buffer.data() + 48);
+
+	// A released slot is reused by the next component of the same layout
+	FreeComponent(Buffer.data() + 32);
+	EXPECT_EQ(MallocComponent(16, 4), Buffer.data() + 32);
+}
+
+TEST_F(CWorldObjectArchetypesComponentsContainerFixture, MustNotPlaceComponentsOfDifferentLayout)
+{
+	InitializeCorrectly();
+
+	EXPECT_EQ(MallocComponent(8, 4), nullptr);
+	EXPECT_EQ(MallocComponent(16, 8), nullptr);
+	EXPECT_EQ(MallocComponent(16, 4), Buffer.data() + 32);
+	// Registered without a type, any type of the same layout fits
+	EXPECT_EQ(MallocComponent(16, 4, 0), Buffer.data() + 48);
+}
+
+TEST_F(CWorldObjectArchetypesComponentsContainerFixture, MustDieFreeingSlotTwice)
+{
+	InitializeCorrectly();
+
+	void* a = MallocComponent(16, 4);
+	FreeComponent(a);
+	EXPECT_DEATH(FreeComponent(a), ".*");
+}
 
 TEST(CDestroyableTest, MustCallDestroyFn)
 {
@@ -557,22 +1517,71 @@ TEST(CWorldObjectTest, MustRegisterCDOComponentsCorrectly)
 	EXPECT_EQ(object.GetCDOComponentsInfo().at(1).Alignment, ExpectedComponentsInfo.at(1).Alignment);
 }
 
-TEST(CWorldObjectTest, MustCreateRuntimeComponents)
+TEST(CWorldObjectTest, MustReadLayoutFromClassCDO)
 {
 	struct ComponentFoo
 	{
-		char Foo[4];
-	};
-
-	struct ComponentBar
-	{
-		uint32_t Bar[4];
+		uint64_t Foo[2];
 	};
 
 	class CTestObject : public CWorldObject
 	{
 	public:
-		CTestObject(const DWorldObjectInitializer& initializer) :CWorldObject(initializer, true) {
+		CTestObject(const DWorldObjectInitializer& initializer) :CWorldObject(initializer, false) {
+			Foo = NewComponent<ComponentFoo>();
+		}
+		CComponentHandle<ComponentFoo> Foo;
+	};
+
+	DWorldObjectInitializer cdoInitializer{};
+	cdoInitializer.ClassSize = sizeof(CTestObject);
+	cdoInitializer.ClassAlignment = alignof(CTestObject);
+	CTestObject cdo(cdoInitializer);
+	ASSERT_TRUE(cdo.IsCDO());
+
+	DWorldObjectInitializer initializer{ cdoInitializer };
+	initializer.StaticClassCDO = &cdo;
+	alignas(alignof(std::max_align_t)) std::array<uint8_t, sizeof(CTestObject) + sizeof(ComponentFoo) + alignof(std::max_align_t)> memory;
+	CTestObject* const object{ new(memory.data()) CTestObject(initializer) };
+
+	EXPECT_FALSE(object->IsCDO());
+	EXPECT_EQ(&object->GetCDOComponentsInfo(), &cdo.GetCDOComponentsInfo());
+	EXPECT_EQ(object->ComputeComponentsMaxSizeForAllocation(), cdo.ComputeComponentsMaxSizeForAllocation());
+	EXPECT_EQ(reinterpret_cast<uint8_t*>(object->Foo.Get()), memory.data() + cdo.GetCDOComponentsInfo().at(0).Offset);
+	object->~CTestObject();
+}
+
+TEST(CWorldObjectTest, MustStoreInternedTags)
+{
+	DWorldObjectInitializer initializer{};
+	initializer.ClassSize = sizeof(CWorldObject);
+	initializer.ClassAlignment = alignof(CWorldObject);
+	CWorldObject object(initializer, false);
+
+	const auto enemy{ CTagRegistry::Intern("Enemy") };
+	EXPECT_TRUE(object.AddTag(enemy));
+	EXPECT_FALSE(object.AddTag(enemy));
+	EXPECT_TRUE(object.HasTag(enemy));
+	EXPECT_TRUE(object.RemoveTag(enemy));
+	EXPECT_TRUE(object.GetTags().IsEmpty());
+}
+
+TEST(CWorldObjectTest, MustCreateRuntimeComponents)
+{
+	struct ComponentFoo
+	{
+		char Foo[4];
+	};
+
+	struct ComponentBar
+	{
+		uint32_t Bar[4];
+	};
+
+	class CTestObject : public CWorldObject
+	{
+	public:
+		CTestObject(const DWorldObjectInitializer& initializer) :CWorldObject(initializer, true) {
 		}
 
 		void Tick() override {
@@ -607,10 +1616,1475 @@ TEST(CWorldObjectTest, MustCreateRuntimeComponents)
 	object.Tick();
 }
 
+class CComponentHandleFixture : public ::testing::Test {
+protected:
+	inline static uint32_t NumOfDestroyed{};
+
+	struct DCountedComponent
+	{
+		DCountedComponent(const uint32_t value) : Value(value) {}
+		~DCountedComponent() { NumOfDestroyed++; }
+		uint32_t Value;
+	};
+
+	class CTestObject : public CWorldObject
+	{
+	public:
+		CTestObject(const DWorldObjectInitializer& initializer) :CWorldObject(initializer, false) {}
+
+		CComponentHandle<DCountedComponent> MakeComponent(const uint32_t value) { return NewComponent<DCountedComponent>(value); }
+		std::shared_ptr<DCountedComponent> MakeSharedComponent(const uint32_t value) { return NewSharedComponent<DCountedComponent>(value); }
+	};
+
+	CHeapAlignedAllocator RuntimeComponentsAllocator;
+	CWorldObjectCDOMock CdoMock;
+	const std::vector<CEntityComponentMetadata> ComponentsInfo{ };
+	DWorldObjectInitializer Initializer{};
+
+	void SetUp() override {
+		NumOfDestroyed = 0;
+		EXPECT_CALL(CdoMock, GetCDOComponentsInfo).WillRepeatedly(::testing::ReturnRef(ComponentsInfo));
+		EXPECT_CALL(CdoMock, GetClassSize).WillRepeatedly(::testing::Return(sizeof(CTestObject)));
+		EXPECT_CALL(CdoMock, ComputeComponentsMaxSizeForAllocation).WillRepeatedly(::testing::Return(0));
+
+		Initializer.StaticClassCDO = &CdoMock;
+		Initializer.ClassSize = sizeof(CTestObject);
+		Initializer.ClassAlignment = alignof(CTestObject);
+		Initializer.RuntimeComponentsAllocator = &RuntimeComponentsAllocator;
+	}
+};
+
+TEST_F(CComponentHandleFixture, MustBeTwoPointersWide) {
+	EXPECT_EQ(sizeof(CComponentHandle<DCountedComponent>), 2 * sizeof(void*));
+}
+
+TEST_F(CComponentHandleFixture, MustDestroyComponentWhenHandleIsDestroyed) {
+	CTestObject object(Initializer);
+	{
+		auto handle{ object.MakeComponent(42) };
+		ASSERT_TRUE(handle);
+		EXPECT_EQ(handle->Value, 42u);
+		EXPECT_EQ(NumOfDestroyed, 0u);
+	}
+	EXPECT_EQ(NumOfDestroyed, 1u);
+}
+
+TEST_F(CComponentHandleFixture, MustTransferOwnershipOnMove) {
+	CTestObject object(Initializer);
+	auto first{ object.MakeComponent(1) };
+	auto* const component{ first.Get() };
+
+	CComponentHandle<DCountedComponent> second{ std::move(first) };
+	EXPECT_FALSE(first);
+	EXPECT_EQ(second.Get(), component);
+
+	second = object.MakeComponent(2);
+	EXPECT_EQ(NumOfDestroyed, 1u);
+	EXPECT_EQ(second->Value, 2u);
+
+	second.Reset();
+	EXPECT_FALSE(second);
+	EXPECT_EQ(NumOfDestroyed, 2u);
+}
+
+TEST_F(CComponentHandleFixture, MustDestroyOnceThroughSharedAdapter) {
+	CTestObject object(Initializer);
+	auto shared{ object.MakeSharedComponent(7) };
+	auto copy{ shared };
+
+	shared.reset();
+	EXPECT_EQ(NumOfDestroyed, 0u);
+	EXPECT_EQ(copy->Value, 7u);
+
+	copy.reset();
+	EXPECT_EQ(NumOfDestroyed, 1u);
+}
+
+
+#pragma endregion
+
+#pragma region CJobSystem
+TEST(CJobSystemTest, MustRunEveryChunkOfParallelForOnce) {
+	CJobSystem jobSystem(4);
+	constexpr uint64_t COUNT{ 10000 };
+	std::vector<std::atomic<uint32_t>> visits(COUNT);
+
+	jobSystem.ParallelFor(COUNT, 64, [&](uint64_t begin, uint64_t end) {
+		for (auto i{ begin }; i < end; i++)
+		{
+			visits[i].fetch_add(1, std::memory_order_relaxed);
+		}
+		});
+
+	for (const auto& visit : visits)
+	{
+		EXPECT_EQ(visit.load(), 1u);
+	}
+}
+
+TEST(CJobSystemTest, MustRunJobsOnWaitingThreadWithoutWorkers) {
+	CJobSystem jobSystem(0);
+	CJobCounter counter;
+	const auto callerId{ std::this_thread::get_id() };
+	std::thread::id jobThreadId;
+
+	jobSystem.Schedule([&]() { jobThreadId = std::this_thread::get_id(); }, counter);
+	EXPECT_FALSE(counter.IsDone());
+
+	jobSystem.Wait(counter);
+	EXPECT_TRUE(counter.IsDone());
+	EXPECT_EQ(jobThreadId, callerId);
+}
+
+TEST(CJobSystemTest, MustCompleteJobsScheduledFromJobs) {
+	CJobSystem jobSystem(3);
+	std::atomic<uint32_t> numOfLeaves{};
+
+	CJobCounter counter;
+	for (uint32_t i{}; i < 8; i++)
+	{
+		jobSystem.Schedule([&]() {
+			CJobCounter childCounter;
+			for (uint32_t j{}; j < 8; j++)
+			{
+				jobSystem.Schedule([&]() { numOfLeaves.fetch_add(1); }, childCounter);
+			}
+			jobSystem.Wait(childCounter);
+			}, counter);
+	}
+	jobSystem.Wait(counter);
+
+	EXPECT_EQ(numOfLeaves.load(), 64u);
+}
+#pragma endregion
+
+#pragma region CTickManager
+class CTickManagerFixture : public ::testing::Test {
+protected:
+	struct CTickingObject : public CWorldObject
+	{
+		CTickingObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		void Tick() override { NumTicks++; }
+		uint32_t NumTicks{};
+	};
+
+	struct COtherTickingObject : public CWorldObject
+	{
+		COtherTickingObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		void Tick() override { NumTicks += 10; }
+		uint32_t NumTicks{};
+	};
+
+	struct CNonTickingObject : public CWorldObject
+	{
+		CNonTickingObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {}
+	};
+
+	static constexpr uint32_t NUM_OBJECTS{ 4 };
+
+	CEntityFactory Factory;
+	CWorldObjectPendingDestroyNotifierMock PendingDestroyNotifier;
+	static constexpr uint32_t OBJECT_SLOT_SIZE{ 512 };
+	alignas(alignof(std::max_align_t)) std::array<uint8_t, NUM_OBJECTS * OBJECT_SLOT_SIZE> Buffer{};
+
+	void SetUp() override {
+		Factory.RegisterEntityClass<CTickingObject>("CTickingObject");
+		Factory.RegisterEntityClass<COtherTickingObject>("COtherTickingObject");
+		Factory.RegisterEntityClass<CNonTickingObject>("CNonTickingObject");
+	}
+
+	template<typename T>
+	T* Spawn(const uint32_t index, const std::string& typeName) {
+		static_assert(sizeof(T) <= OBJECT_SLOT_SIZE);
+		return static_cast<T*>(Factory.PlacementNewFromTypename(Buffer.data() + index * OBJECT_SLOT_SIZE, &PendingDestroyNotifier, typeName));
+	}
+};
+
+TEST_F(CTickManagerFixture, MustTickEveryRegisteredObjectOnce) {
+	CTickManager tickManager(Factory);
+	auto* a{ Spawn<CTickingObject>(0, "CTickingObject") };
+	auto* b{ Spawn<CTickingObject>(1, "CTickingObject") };
+	auto* c{ Spawn<COtherTickingObject>(2, "COtherTickingObject") };
+
+	tickManager.Register(a);
+	tickManager.Register(b);
+	tickManager.Register(c);
+	EXPECT_EQ(tickManager.GetNumOfBuckets(), 2u);
+	EXPECT_EQ(tickManager.GetNumOfTickingObjects(), 3u);
+
+	tickManager.Tick();
+	tickManager.Tick();
+
+	EXPECT_EQ(a->NumTicks, 2u);
+	EXPECT_EQ(b->NumTicks, 2u);
+	EXPECT_EQ(c->NumTicks, 20u);
+}
+
+TEST_F(CTickManagerFixture, MustSkipObjectsThatCanNeverTick) {
+	CTickManager tickManager(Factory);
+	auto* object{ Spawn<CNonTickingObject>(0, "CNonTickingObject") };
+
+	tickManager.Register(object);
+
+	EXPECT_EQ(tickManager.GetNumOfBuckets(), 0u);
+	EXPECT_EQ(tickManager.GetNumOfTickingObjects(), 0u);
+	EXPECT_NO_FATAL_FAILURE(tickManager.Unregister(object));
+}
+
+TEST_F(CTickManagerFixture, MustStopTickingUnregisteredObjects) {
+	CTickManager tickManager(Factory);
+	CTickingObject* objects[NUM_OBJECTS]{};
+	for (uint32_t i{}; i < NUM_OBJECTS; i++)
+	{
+		objects[i] = Spawn<CTickingObject>(i, "CTickingObject");
+		tickManager.Register(objects[i]);
+	}
+
+	tickManager.Unregister(objects[0]);
+	tickManager.Unregister(objects[2]);
+	tickManager.Tick();
+
+	EXPECT_EQ(objects[0]->NumTicks, 0u);
+	EXPECT_EQ(objects[1]->NumTicks, 1u);
+	EXPECT_EQ(objects[2]->NumTicks, 0u);
+	EXPECT_EQ(objects[3]->NumTicks, 1u);
+
+	// Re-registering after swap removal must keep slots consistent
+	tickManager.Register(objects[0]);
+	tickManager.SortBucketsByAddress();
+	tickManager.Unregister(objects[3]);
+	tickManager.Tick();
+
+	EXPECT_EQ(objects[0]->NumTicks, 1u);
+	EXPECT_EQ(objects[1]->NumTicks, 2u);
+	EXPECT_EQ(objects[3]->NumTicks, 1u);
+	EXPECT_EQ(tickManager.GetNumOfTickingObjects(), 2u);
+}
+
+struct DTickTestPosition {};
+struct DTickTestVelocity {};
+
+class CTickGroupsFixture : public CTickManagerFixture {
+protected:
+	inline static std::vector<std::string> TickOrder;
+
+	struct CPostPhysicsObject : public CWorldObject
+	{
+		CPostPhysicsObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		static DTickSettings GetStaticTickSettings() { return DTickSettings(ETickGroup::PostPhysics).Reading<DTickTestPosition>(); }
+		void Tick() override { TickOrder.push_back("PostPhysics"); }
+	};
+
+	struct CPhysicsObject : public CWorldObject
+	{
+		CPhysicsObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		static DTickSettings GetStaticTickSettings() { return DTickSettings(ETickGroup::Physics).Reading<DTickTestVelocity>().Writing<DTickTestPosition>(); }
+		void Tick() override { TickOrder.push_back("Physics"); }
+	};
+
+	struct CPositionReader : public CWorldObject
+	{
+		CPositionReader(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		static DTickSettings GetStaticTickSettings() { return DTickSettings(ETickGroup::Physics).Reading<DTickTestPosition>(); }
+	};
+
+	struct CVelocityWriter : public CWorldObject
+	{
+		CVelocityWriter(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		static DTickSettings GetStaticTickSettings() { return DTickSettings(ETickGroup::Physics).Writing<DTickTestVelocity>(); }
+	};
+
+	struct CUnrelatedWriter : public CWorldObject
+	{
+		CUnrelatedWriter(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		static DTickSettings GetStaticTickSettings() { return DTickSettings(ETickGroup::Physics).Writing<DTickTestPosition>(); }
+	};
+
+	void SetUp() override {
+		CTickManagerFixture::SetUp();
+		TickOrder.clear();
+		Factory.RegisterEntityClass<CPostPhysicsObject>("CPostPhysicsObject");
+		Factory.RegisterEntityClass<CPhysicsObject>("CPhysicsObject");
+		Factory.RegisterEntityClass<CPositionReader>("CPositionReader");
+		Factory.RegisterEntityClass<CVelocityWriter>("CVelocityWriter");
+		Factory.RegisterEntityClass<CUnrelatedWriter>("CUnrelatedWriter");
+	}
+};
+
+TEST_F(CTickGroupsFixture, MustTickGroupsInOrder) {
+	CTickManager tickManager(Factory);
+	tickManager.Register(Spawn<CPostPhysicsObject>(0, "CPostPhysicsObject"));
+	tickManager.Register(Spawn<CPhysicsObject>(1, "CPhysicsObject"));
+
+	tickManager.Tick();
+
+	EXPECT_THAT(TickOrder, ::testing::ElementsAre("Physics", "PostPhysics"));
+}
+
+TEST_F(CTickGroupsFixture, MustSplitConflictingBucketsInWaves) {
+	CTickManager tickManager(Factory);
+	tickManager.Register(Spawn<CPhysicsObject>(0, "CPhysicsObject"));
+	tickManager.Register(Spawn<CPositionReader>(1, "CPositionReader"));
+	tickManager.Register(Spawn<CVelocityWriter>(2, "CVelocityWriter"));
+	tickManager.Register(Spawn<CTickingObject>(3, "CTickingObject"));
+
+	// Physics writes position read by the reader and reads velocity written by the writer
+	const auto& physicsWaves{ tickManager.GetWaves(ETickGroup::Physics) };
+	ASSERT_EQ(physicsWaves.size(), 2u);
+	EXPECT_THAT(physicsWaves[0], ::testing::ElementsAre(0u));
+	EXPECT_THAT(physicsWaves[1], ::testing::ElementsAre(1u, 2u));
+
+	// Classes without declared access tick alone
+	EXPECT_EQ(tickManager.GetWaves(ETickGroup::PrePhysics).size(), 1u);
+	EXPECT_TRUE(tickManager.GetWaves(ETickGroup::PostPhysics).empty());
+}
+
+TEST_F(CTickGroupsFixture, MustNotShareWaveBetweenWritersOfTheSameComponent) {
+	CTickManager tickManager(Factory);
+	tickManager.Register(Spawn<CPhysicsObject>(0, "CPhysicsObject"));
+	tickManager.Register(Spawn<CUnrelatedWriter>(1, "CUnrelatedWriter"));
+
+	EXPECT_EQ(tickManager.GetWaves(ETickGroup::Physics).size(), 2u);
+}
+
+TEST(CTickManagerJobsTest, MustTickEveryObjectOnceConcurrently) {
+	struct CCountingObject : public CWorldObject
+	{
+		CCountingObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		static DTickSettings GetStaticTickSettings() { return DTickSettings(ETickGroup::Physics).Writing<CCountingObject>(); }
+		void Tick() override { NumTicks++; }
+		uint32_t NumTicks{};
+	};
+
+	constexpr uint32_t NUM_OBJECTS{ 1000 };
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCountingObject>("CCountingObject");
+	CWorldObjectPendingDestroyNotifierMock notifier;
+	std::vector<std::aligned_storage_t<sizeof(CCountingObject), alignof(CCountingObject)>> memory(NUM_OBJECTS);
+
+	CJobSystem jobSystem(4);
+	CTickManager tickManager(factory, &jobSystem);
+	tickManager.SetTickChunkSize(16);
+
+	std::vector<CCountingObject*> objects;
+	for (auto& storage : memory)
+	{
+		objects.push_back(static_cast<CCountingObject*>(factory.PlacementNewFromTypename(&storage, &notifier, "CCountingObject")));
+		tickManager.Register(objects.back());
+	}
+
+	tickManager.Tick();
+	tickManager.Tick();
+
+	for (const auto* object : objects)
+	{
+		EXPECT_EQ(object->NumTicks, 2u);
+	}
+}
+
+#pragma endregion
+
+
+#pragma region CWorld
+class CWorldFixture : public ::testing::Test {
+protected:
+	inline static uint32_t NumOfDestroyed{};
+
+	struct CSmallObject : public CWorldObject
+	{
+		CSmallObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+		~CSmallObject() { NumOfDestroyed++; }
+		void Tick() override { NumTicks++; }
+		uint32_t NumTicks{};
+	};
+
+	struct CBigObject : public CWorldObject
+	{
+		CBigObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {}
+		~CBigObject() { NumOfDestroyed++; }
+		std::array<uint8_t, 512> Payload{};
+	};
+
+	CEntityFactory Factory;
+
+	void SetUp() override {
+		NumOfDestroyed = 0;
+		Factory.RegisterEntityClass<CSmallObject>("CSmallObject");
+		Factory.RegisterEntityClass<CBigObject>("CBigObject");
+	}
+};
+
+TEST_F(CWorldFixture, MustSpawnRegisteredClasses) {
+	CWorld world(Factory);
+
+	auto* small{ world.SpawnWorldObject<CSmallObject>("CSmallObject") };
+	auto* big{ world.SpawnWorldObject<CBigObject>("CBigObject") };
+
+	ASSERT_NE(small, nullptr);
+	ASSERT_NE(big, nullptr);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(small) % alignof(std::max_align_t), 0u);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % alignof(std::max_align_t), 0u);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 2u);
+	EXPECT_EQ(world.GetTickManager().GetNumOfTickingObjects(), 1u);
+}
+
+TEST_F(CWorldFixture, MustSpawnByClassId) {
+	CWorld world(Factory);
+
+	auto* object{ world.SpawnWorldObject<CBigObject>() };
+
+	ASSERT_NE(object, nullptr);
+	EXPECT_EQ(object->GetStaticClassCDO(), &Factory.GetCDOFromTypename("CBigObject"));
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 1u);
+}
+
+TEST_F(CWorldFixture, MustPlaceArchetypeComponentsInsideTheObject) {
+	struct DHealth { uint32_t Value{ 100 }; };
+	struct DTransform { double Position[3]{}; };
+
+	struct CArchetypeObject : public CWorldObject
+	{
+		CArchetypeObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {
+			Health = NewComponent<DHealth>();
+			Transform = NewComponent<DTransform>();
+		}
+		CComponentHandle<DHealth> Health;
+		CComponentHandle<DTransform> Transform;
+	};
+	Factory.RegisterEntityClass<CArchetypeObject>("CArchetypeObject");
+
+	const auto& descriptor{ Factory.GetClassDescriptor(GetClassId<CArchetypeObject>()) };
+	const auto& components{ descriptor.CDO->GetCDOComponentsInfo() };
+	ASSERT_EQ(components.size(), 2u);
+	EXPECT_EQ(descriptor.AllocationSize, components.at(1).Offset + sizeof(DTransform));
+
+	CWorld world(Factory);
+	auto* object{ world.SpawnWorldObject<CArchetypeObject>() };
+	const auto base{ reinterpret_cast<uintptr_t>(object) };
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(object->Health.Get()), base + components.at(0).Offset);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(object->Transform.Get()), base + components.at(1).Offset);
+	EXPECT_EQ(object->Health->Value, 100u);
+}
+
+TEST_F(CWorldFixture, MustPlaceComponentsInSlotsRegisteredWithoutType) {
+	struct DHealth { uint32_t Value{ 100 }; };
+
+	struct CUntypedObject : public CWorldObject
+	{
+		CUntypedObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {
+			// Reserves the slack, the component is created later
+			if (IsCDO())
+				StaticRegisterNewComponentUnknown(sizeof(DHealth), alignof(DHealth));
+		}
+		CComponentHandle<DHealth> Health;
+	};
+	Factory.RegisterEntityClass<CUntypedObject>("CUntypedObject");
+
+	const auto& components{ Factory.GetClassDescriptor(GetClassId<CUntypedObject>()).CDO->GetCDOComponentsInfo() };
+	ASSERT_EQ(components.size(), 1u);
+
+	CWorld world(Factory);
+	auto* const object{ world.SpawnWorldObject<CUntypedObject>() };
+	object->Health = object->NewComponent<DHealth>();
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(object->Health.Get()), reinterpret_cast<uintptr_t>(object) + components.at(0).Offset);
+	EXPECT_EQ(object->Health->Value, 100u);
+}
+
+TEST_F(CWorldFixture, MustIndexObjectsByTag) {
+	struct CTaggedObject : public CWorldObject
+	{
+		CTaggedObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {
+			AddTag(CTagRegistry::Intern("Enemy"));
+		}
+	};
+	Factory.RegisterEntityClass<CTaggedObject>("CTaggedObject");
+	const auto enemy{ CTagRegistry::Intern("Enemy") };
+	const auto boss{ CTagRegistry::Intern("Boss") };
+
+	CWorld world(Factory);
+	auto* a{ world.SpawnWorldObject<CTaggedObject>() };
+	auto* b{ world.SpawnWorldObject<CTaggedObject>() };
+	auto* untagged{ world.SpawnWorldObject<CSmallObject>() };
+	EXPECT_THAT(world.GetObjectsWithTag(enemy), ::testing::UnorderedElementsAre(a, b));
+	EXPECT_TRUE(world.GetObjectsWithTag(boss).empty());
+
+	untagged->AddTag(boss);
+	b->AddTag(boss);
+	EXPECT_THAT(world.GetObjectsWithTag("Boss"), ::testing::UnorderedElementsAre(untagged, b));
+
+	a->RemoveTag(enemy);
+	EXPECT_THAT(world.GetObjectsWithTag(enemy), ::testing::ElementsAre(b));
+
+	b->SetPendingDestroy();
+	world.FlushPendingDestroy();
+	EXPECT_TRUE(world.GetObjectsWithTag(enemy).empty());
+	EXPECT_THAT(world.GetObjectsWithTag(boss), ::testing::ElementsAre(untagged));
+}
+
+TEST_F(CWorldFixture, MustServeFrameComponentsFromTheFrameArena) {
+	struct DHitEvent
+	{
+		DHitEvent(uint32_t damage) : Damage(damage) {}
+		~DHitEvent() { NumOfDestroyed++; }
+		uint32_t Damage;
+	};
+
+	CWorld world(Factory, 1);
+	auto* object{ world.SpawnWorldObject<CSmallObject>() };
+	const auto reserved{ world.GetFrameComponentsAllocator().GetReservedBytes() };
+	void* first{};
+	{
+		auto hit{ object->NewFrameComponent<DHitEvent>(42u) };
+		EXPECT_EQ(hit->Damage, 42u);
+		EXPECT_GT(world.GetFrameComponentsAllocator().GetReservedBytes(), reserved);
+		first = hit.Get();
+	}
+	EXPECT_EQ(NumOfDestroyed, 1u);
+
+	// Reclaimed memory is reused once both frames have been swapped
+	world.Tick();
+	world.Tick();
+	EXPECT_EQ(object->NewFrameComponent<DHitEvent>(2u).Get(), first);
+}
+
+TEST_F(CWorldFixture, MustSpawnInBulkFromContiguousRuns) {
+	CWorld world(Factory, 64);
+	std::array<CSmallObject*, 10> objects{};
+	std::vector<uint64_t> initialized;
+	world.SpawnWorldObjects<CSmallObject>(objects.size(), objects.data(), [&initialized](CSmallObject* object, uint64_t index) {
+		EXPECT_TRUE(object->GetHandle().IsValid());
+		initialized.push_back(index);
+		});
+
+	EXPECT_EQ(world.GetNumOfWorldObjects(), objects.size());
+	EXPECT_THAT(initialized, ::testing::ElementsAre(0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u, 9u));
+
+	const auto stride{ reinterpret_cast<uintptr_t>(objects[1]) - reinterpret_cast<uintptr_t>(objects[0]) };
+	for (uint64_t i{ 1 }; i < objects.size(); i++)
+	{
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(objects[i]) - reinterpret_cast<uintptr_t>(objects[i - 1]), stride);
+	}
+
+	world.Tick();
+	for (const auto* object : objects)
+	{
+		EXPECT_EQ(object->NumTicks, 1u);
+	}
+}
+
+struct DCrowdPosition
+{
+	float X, Y, Z;
+};
+
+struct CCrowdObject : public CWorldObject
+{
+	inline static uint32_t NumOfConstructions{};
+
+	CCrowdObject(const DWorldObjectInitializer& init) : CWorldObject(init, false), Position(NewComponent<DCrowdPosition>(DCrowdPosition{})) { NumOfConstructions++; }
+	CCrowdObject(const DWorldObjectInitializer& init, const CCrowdObject& prototype) : CWorldObject(init, prototype), Position(NewComponent<DCrowdPosition>(*prototype.Position)), Speed(prototype.Speed) {}
+
+	CComponentHandle<DCrowdPosition> Position;
+	float Speed{};
+};
+
+struct CNotClonable : public CWorldObject
+{
+	CNotClonable(const DWorldObjectInitializer& init) : CWorldObject(init, false) {}
+};
+
+struct CFragileObject : public CWorldObject
+{
+	inline static uint32_t NumOfConstructions{};
+	inline static uint32_t NumOfDestructions{};
+
+	CFragileObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {
+		if (!IsCDO() && ++NumOfConstructions == 3)
+			throw std::runtime_error("Construction failed");
+	}
+	~CFragileObject() { NumOfDestructions++; }
+};
+
+TEST(CWorldPrototypeTest, MustCloneObjectsFromAPrototype) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	factory.RegisterEntityClass<CNotClonable>("CNotClonable");
+	EXPECT_NE(factory.GetClassDescriptor(GetClassId<CCrowdObject>()).Clone, nullptr);
+	EXPECT_EQ(factory.GetClassDescriptor(GetClassId<CNotClonable>()).Clone, nullptr);
+
+	CWorld world(factory);
+	auto* const prototype{ world.SpawnWorldObject<CCrowdObject>() };
+	*prototype->Position = DCrowdPosition{ 1.f, 2.f, 3.f };
+	prototype->Speed = 4.f;
+	const uint32_t tag{ CTagRegistry::Intern("Crowd") };
+	prototype->AddTag(tag);
+
+	CCrowdObject::NumOfConstructions = 0;
+	std::array<CCrowdObject*, 8> crowd{};
+	world.SpawnWorldObjects<CCrowdObject>(crowd.size(), crowd.data(), {}, prototype);
+	EXPECT_EQ(CCrowdObject::NumOfConstructions, 0u);
+
+	for (const auto* object : crowd)
+	{
+		EXPECT_NE(object->Position.Get(), prototype->Position.Get());
+		EXPECT_EQ(object->Position->Y, 2.f);
+		EXPECT_EQ(object->Speed, 4.f);
+		EXPECT_TRUE(object->HasTag(tag));
+	}
+	EXPECT_EQ(world.GetObjectsWithTag(tag).size(), crowd.size() + 1);
+
+	auto* const notClonable{ world.SpawnWorldObject<CNotClonable>() };
+	EXPECT_THROW(world.SpawnWorldObjects(GetClassId<CNotClonable>(), 2, nullptr, {}, notClonable), std::runtime_error);
+}
+
+TEST(CWorldPrototypeTest, MustRollBackAFailedBulkSpawn) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CFragileObject>("CFragileObject");
+	CWorld world(factory);
+
+	EXPECT_THROW(world.SpawnWorldObjects(GetClassId<CFragileObject>(), 5, nullptr), std::runtime_error);
+	EXPECT_EQ(CFragileObject::NumOfDestructions, 2u);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 0u);
+
+	// The memory went back to the allocator
+	CWorldObject* object{};
+	world.SpawnWorldObjects(GetClassId<CFragileObject>(), 1, &object);
+	EXPECT_NE(object, nullptr);
+}
+
+TEST(CWorldChangesTest, MustEnumerateChangedComponentsSinceAVersion) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	CWorld world(factory);
+	std::array<CCrowdObject*, 3> crowd{};
+	world.SpawnWorldObjects<CCrowdObject>(crowd.size(), crowd.data());
+
+	using Changes = std::vector<std::pair<CWorldObject*, uint64_t>>;
+	const auto changesSince{ [&world](const uint64_t version) {
+		Changes changes;
+		EXPECT_TRUE(world.ForEachChangeSince(version, [&](CWorldObject* object, uint64_t changedBits) { changes.emplace_back(object, changedBits); }));
+		std::sort(changes.begin(), changes.end());
+		return changes;
+		} };
+
+	const uint64_t spawned{ world.GetChangeVersion() };
+	// Reading isn't a change
+	EXPECT_EQ(crowd[0]->Position->X, 0.f);
+	world.Tick();
+	EXPECT_TRUE(changesSince(spawned).empty());
+
+	const uint64_t positionBit{ crowd[1]->GetComponentChangedBit(crowd[1]->Position.Get()) };
+	EXPECT_EQ(positionBit, 1u);
+	crowd[1]->Position.GetMutable().X = 5.f;
+	crowd[1]->Position.GetMutable().Y = 6.f;
+	crowd[2]->MarkComponentsChanged(CWorldObject::RUNTIME_COMPONENTS_CHANGED_BIT);
+	EXPECT_EQ(crowd[1]->GetChangedComponents(), positionBit);
+	world.Tick();
+	EXPECT_EQ(crowd[1]->GetChangedComponents(), 0u);
+
+	const uint64_t first{ world.GetChangeVersion() };
+	Changes expected{ { crowd[1], positionBit }, { crowd[2], CWorldObject::RUNTIME_COMPONENTS_CHANGED_BIT } };
+	std::sort(expected.begin(), expected.end());
+	EXPECT_EQ(changesSince(spawned), expected);
+
+	// Merged across frames, destroyed objects are left out
+	crowd[1]->Position.GetMutable().Z = 1.f;
+	crowd[2]->SetPendingDestroy();
+	world.Tick();
+	EXPECT_EQ(changesSince(spawned), (Changes{ { crowd[1], positionBit } }));
+	EXPECT_EQ(changesSince(first), (Changes{ { crowd[1], positionBit } }));
+	EXPECT_TRUE(changesSince(world.GetChangeVersion()).empty());
+
+	world.SetChangeHistoryLength(1);
+	EXPECT_FALSE(world.ForEachChangeSince(spawned, [](CWorldObject*, uint64_t) { FAIL(); }));
+	EXPECT_EQ(changesSince(first), (Changes{ { crowd[1], positionBit } }));
+}
+
+struct CWideObject : public CWorldObject
+{
+	CWideObject(const DWorldObjectInitializer& init) : CWorldObject(init, false) {
+		for (auto& value : Values)
+			value = NewComponent<uint32_t>(0u);
+	}
+
+	std::array<CComponentHandle<uint32_t>, MAX_ARCHETYPE_COMPONENTS + 1> Values;
+};
+
+TEST(CWorldChangesTest, MustTellTheLastArchetypeSlotFromRuntimeComponents) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CWideObject>("CWideObject");
+	CWorld world(factory);
+	auto* const object{ world.SpawnWorldObject<CWideObject>() };
+
+	const uint64_t lastSlotBit{ object->GetComponentChangedBit(object->Values[MAX_ARCHETYPE_COMPONENTS - 1].Get()) };
+	EXPECT_EQ(lastSlotBit, uint64_t{ 1 } << (MAX_ARCHETYPE_COMPONENTS - 1));
+	EXPECT_EQ(object->GetComponentChangedBit(object->Values.back().Get()), CWorldObject::RUNTIME_COMPONENTS_CHANGED_BIT);
+
+	const uint64_t version{ world.GetChangeVersion() };
+	object->Values[MAX_ARCHETYPE_COMPONENTS - 1].GetMutable() = 1u;
+	world.Tick();
+	uint64_t changed{};
+	EXPECT_TRUE(world.ForEachChangeSince(version, [&changed](CWorldObject*, uint64_t changedBits) { changed |= changedBits; }));
+	EXPECT_EQ(changed, lastSlotBit);
+}
+
+struct DQueryVelocity
+{
+	float X;
+};
+
+struct CMovingObject : public CWorldObject
+{
+	CMovingObject(const DWorldObjectInitializer& init) : CWorldObject(init, false), Name(NewComponent<std::string>("Mover")), Velocity(NewComponent<DQueryVelocity>(DQueryVelocity{ 2.f })), Position(NewComponent<DCrowdPosition>(DCrowdPosition{})) {}
+
+	CComponentHandle<std::string> Name;
+	CComponentHandle<DQueryVelocity> Velocity;
+	CComponentHandle<DCrowdPosition> Position;
+};
+
+struct CLateMovingObject : public CWorldObject
+{
+	CLateMovingObject(const DWorldObjectInitializer& init) : CWorldObject(init, false), Position(NewComponent<DCrowdPosition>(DCrowdPosition{})), Velocity(NewComponent<DQueryVelocity>(DQueryVelocity{ 3.f })) {}
+
+	CComponentHandle<DCrowdPosition> Position;
+	CComponentHandle<DQueryVelocity> Velocity;
+};
+
+TEST(CWorldQueryTest, MustMatchClassesHoldingEveryComponent) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	factory.RegisterEntityClass<CMovingObject>("CMovingObject");
+	CWorld world(factory);
+
+	world.SpawnWorldObjects<CCrowdObject>(3, nullptr);
+	std::array<CMovingObject*, 2> movers{};
+	world.SpawnWorldObjects<CMovingObject>(movers.size(), movers.data());
+
+	EXPECT_EQ(world.Query<DCrowdPosition>().GetNumOfMatchedClasses(), 2u);
+	EXPECT_EQ(world.Query<DCrowdPosition>().GetNumOfCandidates(), 5u);
+
+	const auto move{ [&world]() {
+		uint32_t count{};
+		world.Query<DCrowdPosition, const DQueryVelocity>().ForEach([&count](CWorldObject& object, DCrowdPosition& position, const DQueryVelocity& velocity) {
+			position.X += velocity.X;
+			count++;
+			});
+		return count;
+		} };
+
+	EXPECT_EQ(move(), 2u);
+	EXPECT_EQ(movers[0]->Position->X, 2.f);
+	EXPECT_EQ(movers[1]->Position->X, 2.f);
+
+	// Classes registered after the first query are matched incrementally
+	factory.RegisterEntityClass<CLateMovingObject>("CLateMovingObject");
+	auto* const late{ world.SpawnWorldObject<CLateMovingObject>() };
+	EXPECT_EQ(move(), 3u);
+	EXPECT_EQ(late->Position->X, 3.f);
+	EXPECT_EQ(movers[0]->Position->X, 4.f);
+
+	// A reset component is skipped
+	movers[0]->Velocity.Reset();
+	EXPECT_EQ(move(), 2u);
+	EXPECT_EQ(movers[0]->Position->X, 4.f);
+
+	movers[1]->SetPendingDestroy();
+	world.FlushPendingDestroy();
+	EXPECT_EQ(move(), 1u);
+	EXPECT_EQ(world.Query<DQueryVelocity>().GetNumOfCandidates(), 2u);
+	EXPECT_EQ(world.Query<std::string>().GetNumOfMatchedClasses(), 1u);
+}
+
+struct DQueryHeading
+{
+	float Yaw, Pitch, Roll;
+};
+
+struct CRetypedObject : public CWorldObject
+{
+	CRetypedObject(const DWorldObjectInitializer& init) : CWorldObject(init, false), Position(NewComponent<DCrowdPosition>(DCrowdPosition{ 1.f, 2.f, 3.f })) {}
+
+	void ReplacePositionWithHeading()
+	{
+		Position.Reset();
+		Heading = NewComponent<DQueryHeading>(DQueryHeading{ 4.f, 5.f, 6.f });
+	}
+
+	CComponentHandle<DCrowdPosition> Position;
+	CComponentHandle<DQueryHeading> Heading;
+};
+
+TEST(CWorldQueryTest, MustNotSeeAnotherTypeInAReleasedSlot) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CRetypedObject>("CRetypedObject");
+	CWorld world(factory);
+	auto* const object{ world.SpawnWorldObject<CRetypedObject>() };
+
+	// Same layout as the released slot, it must still go to the runtime components allocator
+	object->ReplacePositionWithHeading();
+	EXPECT_EQ(object->GetConstructedArchetypeSlots() & 1, 0u);
+	EXPECT_EQ(object->Heading->Yaw, 4.f);
+
+	uint32_t count{};
+	world.Query<DCrowdPosition>().ForEach([&count](CWorldObject&, DCrowdPosition&) { count++; });
+	EXPECT_EQ(count, 0u);
+}
+
+struct COverflowingObject : public CWorldObject
+{
+	COverflowingObject(const DWorldObjectInitializer& init) : CWorldObject(init, false), Position(NewComponent<DCrowdPosition>(DCrowdPosition{})) {
+		// Not part of the CDO layout, falls back to the runtime components allocator
+		if (!IsCDO())
+			Velocity = NewComponent<DQueryVelocity>(DQueryVelocity{});
+	}
+
+	CComponentHandle<DCrowdPosition> Position;
+	CComponentHandle<DQueryVelocity> Velocity;
+};
+
+TEST(CWorldStatsTest, MustCountAllocatorAndClassActivity) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<COverflowingObject>("COverflowingObject");
+	CWorld world(factory);
+
+	std::array<COverflowingObject*, 5> objects{};
+	world.SpawnWorldObjects<COverflowingObject>(objects.size(), objects.data());
+	objects[0]->SetPendingDestroy();
+	objects[1]->SetPendingDestroy();
+	world.FlushPendingDestroy();
+
+	// Counters read 0 when compiled out
+	const uint64_t enabled{ NECS_STATS };
+	const DWorldStats stats{ world.GetStats() };
+	EXPECT_EQ(stats.NumOfObjects, 3u);
+
+	ASSERT_EQ(stats.Classes.size(), 1u);
+	const auto& entityClass{ stats.Classes.front() };
+	EXPECT_EQ(entityClass.Name, "COverflowingObject");
+	EXPECT_EQ(entityClass.Objects, 3u * enabled);
+	EXPECT_EQ(entityClass.HighWaterObjects, 5u * enabled);
+	EXPECT_EQ(entityClass.Spawned, 5u * enabled);
+	EXPECT_EQ(entityClass.Destroyed, 2u * enabled);
+	EXPECT_EQ(entityClass.RuntimeComponents, 5u * enabled);
+
+	ASSERT_EQ(stats.SizeClasses.size(), 1u);
+	const auto& sizeClass{ stats.SizeClasses.front() };
+	EXPECT_GE(sizeClass.BlockSize, sizeof(COverflowingObject) + sizeof(DCrowdPosition));
+	EXPECT_EQ(sizeClass.Allocations, 5u * enabled);
+	EXPECT_EQ(sizeClass.Frees, 2u * enabled);
+	EXPECT_EQ(sizeClass.LiveBlocks, 3u * enabled);
+	EXPECT_EQ(sizeClass.HighWaterLiveBlocks, 5u * enabled);
+	EXPECT_EQ(sizeClass.Slabs, 1u * enabled);
+	EXPECT_GE(sizeClass.ReservedBytes, 5u * sizeClass.BlockStride * enabled);
+	EXPECT_GE(sizeClass.GetFragmentation(), 0.0);
+	EXPECT_LT(sizeClass.GetFragmentation(), 1.0);
+
+	std::ostringstream dump;
+	stats.Dump(dump);
+	EXPECT_NE(dump.str().find("COverflowingObject"), std::string::npos);
+	EXPECT_FALSE(dump.str().empty());
+}
+
+TEST_F(CWorldFixture, MustInvalidateHandlesOfDestroyedObjects) {
+	CWorld world(Factory, 1);
+	auto* object{ world.SpawnWorldObject<CSmallObject>() };
+	const auto handle{ object->GetHandle() };
+	ASSERT_TRUE(handle.IsValid());
+	EXPECT_EQ(world.ResolveHandle<CSmallObject>(handle), object);
+
+	object->SetPendingDestroy();
+	world.FlushPendingDestroy();
+	EXPECT_EQ(world.ResolveHandle(handle), nullptr);
+
+	// Same memory and same slot, the stale handle must still not resolve
+	auto* reused{ world.SpawnWorldObject<CSmallObject>() };
+	EXPECT_EQ(reused, object);
+	EXPECT_EQ(reused->GetHandle().Index, handle.Index);
+	EXPECT_EQ(world.ResolveHandle(handle), nullptr);
+	EXPECT_EQ(world.ResolveHandle(reused->GetHandle()), reused);
+}
+
+TEST_F(CWorldFixture, MustDeferDestructionUntilFlush) {
+	CWorld world(Factory);
+	auto* object{ world.SpawnWorldObject<CSmallObject>("CSmallObject") };
+
+	object->SetPendingDestroy();
+	object->SetPendingDestroy();
+	EXPECT_EQ(world.GetNumOfPendingDestroy(), 1u);
+	EXPECT_EQ(NumOfDestroyed, 0u);
+
+	world.FlushPendingDestroy();
+	EXPECT_EQ(NumOfDestroyed, 1u);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 0u);
+	EXPECT_EQ(world.GetNumOfPendingDestroy(), 0u);
+	EXPECT_EQ(world.GetTickManager().GetNumOfTickingObjects(), 0u);
+}
+
+TEST_F(CWorldFixture, MustReuseMemoryOfDestroyedObjects) {
+	CWorld world(Factory, 4);
+	std::vector<CWorldObject*> objects;
+	for (uint32_t i{}; i < 8; i++)
+	{
+		objects.push_back(world.SpawnWorldObject(i % 2 ? "CSmallObject" : "CBigObject"));
+	}
+
+	for (auto* object : objects)
+	{
+		object->SetPendingDestroy();
+	}
+	world.FlushPendingDestroy();
+	EXPECT_EQ(NumOfDestroyed, 8u);
+
+	const std::unordered_set<CWorldObject*> previousAddresses(objects.begin(), objects.end());
+	for (uint32_t i{}; i < 8; i++)
+	{
+		EXPECT_NE(previousAddresses.find(world.SpawnWorldObject(i % 2 ? "CSmallObject" : "CBigObject")), previousAddresses.end());
+	}
+}
+
+TEST_F(CWorldFixture, MustTickThenFlush) {
+	CWorld world(Factory);
+	auto* kept{ world.SpawnWorldObject<CSmallObject>("CSmallObject") };
+	auto* destroyed{ world.SpawnWorldObject<CSmallObject>("CSmallObject") };
 
+	destroyed->SetPendingDestroy();
+	world.Tick();
+
+	EXPECT_EQ(kept->NumTicks, 1u);
+	EXPECT_EQ(NumOfDestroyed, 1u);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 1u);
+}
+
+struct CSpawningObject : public CWorldObject
+{
+	inline static CWorld* World{};
+
+	CSpawningObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+	void Tick() override { World->SpawnWorldObjects(GetClassId<CSpawningObject>(), 2, nullptr); }
+};
+
+TEST_F(CWorldFixture, MustTickObjectsSpawnedByATickFromTheNextFrame) {
+	Factory.RegisterEntityClass<CSpawningObject>("CSpawningObject");
+	CWorld world(Factory);
+	CSpawningObject::World = &world;
+	world.SpawnWorldObjects(GetClassId<CSpawningObject>(), 3, nullptr);
+
+	// The bucket grows while ticked, only the objects registered before the tick run
+	world.Tick();
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 9u);
+	EXPECT_EQ(world.GetTickManager().GetNumOfTickingObjects(), 9u);
+	world.Tick();
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 27u);
+	CSpawningObject::World = nullptr;
+}
+
+TEST_F(CWorldFixture, MustDestroyObjectsMarkedTwiceOnce) {
+	CWorld world(Factory);
+	auto* const object{ world.SpawnWorldObject<CSmallObject>() };
+	auto* const other{ world.SpawnWorldObject<CSmallObject>() };
+
+	object->SetPendingDestroy();
+	object->SetPendingDestroy();
+	other->SetPendingDestroy();
+	world.MarkPendingDestroy(object);
+	EXPECT_EQ(world.GetNumOfPendingDestroy(), 3u);
+
+	world.FlushPendingDestroy();
+	EXPECT_EQ(NumOfDestroyed, 2u);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 0u);
+}
+
+TEST_F(CWorldFixture, MustDestroyLiveObjectsOnDestruction) {
+	{
+		CWorld world(Factory);
+		world.SpawnWorldObject("CSmallObject");
+		world.SpawnWorldObject("CBigObject")->SetPendingDestroy();
+	}
+	EXPECT_EQ(NumOfDestroyed, 2u);
+}
 #pragma endregion
 
+#pragma region Compaction
+struct CRelocatableObject : public CWorldObject
+{
+	CRelocatableObject(const DWorldObjectInitializer& init) : CWorldObject(init, true), Position(NewComponent<DCrowdPosition>(DCrowdPosition{})), Name(NewComponent<std::string>("A name long enough to live on the heap")) {}
+	CRelocatableObject(const DWorldObjectRelocation& relocation, CRelocatableObject&& other) noexcept : CWorldObject(relocation, std::move(other)),
+		Position(RelocateComponent(std::move(other.Position), other)), Name(RelocateComponent(std::move(other.Name), other)), Velocity(RelocateComponent(std::move(other.Velocity), other)), NumTicks(other.NumTicks) {}
+
+	void Tick() override { NumTicks++; }
+
+	CComponentHandle<DCrowdPosition> Position;
+	CComponentHandle<std::string> Name;
+	/**
+	 * /brief Not constructed by the constructor, lives in the runtime components allocator.
+	 */
+	CComponentHandle<DQueryVelocity> Velocity;
+	uint32_t NumTicks{};
+};
+
+TEST(CWorldCompactionTest, MustRegisterTheRelocatingConstructor) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CRelocatableObject>("CRelocatableObject");
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	EXPECT_TRUE(factory.IsClassRelocatable(GetClassId<CRelocatableObject>()));
+	// A prototype constructor is not a relocating one
+	EXPECT_FALSE(factory.IsClassRelocatable(GetClassId<CCrowdObject>()));
+
+	CWorld world(factory);
+	EXPECT_THROW(world.BeginCompaction(GetClassId<CCrowdObject>()), std::runtime_error);
+}
 
+TEST(CWorldCompactionTest, MustPackTheLiveObjectsInOrder) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CRelocatableObject>("CRelocatableObject");
+	CWorld world(factory, 8);
+	const uint32_t tagId{ CTagRegistry::Intern("Relocated") };
+
+	// Two slabs half full once every other object is destroyed
+	std::array<CRelocatableObject*, 16> objects{};
+	world.SpawnWorldObjects<CRelocatableObject>(objects.size(), objects.data());
+	for (uint32_t i{}; i < objects.size(); i++)
+	{
+		objects[i]->Position->X = static_cast<float>(i);
+		if (i % 2)
+			objects[i]->SetPendingDestroy();
+	}
+	world.Tick();
+
+	std::vector<DWorldObjectHandle> handles;
+	for (uint32_t i{}; i < objects.size(); i += 2)
+	{
+		handles.push_back(objects[i]->GetHandle());
+		objects[i]->AddTag(tagId);
+		if (i % 4 == 0)
+			objects[i]->Velocity = objects[i]->NewComponent<DQueryVelocity>(DQueryVelocity{ static_cast<float>(i) });
+	}
+	objects[0]->Position.GetMutable();
+
+	world.BeginCompaction(GetClassId<CRelocatableObject>(), [](const CWorldObject& a, const CWorldObject& b) {
+		return static_cast<const CRelocatableObject&>(a).Position->X > static_cast<const CRelocatableObject&>(b).Position->X;
+		});
+	EXPECT_EQ(world.GetNumOfPendingRelocations(), 8u);
+	EXPECT_TRUE(world.StepCompaction());
+	EXPECT_EQ(world.GetNumOfPendingRelocations(), 0u);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 8u);
+
+	// Descending X is ascending addresses
+	std::vector<CRelocatableObject*> relocated;
+	for (auto it{ handles.rbegin() }; it != handles.rend(); ++it)
+	{
+		relocated.push_back(world.ResolveHandle<CRelocatableObject>(*it));
+		ASSERT_NE(relocated.back(), nullptr);
+	}
+	for (uint32_t i{}; i < relocated.size(); i++)
+	{
+		CRelocatableObject* const object{ relocated[i] };
+		const uint32_t index{ 14 - 2 * i };
+		if (i > 0)
+		{
+			EXPECT_GT(reinterpret_cast<std::uintptr_t>(object), reinterpret_cast<std::uintptr_t>(relocated[i - 1]));
+		}
+		EXPECT_EQ(object->Position->X, static_cast<float>(index));
+		EXPECT_EQ(*object->Name, "A name long enough to live on the heap");
+		EXPECT_EQ(object->GetHandle(), handles[index / 2]);
+		EXPECT_EQ(object->NumTicks, 1u);
+		EXPECT_TRUE(object->HasTag(tagId));
+		EXPECT_EQ(object->GetComponentChangedBit(object->Position.Get()), 1u);
+		if (index % 4 == 0)
+		{
+			ASSERT_TRUE(object->Velocity);
+			EXPECT_EQ(object->Velocity->X, static_cast<float>(index));
+		}
+		else
+		{
+			EXPECT_FALSE(object->Velocity);
+		}
+	}
+	EXPECT_EQ(relocated.back()->GetChangedComponents(), 1u);
+
+	// Every index follows the objects
+	const auto& tagged{ world.GetObjectsWithTag(tagId) };
+	EXPECT_EQ(tagged.size(), 8u);
+	for (CRelocatableObject* const object : relocated)
+	{
+		EXPECT_NE(std::find(tagged.begin(), tagged.end(), object), tagged.end());
+	}
+	EXPECT_EQ(world.Query<DCrowdPosition>().GetNumOfCandidates(), 8u);
+
+	world.Tick();
+	uint32_t changed{};
+	EXPECT_TRUE(world.ForEachChangeSince(world.GetChangeVersion() - 1, [&](CWorldObject* object, uint64_t) {
+		EXPECT_EQ(object, relocated.back());
+		changed++;
+		}));
+	EXPECT_EQ(changed, 1u);
+	for (CRelocatableObject* const object : relocated)
+	{
+		EXPECT_EQ(object->NumTicks, 2u);
+		object->SetPendingDestroy();
+	}
+	world.FlushPendingDestroy();
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 0u);
+	EXPECT_TRUE(world.GetObjectsWithTag(tagId).empty());
+}
+
+struct CCompactingObject : public CWorldObject
+{
+	inline static CWorld* World{};
+	inline static bool Refused{};
+
+	CCompactingObject(const DWorldObjectInitializer& init) : CWorldObject(init, true) {}
+	void Tick() override {
+		try
+		{
+			World->StepCompaction();
+		}
+		catch (const std::runtime_error&)
+		{
+			Refused = true;
+		}
+	}
+};
+
+TEST(CWorldCompactionTest, MustRefuseToCompactWhileTicking) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CRelocatableObject>("CRelocatableObject");
+	factory.RegisterEntityClass<CCompactingObject>("CCompactingObject");
+	CWorld world(factory);
+	CCompactingObject::World = &world;
+	CCompactingObject::Refused = false;
+
+	world.SpawnWorldObjects<CRelocatableObject>(4, nullptr);
+	world.SpawnWorldObject<CCompactingObject>();
+	world.BeginCompaction(GetClassId<CRelocatableObject>());
+	world.Tick();
+	EXPECT_TRUE(CCompactingObject::Refused);
+	EXPECT_EQ(world.GetNumOfPendingRelocations(), 4u);
+
+	EXPECT_TRUE(world.StepCompaction());
+	CCompactingObject::World = nullptr;
+}
+
+TEST(CWorldCompactionTest, MustRelocateIncrementally) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CRelocatableObject>("CRelocatableObject");
+	CWorld world(factory, 4);
+
+	std::array<CRelocatableObject*, 10> objects{};
+	world.SpawnWorldObjects<CRelocatableObject>(objects.size(), objects.data());
+	std::vector<DWorldObjectHandle> handles;
+	for (uint32_t i{}; i < objects.size(); i++)
+	{
+		objects[i]->Position->X = static_cast<float>(i);
+		handles.push_back(objects[i]->GetHandle());
+	}
+
+	world.BeginCompaction(GetClassId<CRelocatableObject>());
+	EXPECT_FALSE(world.StepCompaction(3));
+	EXPECT_EQ(world.GetNumOfPendingRelocations(), 7u);
+
+	// Queued objects destroyed meanwhile are skipped
+	world.ResolveHandle(handles.back())->SetPendingDestroy();
+	EXPECT_FALSE(world.StepCompaction(3));
+	EXPECT_FALSE(world.StepCompaction(3));
+	EXPECT_TRUE(world.StepCompaction(3));
+	world.FlushPendingDestroy();
+
+	for (uint32_t i{}; i + 1 < handles.size(); i++)
+	{
+		const auto* const object{ world.ResolveHandle<CRelocatableObject>(handles[i]) };
+		ASSERT_NE(object, nullptr);
+		EXPECT_EQ(object->Position->X, static_cast<float>(i));
+	}
+	EXPECT_EQ(world.ResolveHandle(handles.back()), nullptr);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 9u);
+}
+#pragma endregion
+
+#pragma region CWorldSnapshot
+struct CNamedObject : public CWorldObject
+{
+	CNamedObject(const DWorldObjectInitializer& init) : CWorldObject(init, false), Name(NewComponent<std::string>()) {}
+
+	CComponentHandle<std::string> Name;
+};
+
+TEST(CWorldSnapshotTest, MustRestoreComponentsHandlesAndTags) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	CWorld world(factory, 4);
+
+	const uint32_t tag{ CTagRegistry::Intern("Saved") };
+	std::array<CCrowdObject*, 10> crowd{};
+	world.SpawnWorldObjects<CCrowdObject>(crowd.size(), crowd.data());
+	std::vector<DWorldObjectHandle> handles;
+	for (uint32_t i{}; i < crowd.size(); i++)
+	{
+		*crowd[i]->Position = DCrowdPosition{ float(i), float(i * 2), float(i * 3) };
+		if (i % 2)
+			crowd[i]->AddTag(tag);
+		handles.push_back(crowd[i]->GetHandle());
+	}
+	// A free slot in the saved handle table
+	crowd[0]->SetPendingDestroy();
+	world.FlushPendingDestroy();
+
+	std::vector<uint8_t> image;
+	CWorldSnapshot::Save(world, image);
+	const DWorldObjectHandle nextAfterSave{ world.SpawnWorldObject<CCrowdObject>()->GetHandle() };
+
+	// Diverge from the snapshot
+	for (uint32_t i{ 1 }; i < 6; i++)
+	{
+		crowd[i]->Position->X = -1.f;
+		crowd[i]->RemoveTag(tag);
+		crowd[i + 4]->SetPendingDestroy();
+	}
+	world.SpawnWorldObject<CCrowdObject>();
+	world.Tick();
+
+	CWorldSnapshot::Restore(world, image);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), crowd.size() - 1);
+	EXPECT_EQ(world.GetTickManager().GetNumOfTickingObjects(), 0u);
+	EXPECT_EQ(world.GetObjectsWithTag(tag).size(), crowd.size() / 2);
+	EXPECT_EQ(world.ResolveHandle(handles[0]), nullptr);
+	for (uint32_t i{ 1 }; i < crowd.size(); i++)
+	{
+		auto* const object{ world.ResolveHandle<CCrowdObject>(handles[i]) };
+		ASSERT_NE(object, nullptr);
+		EXPECT_EQ(object->GetHandle(), handles[i]);
+		EXPECT_EQ(object->Position->X, float(i));
+		EXPECT_EQ(object->Position->Z, float(i * 3));
+		EXPECT_EQ(object->HasTag(tag), i % 2 == 1);
+	}
+
+	// The restored handle table hands out the same handles again
+	EXPECT_EQ(world.SpawnWorldObject<CCrowdObject>()->GetHandle(), nextAfterSave);
+
+	// Restored objects are regular objects
+	world.ResolveHandle(handles[1])->SetPendingDestroy();
+	world.Tick();
+	EXPECT_EQ(world.GetNumOfWorldObjects(), crowd.size() - 1);
+
+	CWorldSnapshot::Restore(world, image);
+	std::vector<uint8_t> same;
+	CWorldSnapshot::Save(world, same);
+	EXPECT_EQ(same, image);
+}
+
+TEST(CWorldSnapshotTest, MustRejectInvalidImagesWithoutTouchingTheWorld) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	CWorld world(factory);
+	world.SpawnWorldObjects<CCrowdObject>(3, nullptr, [](CCrowdObject* object, uint64_t index) { object->Position->Y = float(index); });
+
+	std::vector<uint8_t> image;
+	CWorldSnapshot::Save(world, image);
+
+	auto* const kept{ world.SpawnWorldObject<CCrowdObject>() };
+	EXPECT_THROW(CWorldSnapshot::Restore(world, image.data(), image.size() - 1), std::runtime_error);
+	EXPECT_THROW(CWorldSnapshot::Restore(world, image.data(), 3), std::runtime_error);
+
+	std::vector<uint8_t> corrupted{ image };
+	corrupted[0] ^= 0xFF;
+	EXPECT_THROW(CWorldSnapshot::Restore(world, corrupted), std::runtime_error);
+
+	// A counterfeit free head
+	corrupted = image;
+	const uint32_t freeHead{ 7 };
+	std::memcpy(corrupted.data() + 3 * sizeof(uint32_t), &freeHead, sizeof(freeHead));
+	EXPECT_THROW(CWorldSnapshot::Restore(world, corrupted), std::runtime_error);
+
+	// Unknown class
+	CEntityFactory otherFactory;
+	otherFactory.RegisterEntityClass<CNotClonable>("CNotClonable");
+	CWorld otherWorld(otherFactory);
+	EXPECT_THROW(CWorldSnapshot::Restore(otherWorld, image), std::runtime_error);
+
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 4u);
+	EXPECT_EQ(world.ResolveHandle(kept->GetHandle()), kept);
+}
+
+TEST(CWorldSnapshotTest, MustRefuseComponentsNotTriviallyCopyable) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CNamedObject>("CNamedObject");
+	CWorld world(factory);
+	std::vector<uint8_t> image;
+
+	// Nothing to copy yet
+	CWorldSnapshot::Save(world, image);
+	world.SpawnWorldObject<CNamedObject>();
+	EXPECT_THROW(CWorldSnapshot::Save(world, image), std::runtime_error);
+}
+
+TEST(CWorldSnapshotTest, MustRefuseObjectsWithResetArchetypeComponents) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	CWorld world(factory);
+	auto* const object{ world.SpawnWorldObject<CCrowdObject>() };
+	std::vector<uint8_t> image{ 1, 2, 3 };
+
+	// Restoring would construct the component again
+	object->Position.Reset();
+	EXPECT_THROW(CWorldSnapshot::Save(world, image), std::runtime_error);
+	EXPECT_EQ(image, (std::vector<uint8_t>{ 1, 2, 3 }));
+}
+#pragma endregion
+
+#pragma region CLevelImage
+TEST(CLevelImageTest, MustInstantiateABakedLevelFromAMappedFile) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	factory.RegisterEntityClass<CNotClonable>("CNotClonable");
+
+	const uint32_t tag{ CTagRegistry::Intern("Baked") };
+	std::vector<CWorldObject*> authored;
+	{
+		CWorld editor(factory);
+		for (uint32_t i{}; i < 6; i++)
+		{
+			if (i % 3 == 0)
+			{
+				authored.push_back(editor.SpawnWorldObject<CNotClonable>());
+				continue;
+			}
+			auto* const object{ editor.SpawnWorldObject<CCrowdObject>() };
+			*object->Position = DCrowdPosition{ float(i), 0.f, -float(i) };
+			object->AddTag(tag);
+			authored.push_back(object);
+		}
+
+		std::vector<uint8_t> image;
+		CLevelImage::Bake(factory, authored.data(), authored.size(), image);
+
+		std::ofstream file(testing::TempDir() + "level.necs", std::ios::binary);
+		file.write(reinterpret_cast<const char*>(image.data()), image.size());
+	}
+
+	const CMappedFile file(testing::TempDir() + "level.necs");
+	CWorld world(factory);
+	std::vector<CWorldObject*> spawned;
+	// A level is a prefab too, nothing ties it to one world or one instance
+	CLevelImage::Instantiate(world, file, &spawned);
+	CLevelImage::Instantiate(world, file, &spawned);
+	ASSERT_EQ(spawned.size(), 12u);
+	EXPECT_EQ(world.GetNumOfWorldObjects(), 12u);
+	EXPECT_EQ(world.GetObjectsWithTag(tag).size(), 8u);
+
+	// Grouped by class, in the authored order within the class
+	std::vector<float> positions;
+	for (uint32_t i{}; i < 6; i++)
+	{
+		if (auto* const crowd{ dynamic_cast<CCrowdObject*>(spawned[i]) })
+		{
+			EXPECT_EQ(crowd->Position->Z, -crowd->Position->X);
+			positions.push_back(crowd->Position->X);
+		}
+	}
+	EXPECT_THAT(positions, testing::ElementsAre(1.f, 2.f, 4.f, 5.f));
+
+	EXPECT_THROW(CMappedFile(testing::TempDir() + "missing.necs"), std::runtime_error);
+}
+
+TEST(CLevelImageTest, MustRefuseObjectsWithResetArchetypeComponents) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	CWorld world(factory);
+	std::array<CCrowdObject*, 2> crowd{};
+	world.SpawnWorldObjects<CCrowdObject>(crowd.size(), crowd.data());
+	crowd[1]->Position.Reset();
+
+	std::vector<uint8_t> image;
+	EXPECT_THROW(CLevelImage::Bake(factory, reinterpret_cast<CWorldObject* const*>(crowd.data()), crowd.size(), image), std::runtime_error);
+}
+
+TEST(CLevelImageTest, MustSpawnNothingFromAnInvalidImage) {
+	CEntityFactory factory;
+	factory.RegisterEntityClass<CCrowdObject>("CCrowdObject");
+	CWorld world(factory);
+	std::array<CCrowdObject*, 3> crowd{};
+	world.SpawnWorldObjects<CCrowdObject>(crowd.size(), crowd.data());
+
+	std::vector<uint8_t> image;
+	CLevelImage::Bake(factory, reinterpret_cast<CWorldObject* const*>(crowd.data()), crowd.size(), image);
+
+	EXPECT_THROW(CLevelImage::Instantiate(world, image.data(), image.size() - 1), std::runtime_error);
+	std::vector<uint8_t> corrupted{ image };
+	corrupted[4] ^= 0xFF;
+	EXPECT_THROW(CLevelImage::Instantiate(world, corrupted.data(), corrupted.size()), std::runtime_error);
+
+	CEntityFactory otherFactory;
+	otherFactory.RegisterEntityClass<CNotClonable>("CNotClonable");
+	CWorld otherWorld(otherFactory);
+	EXPECT_THROW(CLevelImage::Instantiate(otherWorld, image.data(), image.size()), std::runtime_error);
+
+	EXPECT_EQ(world.GetNumOfWorldObjects(), crowd.size());
+	EXPECT_EQ(otherWorld.GetNumOfWorldObjects(), 0u);
+}
+#pragma endregion
+
+
+#pragma region CTrace
+TEST(CChromeTraceSinkTest, MustWriteTraceEvents) {
+	CChromeTraceSink sink;
+	sink.BeginZone("Outer");
+	sink.BeginZone("Inner \"quoted\"");
+	sink.EndZone("Inner \"quoted\"");
+	sink.Counter("Objects", 7);
+	sink.EndZone("Outer");
+	EXPECT_EQ(sink.GetNumOfEvents(), 5u);
+
+	std::ostringstream out;
+	sink.Write(out);
+	const std::string json{ out.str() };
+	EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+	EXPECT_NE(json.find("{\"name\":\"Outer\",\"ph\":\"B\""), std::string::npos);
+	EXPECT_NE(json.find("{\"name\":\"Outer\",\"ph\":\"E\""), std::string::npos);
+	EXPECT_NE(json.find("\"name\":\"Inner \\\"quoted\\\"\""), std::string::npos);
+	EXPECT_NE(json.find("\"args\":{\"value\":7}"), std::string::npos);
+
+	sink.Clear();
+	EXPECT_EQ(sink.GetNumOfEvents(), 0u);
+}
+
+TEST(CTraceTest, ZoneMustEndOnTheSinkItBeganOn) {
+	CChromeTraceSink first;
+	CChromeTraceSink second;
+	CTrace::SetSink(&first);
+	{
+		const CTraceZone zone("Zone");
+		CTrace::SetSink(&second);
+	}
+	CTrace::SetSink(nullptr);
+
+	EXPECT_EQ(first.GetNumOfEvents(), 2u);
+	EXPECT_EQ(second.GetNumOfEvents(), 0u);
+}
+
+TEST_F(CWorldFixture, MustReportTraceZonesWhenEnabled) {
+	CChromeTraceSink sink;
+	CTrace::SetSink(&sink);
+	{
+		CWorld world(Factory, 1);
+		world.SpawnWorldObject<CSmallObject>()->SetPendingDestroy();
+		world.Tick();
+	}
+	CTrace::SetSink(nullptr);
+
+	std::ostringstream out;
+	sink.Write(out);
+	const std::string json{ out.str() };
+	// Compiled out the library reports nothing
+	for (const char* const name : { "necs::SpawnWorldObject", "necs::SlabGrowth", "necs::WorldTick", "necs::TickGroup", "necs::FlushPendingDestroy", "necs::DestroyedObjects", "necs::WorldObjects" })
+	{
+		EXPECT_EQ(json.find(name) != std::string::npos, NECS_TRACE != 0) << name;
+	}
+	if (!NECS_TRACE)
+	{
+		EXPECT_EQ(sink.GetNumOfEvents(), 0u);
+	}
+}
+#pragma endregion
 
 int main(int argc, char* argv[])
 {